@@ -23,6 +23,31 @@
 #define configCHECK_FOR_STACK_OVERFLOW  2
 #define configUSE_MALLOC_FAILED_HOOK    1
 
+/* ---- Task / heap statistics (top, mem: taskstat.c) ---- */
+/* Run time is counted in microseconds of the RP2040 timer (wraps after
+ * ~71 minutes; top only ever uses differences). New task stacks are
+ * filled with a known byte, which uxTaskGetStackHighWaterMark() scans. */
+#define configUSE_TRACE_FACILITY            1
+#define configGENERATE_RUN_TIME_STATS       1
+#define configRECORD_STACK_HIGH_ADDRESS     1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()    time_us_32()
+
+#ifndef __ASSEMBLER__
+#include <stddef.h>
+#include "hardware/timer.h"
+void taskstat_on_malloc(void* p, size_t size);
+void taskstat_on_free(void* p, size_t size);
+void taskstat_on_task_create(void* tcb);
+void taskstat_on_task_delete(void* tcb);
+#endif
+/* heap_4 calls these with the scheduler suspended, vTaskDelete() inside
+ * a critical section */
+#define traceMALLOC(pvAddress, uiSize)  taskstat_on_malloc((pvAddress), (uiSize))
+#define traceFREE(pvAddress, uiSize)    taskstat_on_free((pvAddress), (uiSize))
+#define traceTASK_CREATE(pxNewTCB)      taskstat_on_task_create((void*)(pxNewTCB))
+#define traceTASK_DELETE(pxTaskToDelete) taskstat_on_task_delete((void*)(pxTaskToDelete))
+
 #define configASSERT(x) \
     if (!(x)) { portDISABLE_INTERRUPTS(); for(;;); }
 
@@ -32,6 +57,9 @@
 #define INCLUDE_xTaskGetTickCount               1
 #define INCLUDE_vTaskSuspend                    1
 #define INCLUDE_vTaskDelete                     1
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
+#define INCLUDE_xTaskGetSchedulerState          1
+#define INCLUDE_xTaskGetCurrentTaskHandle       1
 #define INCLUDE_xTimerPendFunctionCall          1
 #define INCLUDE_xTimerPendFunctionCallFromISR   1
 
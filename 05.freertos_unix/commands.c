@@ -5,6 +5,7 @@
 #include "basic.h"
 #include "rdisk.h"
 #include "exec.h"
+#include "taskstat.h"
 #include "kernel/syscall.h"
 #include "kernel/proc.h"
 #include "kernel/vfs.h"
@@ -90,5 +91,7 @@ CommandList commands[] = {
     {cmd_wait,          "wait",             "wait [-n | -t <ms>]"                              },
     {cmd_cat,           "cat",              "cat <path>"                                       },
     {cmd_kill,          "kill",             "kill [status] <pid>"                              },
+    {taskstat_cmd_top,  "top",              "top"                                              },
+    {taskstat_cmd_mem,  "mem",              "mem"                                              },
     {NULL,              "",                 ""                                                 }  // End marker                                            
 };
@@ -276,6 +276,12 @@ int console_puts(const char *s)
     return 0;
 }
 
+void console_panic_puts(const char *s)
+{
+    uart_puts(UART_ID, s);
+    uart_tx_wait_blocking(UART_ID);
+}
+
 /* --- Modal input controls --- */
 void console_modal_begin(void)
 {
@@ -15,6 +15,8 @@ void ConsoleStdioFeederTask(void *arg);
 int console_printf(const char *fmt, ...);
 int console_putc(int c);
 int console_puts(const char *s);
+/* Polled UART write for fault hooks (interrupts off, scheduler stopped) */
+void console_panic_puts(const char *s);
 
 /* Modal line input for interactive commands (e.g., loadhex) */
 void console_modal_begin(void);
@@ -67,6 +67,8 @@ static const builtin_app_t* find_builtin(const char* name)
 
 typedef struct { proc_t* p; const builtin_app_t* b; int argc; char** argv; } run_ctx_t;
 
+size_t proc_spawn_ctx_bytes(void) { return sizeof(run_ctx_t); }
+
 static void app_task(void* arg)
 {
     run_ctx_t* rc = (run_ctx_t*)arg;
@@ -1,11 +1,14 @@
 #pragma once
+#include <stddef.h>
 #include <stdint.h>
 #include "FreeRTOS.h"
 #include "task.h"
 
 #define NPROC        8
 #define NFD          8
-#define STACK_SIZE   1024
+#ifndef STACK_SIZE
+#define STACK_SIZE   1024    /* app_task stack depth in words; size it from "top" */
+#endif
 
 typedef enum {
     P_EMPTY = 0,
@@ -41,3 +44,4 @@ int      proc_kill(int pid, int status);
 proc_t*  proc_get(int pid);
 int      proc_get_current_pid(void);
 void     proc_list(void);
+size_t   proc_spawn_ctx_bytes(void);   /* heap block each spawn allocates besides the task (mem) */
@@ -10,6 +10,16 @@
 #include "kernel/syscall.h"
 #include "kernel/proc.h"
 
+#ifndef CONSOLE_RX_STACK
+#define CONSOLE_RX_STACK  1024
+#endif
+#ifndef CONSOLE_STACK
+#define CONSOLE_STACK     1024
+#endif
+#ifndef CONSOLE_TX_STACK
+#define CONSOLE_TX_STACK  1024
+#endif
+
 /* -------- main -------- */
 int main() {
     /* Initialize console (UART + buffers) before tasks */
@@ -19,10 +29,10 @@ int main() {
     proc_init();
     sys_init();
 
-    /* Console tasks */
-    xTaskCreate(ConsoleRxTask,  "ConsoleRx",1024, NULL, 2, NULL);
-    xTaskCreate(ConsoleTask,    "Console",  1024, NULL, 1, NULL);
-    xTaskCreate(ConsoleTxTask,  "ConsoleTx",1024, NULL, 1, NULL);
+    /* Console tasks (stack depth in words; "top" shows what each uses) */
+    xTaskCreate(ConsoleRxTask,  "ConsoleRx",CONSOLE_RX_STACK, NULL, 2, NULL);
+    xTaskCreate(ConsoleTask,    "Console",  CONSOLE_STACK,    NULL, 1, NULL);
+    xTaskCreate(ConsoleTxTask,  "ConsoleTx",CONSOLE_TX_STACK, NULL, 1, NULL);
 
     vTaskStartScheduler();
 
@@ -32,14 +42,18 @@ int main() {
 void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
 {
     (void)xTask;
-    (void)pcTaskName;
     taskDISABLE_INTERRUPTS();
+    /* Say which task before halting; the console task may be the victim */
+    console_panic_puts("\r\n*** stack overflow in task ");
+    console_panic_puts(pcTaskName ? pcTaskName : "?");
+    console_panic_puts("\r\n");
     for (;;);
 }
 
 void vApplicationMallocFailedHook(void)
 {
     taskDISABLE_INTERRUPTS();
+    console_panic_puts("\r\n*** pvPortMalloc failed (heap exhausted, see mem)\r\n");
     for (;;);
 }
 
@@ -0,0 +1,248 @@
+/*
+ * Task and heap statistics: the "top" and "mem" commands.
+ *
+ * CPU share comes from FreeRTOS run-time stats (microsecond timer, see
+ * FreeRTOSConfig.h), minimum free stack from uxTaskGetStackHighWaterMark()
+ * on the stacks the kernel fills at creation. Heap use per task is counted
+ * by the traceMALLOC / traceFREE hooks: each live block remembers the task
+ * that allocated it, so a block freed elsewhere (a TCB freed by the idle
+ * task) is still taken off its owner.
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "console.h"
+#include "taskstat.h"
+#include "kernel/proc.h"
+
+#define TS_MAX_TASKS   16
+#define TS_MAX_BLOCKS  96
+#define TS_OTHER       0      /* before the scheduler, or owner deleted */
+
+typedef struct {
+    void*    task;            /* TaskHandle_t; NULL = free entry */
+    uint32_t now;             /* bytes held */
+    uint32_t peak;
+    uint32_t allocs;
+} heap_owner_t;
+
+typedef struct {
+    void*    p;
+    uint32_t size;
+    uint8_t  owner;
+} heap_block_t;
+
+static heap_owner_t g_owner[TS_MAX_TASKS];
+static heap_block_t g_block[TS_MAX_BLOCKS];
+static uint32_t     g_untracked;       /* blocks that did not fit g_block */
+static uint32_t     g_failed;          /* pvPortMalloc returned NULL */
+
+/* Run time per task at the previous "top", for the share since then */
+static struct { TaskHandle_t task; configRUN_TIME_COUNTER_TYPE run; } g_prev[TS_MAX_TASKS];
+static uint32_t g_prev_total;
+
+/* --- hooks (heap_4 / tasks.c, scheduler suspended) --- */
+
+static int owner_index(void* task, int create)
+{
+    int free_slot = -1;
+    for (int i = 1; i < TS_MAX_TASKS; i++) {
+        if (g_owner[i].task == task) return i;
+        if (!g_owner[i].task && free_slot < 0) free_slot = i;
+    }
+    if (!create || free_slot < 0) return TS_OTHER;
+    memset(&g_owner[free_slot], 0, sizeof(g_owner[free_slot]));
+    g_owner[free_slot].task = task;
+    return free_slot;
+}
+
+static void owner_add(int i, int32_t delta)
+{
+    heap_owner_t* o = &g_owner[i];
+    if (delta < 0 && (uint32_t)-delta > o->now) o->now = 0;
+    else o->now += (uint32_t)delta;
+    if (o->now > o->peak) o->peak = o->now;
+}
+
+void taskstat_on_malloc(void* p, size_t size)
+{
+    if (!p) { g_failed++; return; }
+    int owner = TS_OTHER;
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+        owner = owner_index(xTaskGetCurrentTaskHandle(), 1);
+    }
+    g_owner[owner].allocs++;
+    owner_add(owner, (int32_t)size);
+    for (int i = 0; i < TS_MAX_BLOCKS; i++) {
+        if (!g_block[i].p) {
+            g_block[i].p = p;
+            g_block[i].size = (uint32_t)size;
+            g_block[i].owner = (uint8_t)owner;
+            return;
+        }
+    }
+    g_untracked++;
+}
+
+void taskstat_on_free(void* p, size_t size)
+{
+    (void)size;
+    for (int i = 0; i < TS_MAX_BLOCKS; i++) {
+        if (g_block[i].p == p) {
+            owner_add(g_block[i].owner, -(int32_t)g_block[i].size);
+            g_block[i].p = NULL;
+            return;
+        }
+    }
+}
+
+/* The task is gone: blocks it still holds go to "other", its entry is free */
+static void owner_release(void* task)
+{
+    int i = owner_index(task, 0);
+    if (i == TS_OTHER) return;
+    for (int b = 0; b < TS_MAX_BLOCKS; b++) {
+        if (g_block[b].p && g_block[b].owner == i) {
+            g_block[b].owner = TS_OTHER;
+            owner_add(TS_OTHER, (int32_t)g_block[b].size);
+        }
+    }
+    g_owner[i].task = NULL;
+}
+
+void taskstat_on_task_delete(void* tcb)
+{
+    owner_release(tcb);
+}
+
+void taskstat_on_task_create(void* tcb)
+{
+    /* Normally released at delete already; this covers a TCB address
+     * reused before the hook saw the old task go */
+    owner_release(tcb);
+}
+
+/* --- commands --- */
+
+static TaskStatus_t g_status[TS_MAX_TASKS];
+
+static char state_char(eTaskState s)
+{
+    switch (s) {
+    case eRunning:   return 'R';
+    case eReady:     return 'r';
+    case eBlocked:   return 'B';
+    case eSuspended: return 'S';
+    case eDeleted:   return 'D';
+    default:         return '?';
+    }
+}
+
+/* top: CPU share since the previous top (since boot the first time),
+ * stack use and heap held per task */
+int32_t taskstat_cmd_top(int32_t argc, char **argv)
+{
+    (void)argc; (void)argv;
+    configRUN_TIME_COUNTER_TYPE total;
+    heap_owner_t owners[TS_MAX_TASKS];
+
+    vTaskSuspendAll();
+    UBaseType_t n = uxTaskGetSystemState(g_status, TS_MAX_TASKS, &total);
+    memcpy(owners, g_owner, sizeof(owners));
+    (void)xTaskResumeAll();
+    if (n == 0) {
+        console_printf("more than %d tasks\n", TS_MAX_TASKS);
+        return 0;
+    }
+
+    uint32_t span = (uint32_t)total - g_prev_total;
+    if (span == 0) span = 1;
+
+    console_printf("NAME         ST PRI  CPU%%  STACK USED/SIZE   HEAP NOW/PEAK  ALLOCS\n");
+    for (UBaseType_t i = 0; i < n; i++) {
+        const TaskStatus_t* t = &g_status[i];
+        configRUN_TIME_COUNTER_TYPE prev = 0;
+        for (int k = 0; k < TS_MAX_TASKS; k++) {
+            if (g_prev[k].task == t->xHandle) { prev = g_prev[k].run; break; }
+        }
+        uint32_t ran = (uint32_t)(t->ulRunTimeCounter - prev);
+        uint32_t permille = (uint32_t)((uint64_t)ran * 1000u / span);
+
+        uint32_t free_b = (uint32_t)t->usStackHighWaterMark * sizeof(StackType_t);
+#if tskKERNEL_VERSION_MAJOR >= 11
+        uint32_t size_b = (uint32_t)(t->pxEndOfStack - t->pxStackBase + 1) * sizeof(StackType_t);
+#else
+        uint32_t size_b = 0;   /* TaskStatus_t has no stack end before V11 */
+#endif
+
+        int o = TS_OTHER;
+        for (int k = 1; k < TS_MAX_TASKS; k++) if (owners[k].task == t->xHandle) { o = k; break; }
+        const heap_owner_t* h = o != TS_OTHER ? &owners[o] : NULL;
+
+        console_printf("%-12s %c %3u %3lu.%lu %6lu/%-6lu %6lu/%-6lu %6lu%s\n",
+            t->pcTaskName, state_char(t->eCurrentState), (unsigned)t->uxCurrentPriority,
+            (unsigned long)(permille / 10), (unsigned long)(permille % 10),
+            (unsigned long)(size_b ? size_b - free_b : 0), (unsigned long)size_b,
+            (unsigned long)(h ? h->now : 0), (unsigned long)(h ? h->peak : 0),
+            (unsigned long)(h ? h->allocs : 0),
+            free_b < 64 ? "  LOW STACK" : "");
+    }
+    console_printf("%-12s               %6lu/%-6lu %6lu\n", "(other)",
+        (unsigned long)owners[TS_OTHER].now, (unsigned long)owners[TS_OTHER].peak,
+        (unsigned long)owners[TS_OTHER].allocs);
+
+    /* The next top shows the share from here on */
+    memset(g_prev, 0, sizeof(g_prev));
+    for (UBaseType_t i = 0; i < n && i < TS_MAX_TASKS; i++) {
+        g_prev[i].task = g_status[i].xHandle;
+        g_prev[i].run = g_status[i].ulRunTimeCounter;
+    }
+    g_prev_total = (uint32_t)total;
+    return 0;
+}
+
+/* heap_4 hands out n bytes plus a BlockLink_t header, rounded up to the
+ * port alignment */
+static size_t heap4_block(size_t n)
+{
+    const size_t align = portBYTE_ALIGNMENT;
+    const size_t hdr = (sizeof(void*) + sizeof(size_t) + align - 1) & ~(align - 1);
+    return (n + hdr + align - 1) & ~(align - 1);
+}
+
+/* mem: heap_4 totals and how fragmented the free space is */
+int32_t taskstat_cmd_mem(int32_t argc, char **argv)
+{
+    (void)argc; (void)argv;
+    HeapStats_t hs;
+    vPortGetHeapStats(&hs);
+
+    size_t used = configTOTAL_HEAP_SIZE - hs.xAvailableHeapSpaceInBytes;
+    console_printf("heap_4: %lu B, %lu used, %lu free (least ever %lu)\n",
+        (unsigned long)configTOTAL_HEAP_SIZE, (unsigned long)used,
+        (unsigned long)hs.xAvailableHeapSpaceInBytes, (unsigned long)hs.xMinimumEverFreeBytesRemaining);
+
+    /* Fragmentation: share of the free space not in the largest block,
+     * i.e. what a single allocation could not use */
+    uint32_t frag = hs.xAvailableHeapSpaceInBytes
+        ? (uint32_t)(100u - hs.xSizeOfLargestFreeBlockInBytes * 100u / hs.xAvailableHeapSpaceInBytes) : 0;
+    console_printf("free blocks: %lu, largest %lu B, smallest %lu B, fragmentation %lu%%\n",
+        (unsigned long)hs.xNumberOfFreeBlocks, (unsigned long)hs.xSizeOfLargestFreeBlockInBytes,
+        (unsigned long)hs.xSizeOfSmallestFreeBlockInBytes, (unsigned long)frag);
+    console_printf("allocs %lu, frees %lu, failed %lu, untracked by top %lu\n",
+        (unsigned long)hs.xNumberOfSuccessfulAllocations, (unsigned long)hs.xNumberOfSuccessfulFrees,
+        (unsigned long)g_failed, (unsigned long)g_untracked);
+
+    /* What one more app_task would need against the above: its stack, TCB
+     * and run context, each a heap_4 block with its own header */
+    size_t stack = heap4_block(STACK_SIZE * sizeof(StackType_t));
+    size_t need = stack + heap4_block(sizeof(StaticTask_t)) + heap4_block(proc_spawn_ctx_bytes());
+    bool fits = hs.xSizeOfLargestFreeBlockInBytes >= stack && hs.xAvailableHeapSpaceInBytes >= need;
+    console_printf("next app_task %lu B (stack %lu, TCB, context, headers): %s\n",
+        (unsigned long)need, (unsigned long)stack, fits ? "fits" : "does NOT fit");
+    return 0;
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+int32_t taskstat_cmd_top(int32_t argc, char **argv);
+int32_t taskstat_cmd_mem(int32_t argc, char **argv);
@@ -0,0 +1,59 @@
+// cobs_test.c: cobs_encode() / cobs_decode() round trips and output bounds
+//
+// Every encode runs with out_cap from 0 up to the exact encoded length,
+// into a buffer with a guard byte right after out_cap: short caps must
+// return 0 without touching the guard, the exact cap must succeed.
+#include "xfer/cobs.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_IN 600
+
+static int g_fail;
+
+static void check(const char* what, bool ok) {
+    printf("%-32s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) g_fail++;
+}
+
+// true if every cap behaves; *exact gets the encoded length
+static bool encode_caps(const uint8_t* in, size_t n, size_t* exact) {
+    static uint8_t out[MAX_IN + MAX_IN / 254 + 3];
+    const size_t need = n + n / 254 + 1;
+    for (size_t cap = 0; cap <= need; cap++) {
+        memset(out, 0xA5, sizeof(out));
+        size_t m = cobs_encode(in, n, out, cap);
+        if (out[cap] != 0xA5) return false;
+        if (m && cap < m) return false;
+        if (m) { *exact = m; return true; }
+    }
+    return false;
+}
+
+int main(void) {
+    static uint8_t in[MAX_IN], enc[MAX_IN + MAX_IN / 254 + 3], dec[MAX_IN];
+    bool bounds = true, trip = true;
+
+    // All zeros, no zeros, and a mix, at lengths around the 254-byte block
+    for (int pat = 0; pat < 3; pat++) {
+        for (size_t n = 1; n <= MAX_IN; n++) {
+            for (size_t i = 0; i < n; i++) in[i] = pat == 0 ? 0 : pat == 1 ? (uint8_t)(1 + i % 255) : (uint8_t)(i % 7);
+            size_t m = 0;
+            if (!encode_caps(in, n, &m)) { bounds = false; continue; }
+            cobs_encode(in, n, enc, m);
+            if (memchr(enc, 0, m)) trip = false;
+            if (cobs_decode(enc, m, dec, sizeof(dec)) != n || memcmp(dec, in, n) != 0) trip = false;
+        }
+    }
+    check("encode stays within out_cap", bounds);
+    check("encode/decode round trip", trip);
+
+    uint8_t one = 0x42, out[2] = { 0, 0xA5 };
+    check("out_cap 1, one byte in", cobs_encode(&one, 1, out, 1) == 0 && out[1] == 0xA5);
+    check("empty input", cobs_encode(&one, 0, out, 1) == 1 && out[0] == 1);
+
+    printf("%d failed\n", g_fail);
+    return g_fail;
+}
@@ -0,0 +1,94 @@
+// dos_sys_host.c: dos_sys.h on a Linux fd pair (pty, pipe or stdin/stdout)
+#include "dos/dos_sys.h"
+#include "host_con.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <poll.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+static int g_in_fd = 0, g_out_fd = 1;
+static int g_idle_ms = -1;
+static bool g_exit_on_eof;
+static void (*g_idle)(void);
+static int (*g_rx_hook)(int timeout_ms);
+static void (*g_tx_hook)(char c);
+
+// Small RX buffer so a byte-at-a-time reader does not cost a syscall per byte
+static uint8_t g_rx[256];
+static int g_rx_pos, g_rx_len;
+
+void host_con_set_fds(int in_fd, int out_fd) {
+    g_in_fd = in_fd;
+    g_out_fd = out_fd;
+    g_rx_pos = g_rx_len = 0;
+}
+
+void host_con_flush(void) { g_rx_pos = g_rx_len = 0; }
+
+void host_con_set_idle_timeout_ms(int ms) { g_idle_ms = ms; }
+
+void host_con_set_exit_on_eof(bool on) { g_exit_on_eof = on; }
+
+void host_con_set_hooks(int (*rx)(int timeout_ms), void (*tx)(char c)) {
+    g_rx_hook = rx;
+    g_tx_hook = tx;
+}
+
+void dos_sys_init(void) {}
+
+void dos_set_idle_hook(void (*fn)(void)) { g_idle = fn; }
+
+static int rx_byte(int timeout_ms) {
+    if (g_rx_hook) return g_rx_hook(timeout_ms);
+    if (g_rx_pos < g_rx_len) return g_rx[g_rx_pos++];
+
+    struct pollfd pfd = { .fd = g_in_fd, .events = POLLIN };
+    if (poll(&pfd, 1, timeout_ms) <= 0) return -1;
+    ssize_t n = read(g_in_fd, g_rx, sizeof(g_rx));
+    if (n == 0 && g_exit_on_eof) exit(0);
+    if (n <= 0) return -1;
+    g_rx_pos = 1;
+    g_rx_len = (int)n;
+    return g_rx[0];
+}
+
+int dos_getc_blocking(void) { return rx_byte(g_idle_ms); }
+int dos_getc_nowait(void) { return rx_byte(0); }
+
+void dos_putc(char c) {
+    if (g_tx_hook) { g_tx_hook(c); return; }
+    if (g_out_fd >= 0) (void)!write(g_out_fd, &c, 1);
+}
+
+void dos_puts(const char* s) {
+    while (*s) dos_putc(*s++);
+}
+
+void dos_vprintf(const char* fmt, va_list ap) {
+    if (g_tx_hook) {
+        char buf[256];
+        vsnprintf(buf, sizeof(buf), fmt, ap);
+        dos_puts(buf);
+        return;
+    }
+    if (g_out_fd >= 0) vdprintf(g_out_fd, fmt, ap);
+}
+
+// Since the first call (main), like the board's time since reset
+uint64_t dos_time_us(void) {
+    static uint64_t base;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t now = (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+    if (!base) base = now - 1;
+    return now - base;
+}
+
+void dos_yield(void) {
+    if (g_idle) g_idle();
+    sched_yield();
+}
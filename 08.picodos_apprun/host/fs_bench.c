@@ -0,0 +1,47 @@
+// fs_bench.c: src/fs/fs_bench.c on the host (the same cases as FSBENCH)
+//
+//   fs_bench [--csv | --json] [--min-us N] [--flash FILE] [--no-flash]
+//
+// Starts from a fresh RAM disk (README.TXT only), so runs are comparable
+// across commits. flash_fs save / load go to the emulated chip
+// (hal_flash_host.c); --flash keeps it in a file. Exit status 1 if a case
+// failed.
+#include "fs/fs_bench.h"
+#include "vfs/vfs.h"
+#include "fs/ramfs.h"
+#include "hal_flash_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char** argv) {
+    fs_bench_opts_t o = { .fmt = FS_BENCH_TABLE, .min_us = 20000, .flash = true };
+    const char* flash = NULL;
+
+    for (int i=1;i<argc;i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i+1] : "0";
+        if (!strcmp(a, "--csv")) { o.fmt = FS_BENCH_CSV; continue; }
+        if (!strcmp(a, "--json")) { o.fmt = FS_BENCH_JSON; continue; }
+        if (!strcmp(a, "--no-flash")) { o.flash = false; continue; }
+        if (!strcmp(a, "--min-us")) o.min_us = (uint32_t)strtoul(v, NULL, 0);
+        else if (!strcmp(a, "--flash")) flash = v;
+        else { fprintf(stderr, "unknown option %s\n", a); return 2; }
+        i++;
+    }
+
+    if (!hal_flash_host_open(flash)) { perror(flash ? flash : "flash"); return 1; }
+    vfs_init();
+    ramfs_init();
+
+    o.scratch = malloc(fs_bench_scratch_bytes());
+    bool ok = fs_bench_run(&o);
+    free(o.scratch);
+
+    if (o.flash && o.fmt == FS_BENCH_TABLE) {
+        const hal_flash_host_stats_t* st = hal_flash_host_stats();
+        printf("# flash: %u sectors erased, %u pages programmed\n", st->erases, st->programs);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+// hal_flash_host.c: hal_flash.h over an mmap'd file
+//
+// Behaves like NOR flash: hal_flash_write erases each sector to 0xFF, then
+// programs by ANDing the new bytes in, the same two steps as on the chip.
+#include "hal/hal_flash.h"
+#include "hal_flash_host.h"
+#include "os/trace.h"
+#include "os/stats.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static uint8_t* g_flash;
+static hal_flash_host_stats_t g_st;
+
+bool hal_flash_host_open(const char* path) {
+    const size_t size = PICO_FLASH_SIZE_BYTES;
+    if (g_flash) { munmap(g_flash, size); g_flash = NULL; }
+
+    if (!path) {
+        g_flash = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (g_flash == MAP_FAILED) { g_flash = NULL; return false; }
+        memset(g_flash, 0xFF, size);
+        return true;
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) { perror(path); return false; }
+    struct stat st;
+    fstat(fd, &st);
+    bool fresh = (size_t)st.st_size < size;
+    if (fresh && ftruncate(fd, (off_t)size) < 0) { perror(path); close(fd); return false; }
+
+    g_flash = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (g_flash == MAP_FAILED) { perror(path); g_flash = NULL; return false; }
+    // A new (or short) file reads as erased past its old end
+    if (fresh) memset(g_flash + st.st_size, 0xFF, size - (size_t)st.st_size);
+    return true;
+}
+
+const hal_flash_host_stats_t* hal_flash_host_stats(void) { return &g_st; }
+
+const uint8_t* hal_flash_map(uint32_t off) {
+    if (!g_flash) hal_flash_host_open(NULL);
+    return g_flash + off;
+}
+
+bool hal_flash_write(uint32_t off, const uint8_t* src, size_t len) {
+    if ((off % HAL_FLASH_SECTOR) || (len % HAL_FLASH_SECTOR)) return false;
+    if (off + len > PICO_FLASH_SIZE_BYTES) return false;
+    if (!g_flash && !hal_flash_host_open(NULL)) return false;
+
+    uint8_t* p = g_flash + off;
+    stats_flash((uint32_t)(len / HAL_FLASH_SECTOR), (uint32_t)(len / HAL_FLASH_PAGE));
+    TRACE(TR_FLASH_ERASE_BEGIN, off, len);
+    memset(p, 0xFF, len);
+    g_st.erases += (uint32_t)(len / HAL_FLASH_SECTOR);
+    TRACE(TR_FLASH_ERASE_END, off, 1);
+    TRACE(TR_FLASH_PROG_BEGIN, off, len);
+    for (size_t i=0;i<len;i++) p[i] &= src[i];
+    g_st.programs += (uint32_t)(len / HAL_FLASH_PAGE);
+    TRACE(TR_FLASH_PROG_END, off, 1);
+    return true;
+}
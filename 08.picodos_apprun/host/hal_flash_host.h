@@ -0,0 +1,15 @@
+// hal_flash_host.h: file-backed flash for host builds (hal/hal_flash.h)
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Back the emulated chip with path (created erased if missing); NULL keeps
+// it in memory only. Without a call, the first access maps an erased chip.
+bool hal_flash_host_open(const char* path);
+
+typedef struct {
+    uint32_t erases;          // sectors erased
+    uint32_t programs;        // pages programmed
+} hal_flash_host_stats_t;
+
+const hal_flash_host_stats_t* hal_flash_host_stats(void);
@@ -0,0 +1,14 @@
+// host_con.h: console plumbing for host builds (stands in for the UART)
+#pragma once
+#include <stdbool.h>
+
+void host_con_set_fds(int in_fd, int out_fd);
+// Drop bytes already buffered from in_fd
+void host_con_flush(void);
+// dos_getc_blocking returns -1 after this much silence; < 0 waits forever
+void host_con_set_idle_timeout_ms(int ms);
+// End of input exits the process (scripted runs of the shell)
+void host_con_set_exit_on_eof(bool on);
+// Console redirected into the process (replay.c): rx(timeout_ms) stands in
+// for the input fd (-1 = nothing), tx gets every output byte. NULL restores.
+void host_con_set_hooks(int (*rx)(int timeout_ms), void (*tx)(char c));
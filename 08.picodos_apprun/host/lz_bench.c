@@ -0,0 +1,125 @@
+// lz_bench.c: PXE_F_LZ ratio and decode cost on the host
+//
+// Each input is compressed with the real tool chain (src/apps/tools/pxe_lz.py)
+// and decoded with src/pxe/pxe_lz.c, once in a single push (file load) and
+// once in 240-byte pushes (NETRUN frames). A memcpy of the same bytes is the
+// baseline for "uncompressed load".
+//
+//   lz_bench [--reps N] [--csv] [file...]   (default: this executable, first 64 KB)
+//
+// Cycles are TSC ticks on x86-64, nanoseconds elsewhere.
+#include "pxe/pxe_lz.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#define MAX_IMAGE  (64u * 1024u)   // APP_SLOT_BYTES
+#define WIRE_CHUNK 240u            // xfer DATA payload (xfer_send.c)
+
+static uint64_t ticks(void) {
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint8_t* read_all(const char* path, size_t cap, size_t* len) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    uint8_t* buf = malloc(cap ? cap : 1);
+    *len = fread(buf, 1, cap, f);
+    fclose(f);
+    return buf;
+}
+
+static bool decode(const uint8_t* z, size_t zlen, uint8_t* out, uint32_t size, size_t chunk) {
+    pxe_lz_t d;
+    pxe_lz_init(&d, out, size);
+    for (size_t off = 0; off < zlen; off += chunk) {
+        size_t n = zlen - off < chunk ? zlen - off : chunk;
+        if (!pxe_lz_push(&d, z + off, n)) return false;
+    }
+    return pxe_lz_done(&d);
+}
+
+int main(int argc, char** argv) {
+    int reps = 200;
+    bool csv = false;
+    const char* files[32];
+    int nfiles = 0;
+    char self[512];
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i], "--reps") && i + 1 < argc) reps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--csv")) csv = true;
+        else if (nfiles < 32) files[nfiles++] = argv[i];
+    }
+    if (!nfiles) {
+        ssize_t n = readlink("/proc/self/exe", self, sizeof(self) - 1);
+        if (n <= 0) { fprintf(stderr, "no input\n"); return 2; }
+        self[n] = 0;
+        files[nfiles++] = self;
+    }
+
+    if (csv) printf("file,raw,packed,ratio,cyc_per_byte,cyc_per_byte_wire,cyc_per_byte_memcpy\n");
+    else printf("%-24s %8s %8s %7s %10s %10s %10s\n", "file", "raw", "packed", "ratio", "cyc/B", "wire cyc/B", "memcpy");
+
+    int rc = 0;
+    for (int fi=0; fi<nfiles; fi++) {
+        size_t raw_len, z_len;
+        uint8_t* raw = read_all(files[fi], MAX_IMAGE, &raw_len);
+        if (!raw) { perror(files[fi]); rc = 1; continue; }
+
+        // Compress with the same script mkpxe_from_elf.py uses
+        char in_path[] = "/tmp/lzbenchXXXXXX";
+        int fd = mkstemp(in_path);
+        if (fd < 0 || write(fd, raw, raw_len) != (ssize_t)raw_len) { perror("tmp"); return 1; }
+        close(fd);
+        char z_path[64], cmd[1024];
+        snprintf(z_path, sizeof(z_path), "%s.lz", in_path);
+        snprintf(cmd, sizeof(cmd), "python3 %s %s %s > /dev/null", PXE_LZ_PY, in_path, z_path);
+        int st = system(cmd);
+        uint8_t* z = st == 0 ? read_all(z_path, 2 * MAX_IMAGE, &z_len) : NULL;
+        unlink(in_path);
+        unlink(z_path);
+        if (!z) { fprintf(stderr, "%s: compressor failed\n", files[fi]); free(raw); rc = 1; continue; }
+
+        uint8_t* out = malloc(raw_len ? raw_len : 1);
+        const size_t chunks[] = { z_len ? z_len : 1, WIRE_CHUNK, 1 };
+        for (int k=0;k<3;k++) {
+            memset(out, 0, raw_len);
+            if (!decode(z, z_len, out, (uint32_t)raw_len, chunks[k]) || memcmp(out, raw, raw_len)) {
+                fprintf(stderr, "%s: decode mismatch (%zu-byte pushes)\n", files[fi], chunks[k]);
+                rc = 1;
+            }
+        }
+
+        uint64_t t0 = ticks();
+        for (int r=0;r<reps;r++) decode(z, z_len, out, (uint32_t)raw_len, z_len);
+        uint64_t t1 = ticks();
+        for (int r=0;r<reps;r++) decode(z, z_len, out, (uint32_t)raw_len, WIRE_CHUNK);
+        uint64_t t2 = ticks();
+        for (int r=0;r<reps;r++) { memcpy(out, raw, raw_len); __asm__ volatile("" ::: "memory"); }
+        uint64_t t3 = ticks();
+
+        double bytes = (double)(raw_len ? raw_len : 1) * reps;
+        double ratio = raw_len ? (double)z_len / raw_len : 0.0;
+        const char* name = strrchr(files[fi], '/') ? strrchr(files[fi], '/') + 1 : files[fi];
+        if (csv) printf("%s,%zu,%zu,%.4f,%.3f,%.3f,%.3f\n", name, raw_len, z_len, ratio,
+                        (t1 - t0) / bytes, (t2 - t1) / bytes, (t3 - t2) / bytes);
+        else printf("%-24s %8zu %8zu %6.1f%% %10.3f %10.3f %10.3f\n", name, raw_len, z_len, ratio * 100,
+                    (t1 - t0) / bytes, (t2 - t1) / bytes, (t3 - t2) / bytes);
+        free(raw); free(z); free(out);
+    }
+    return rc;
+}
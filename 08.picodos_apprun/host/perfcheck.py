@@ -0,0 +1,272 @@
+#!/usr/bin/env python3
+# perfcheck.py: run the host benchmarks and compare with a committed baseline
+#
+#   perfcheck.py --build DIR [--baseline FILE] [--kinds count,time]
+#                [--runs N] [--pxe-dir DIR] [--update]
+#
+# Two kinds of metric:
+#   count  deterministic work: simulator instructions / cycles / SVCs of
+#          the PXE apps below (and of built sample apps in --pxe-dir),
+#          transfer frames, flash pages and VFS bytes of shell commands
+#          (TIME). Same on every machine; gated tightly.
+#   time   wall clock of fs_bench, xfer_bench and sys_shim --bench, best of
+#          --runs. Only comparable on the machine that recorded the
+#          baseline; gated loosely.
+#
+# Exit status 1 if a metric got worse than the baseline by more than its
+# tolerance, or a benchmark's output could not be parsed. Metrics missing
+# from the run (no --pxe-dir images) are listed and skipped; new ones are
+# listed and pass until --update records them. --update writes the run as the
+# new baseline. A metric may carry its own "tol" (fraction, 1.0 = twice as
+# slow) instead of the baseline's default for its kind.
+#
+# Everything runs from DIR (the host build); no board, no network.
+import argparse, csv, io, json, os, re, struct, subprocess, sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_TOL = {"count": 0.01, "time": 1.0}
+
+# Hand-assembled Thumb apps (no ARM toolchain needed), written as PXE v1
+# images into the build directory and run under pxe_sim: pxe.<NAME>.*
+SYS_WRITE = 2   # src/os/syscall.h
+SIM_APPS = {
+    # movs r0,#0; movs r1,#200; 1: adds r0,r1; subs r1,#1; bne 1b; bx lr
+    "SUMLOOP": [0x2000, 0x21C8, 0x1840, 0x3901, 0xD1FC, 0x4770],
+    # push {r4,lr}; movs r4,#16
+    # 1: movs r0,#1; adr r1,msg; movs r2,#3; movs r3,#SYS_write; mov r12,r3
+    #    svc 0; subs r4,#1; bne 1b
+    # pop {r4,pc}; .align; msg: "hi\n"
+    "SVCLOOP": [0xB510, 0x2410, 0x2001, 0xA104, 0x2203, 0x2300 | SYS_WRITE, 0x469C,
+                0xDF00, 0x3C01, 0xD1F7, 0xBD10, 0x0000, ord("h") | ord("i") << 8, ord("\n")],
+}
+
+# TIME-wrapped shell lines; each becomes shell.<name>.<counter>
+SHELL_SCRIPT = [
+    ("echo", "ECHO hello, perfcheck > T.TXT"),
+    ("copy", "COPY T.TXT U.TXT"),
+    ("type", "TYPE U.TXT"),
+    ("save", "SAVE"),
+    ("load", "LOAD"),
+]
+
+
+def run(cmd, stdin=None):
+    p = subprocess.run(cmd, input=stdin, capture_output=True, text=True, timeout=300)
+    if p.returncode:
+        raise SystemExit(f"{' '.join(cmd)}: exit {p.returncode}\n{p.stderr}")
+    return p
+
+
+def add(m, name, value, kind, better="lower", tol=None):
+    m[name] = {"value": value, "kind": kind, "better": better}
+    if tol is not None:
+        m[name]["tol"] = tol
+
+
+# ---- collectors: each returns {name: {value, kind, better}} ----
+
+def fs_bench(build, _):
+    out = json.loads(run([os.path.join(build, "fs_bench"), "--json", "--min-us", "10000"]).stdout)
+    m = {}
+    for r in out["results"]:
+        # A few ns per op moves by whole steps of the rounding
+        ns = r["ns_per_op"]
+        add(m, f"fs.{r['case']}.{r['param']}.ns_per_op", ns, "time", tol=2.0 if ns < 50 else None)
+    return m
+
+
+def xfer_bench(build, _):
+    p = run([os.path.join(build, "xfer_bench"), "--csv", "--reps", "10",
+             "--sizes", "256,16384", "--chunks", "64,240,480"])
+    m = {}
+    lines = [l for l in p.stdout.splitlines() if not l.startswith("#")]
+    for r in csv.DictReader(lines):
+        key = f"xfer.{r['size']}.{r['chunk']}"
+        add(m, key + ".frames", int(r["frames"]), "count")
+        add(m, key + ".attempts", int(r["attempts"]), "count")
+        # Throughput rides on pty wakeups and thread scheduling: small files
+        # are counts only, large ones get a wide margin
+        if int(r["size"]) >= 4096:
+            add(m, key + ".bytes_per_s", int(r["bytes_per_s"]), "time", "higher", tol=3.0)
+    return m
+
+
+def sys_bench(build, _):
+    p = run([os.path.join(build, "sys_shim"), "--bench", "--min-us", "10000"])
+    m = {}
+    for r in csv.DictReader(io.StringIO(p.stdout)):
+        ns = float(r["ns_per_call"])
+        add(m, f"sys.{r['case']}.ns_per_call", ns, "time", tol=2.0 if ns < 50 else None)
+    return m
+
+
+def shell_counts(build, _):
+    text = "".join(f"TIME {line}\n" for _, line in SHELL_SCRIPT)
+    out = run([os.path.join(build, "picodos_host")], stdin=text).stdout
+    blocks = out.split("[TIME]")[1:]
+    if len(blocks) != len(SHELL_SCRIPT):
+        raise SystemExit(f"picodos_host: expected {len(SHELL_SCRIPT)} TIME reports\n{out}")
+    m = {}
+    for (name, _), b in zip(SHELL_SCRIPT, blocks):
+        b = b.split("A:\\>")[0]
+        pats = {
+            "syscalls": r"(\d+) syscalls",
+            "vfs_opens": r"vfs: (\d+) opens",
+            "vfs_read_bytes": r"(\d+) B read",
+            "vfs_written_bytes": r"(\d+) B written",
+            "slot_peak_bytes": r"app slots: peak (\d+) B",
+        }
+        # The flash line is only printed when the command wrote flash
+        if "flash:" in b:
+            pats["flash_sectors"] = r"flash: (\d+) sectors erased"
+            pats["flash_pages"] = r"(\d+) pages programmed"
+        else:
+            add(m, f"shell.{name}.flash_sectors", 0, "count")
+            add(m, f"shell.{name}.flash_pages", 0, "count")
+        for key, pat in pats.items():
+            g = re.search(pat, b)
+            if not g:
+                raise SystemExit(f"picodos_host: TIME {name}: no match for {pat!r}\n{b}")
+            add(m, f"shell.{name}.{key}", int(g.group(1)), "count")
+    return m
+
+
+def write_sim_apps(build):
+    out = os.path.join(build, "perf_pxe")
+    os.makedirs(out, exist_ok=True)
+    paths = []
+    for name, code in SIM_APPS.items():
+        image = struct.pack(f"<{len(code)}H", *code)
+        # pxe_hdr_t: magic ver flags image_size bss_size entry_off data_off data_size reloc_count
+        hdr = struct.pack("<I H H I I I I I I", 0x30584550, 1, 0, len(image), 0, 0, 0, 0, 0)
+        path = os.path.join(out, name + ".PXE")
+        with open(path, "wb") as f:
+            f.write(hdr + image)
+        paths.append(path)
+    return paths
+
+
+def pxe_sim(build, pxe_dir):
+    paths = write_sim_apps(build)
+    if pxe_dir and os.path.isdir(pxe_dir):
+        paths += [os.path.join(pxe_dir, f) for f in sorted(os.listdir(pxe_dir))
+                  if f.upper().endswith(".PXE")]
+    m = {}
+    for path in paths:
+        p = run([os.path.join(build, "pxe_sim"), "--max-insns", "50000000", path])
+        g = re.search(r"# rc=(-?\d+) insns=(\d+) cycles=(\d+) svcs=(\d+)", p.stderr)
+        if not g:
+            raise SystemExit(f"pxe_sim {path}: no summary line\n{p.stderr}")
+        name = os.path.splitext(os.path.basename(path))[0].upper()
+        add(m, f"pxe.{name}.insns", int(g.group(2)), "count")
+        add(m, f"pxe.{name}.cycles", int(g.group(3)), "count")
+        add(m, f"pxe.{name}.svcs", int(g.group(4)), "count")
+    return m
+
+
+COLLECTORS = [
+    ("count", shell_counts),
+    ("count", pxe_sim),
+    ("time", fs_bench),
+    ("time", sys_bench),
+    (None, xfer_bench),        # both: frames are counts, throughput is time
+]
+
+
+def better_of(a, b):
+    if a["better"] == "higher":
+        return a if a["value"] >= b["value"] else b
+    return a if a["value"] <= b["value"] else b
+
+
+def measure(build, pxe_dir, kinds, runs):
+    m = {}
+    for kind, fn in COLLECTORS:
+        if kind and kind not in kinds:
+            continue
+        # Counts do not move between runs; one is enough
+        n = runs if kind != "count" and "time" in kinds else 1
+        for _ in range(n):
+            for name, v in fn(build, pxe_dir).items():
+                if v["kind"] not in kinds:
+                    continue
+                m[name] = better_of(v, m[name]) if name in m else v
+    return m
+
+
+def compare(base, now, kinds):
+    tol_default = dict(DEFAULT_TOL, **base.get("tolerance", {}))
+    bad, rows = [], []
+    for name, b in sorted(base["metrics"].items()):
+        if b["kind"] not in kinds:
+            continue
+        if name not in now:
+            rows.append((name, b["value"], None, "", "not run"))
+            continue
+        v = now[name]["value"]
+        tol = b.get("tol", tol_default[b["kind"]])
+        if b["value"] == 0:
+            change = 0.0 if v == 0 else float("inf")
+        else:
+            change = v / b["value"] - 1.0
+        worse = change if b["better"] == "lower" else (b["value"] / v - 1.0 if v else float("inf"))
+        if worse > tol:
+            status = f"REGRESSED (tol {tol:+.0%})"
+            bad.append(name)
+        elif worse < -tol:
+            status = "improved, consider --update"
+        else:
+            status = "ok"
+        rows.append((name, b["value"], v, f"{change:+.1%}", status))
+    for name in sorted(set(now) - set(base["metrics"])):
+        rows.append((name, None, now[name]["value"], "", "new, not gated until --update"))
+
+    w = max([len(r[0]) for r in rows] + [6])
+    fmt = lambda x: "-" if x is None else (f"{x:.1f}" if isinstance(x, float) else str(x))
+    print(f"{'metric':<{w}} {'baseline':>12} {'now':>12} {'change':>8}  status")
+    for name, b, v, ch, st in rows:
+        print(f"{name:<{w}} {fmt(b):>12} {fmt(v):>12} {ch:>8}  {st}")
+    return bad
+
+
+def main():
+    ap = argparse.ArgumentParser(description="host performance regression gate")
+    ap.add_argument("--build", required=True, help="host build directory")
+    ap.add_argument("--baseline", default=os.path.join(HERE, "perf_baseline.json"))
+    ap.add_argument("--kinds", default="count,time", help="count, time or both")
+    ap.add_argument("--runs", type=int, default=3, help="best of N for time metrics")
+    ap.add_argument("--pxe-dir", default="", help="directory with built .PXE apps")
+    ap.add_argument("--update", action="store_true", help="write this run as the baseline")
+    a = ap.parse_args()
+    kinds = set(a.kinds.split(","))
+
+    now = measure(a.build, a.pxe_dir, kinds, a.runs)
+    try:
+        with open(a.baseline) as f:
+            base = json.load(f)
+    except FileNotFoundError:
+        base = {"tolerance": DEFAULT_TOL, "metrics": {}}
+
+    if a.update:
+        # Keep metrics of kinds not run this time, and counts of sample apps
+        # not supplied this time (--pxe-dir)
+        metrics = {k: v for k, v in base["metrics"].items()
+                   if v["kind"] not in kinds or (k.startswith("pxe.") and k not in now)}
+        metrics.update(now)
+        base["metrics"] = dict(sorted(metrics.items()))
+        with open(a.baseline, "w") as f:
+            json.dump(base, f, indent=1)
+            f.write("\n")
+        print(f"{len(now)} metrics written to {a.baseline}")
+        return 0
+
+    bad = compare(base, now, kinds)
+    if bad:
+        print(f"{len(bad)} metric(s) regressed: {' '.join(bad)}")
+        return 1
+    print("no regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,118 @@
+// picodos_main.c: the PicoDOS shell as a Linux process
+//
+// Same startup as src/main.c with the board pieces swapped for host ones:
+// console on stdin/stdout (or a pty with --pty, for tools/send_pxe.py and
+// friends) and flash in a file (hal_flash_host.c).
+//
+//   picodos_host [--flash FILE] [--pty] [--fast-boot] [--boot-budget-us N]
+//                [--replay SCRIPT [--golden FILE] [--record FILE]
+//                 [--transcript FILE|-] [--latency-csv FILE] [--key-us N]]
+//
+// Without --flash the chip is in memory and SAVE lasts until exit. With a
+// file, LOAD / SAVE / the next start see what was saved, like a reboot.
+// --replay types SCRIPT into the shell and reports per-line latency
+// (replay.c); with --golden the exit status says whether the output matched.
+#include "dos/dos.h"
+#include "vfs/vfs.h"
+#include "fs/ramfs.h"
+#include "fs/flash_fs.h"
+#include "host_con.h"
+#include "hal_flash_host.h"
+#include "os/boot.h"
+#include "replay.h"
+
+#include <pty.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+static struct termios g_saved;
+
+static void restore_tty(void) { tcsetattr(0, TCSANOW, &g_saved); }
+
+// Character at a time, no local echo (the shell echoes); ^C still works
+static void tty_chars(void) {
+    struct termios t;
+    if (tcgetattr(0, &g_saved) < 0) return;
+    t = g_saved;
+    t.c_lflag &= ~(tcflag_t)(ICANON | ECHO);
+    t.c_cc[VMIN] = 1;
+    t.c_cc[VTIME] = 0;
+    tcsetattr(0, TCSANOW, &t);
+    atexit(restore_tty);
+}
+
+static int open_pty(void) {
+    int master, slave;
+    char name[64];
+    if (openpty(&master, &slave, name, NULL, NULL) < 0) { perror("openpty"); return -1; }
+    struct termios t;
+    tcgetattr(slave, &t);
+    cfmakeraw(&t);
+    tcsetattr(slave, TCSANOW, &t);
+    fprintf(stderr, "# console on %s\n", name);
+    // master stays open so the slave survives clients coming and going
+    return slave;
+}
+
+int main(int argc, char** argv) {
+    boot_mark(BOOT_MAIN);
+    const char* flash = NULL;
+    bool pty = false;
+    replay_opts_t rp = {0};
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i], "--flash") && i + 1 < argc) flash = argv[++i];
+        else if (!strcmp(argv[i], "--pty")) pty = true;
+        else if (!strcmp(argv[i], "--fast-boot")) boot_set_fast(true);
+        else if (!strcmp(argv[i], "--boot-budget-us") && i + 1 < argc) boot_set_budget_us((uint32_t)strtoul(argv[++i], NULL, 0));
+        else if (!strcmp(argv[i], "--replay") && i + 1 < argc) rp.script = argv[++i];
+        else if (!strcmp(argv[i], "--golden") && i + 1 < argc) rp.golden = argv[++i];
+        else if (!strcmp(argv[i], "--record") && i + 1 < argc) rp.record = argv[++i];
+        else if (!strcmp(argv[i], "--transcript") && i + 1 < argc) rp.transcript = argv[++i];
+        else if (!strcmp(argv[i], "--latency-csv") && i + 1 < argc) rp.csv = argv[++i];
+        else if (!strcmp(argv[i], "--key-us") && i + 1 < argc) rp.key_us = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else {
+            fprintf(stderr, "usage: %s [--flash FILE] [--pty] [--fast-boot] [--boot-budget-us N]\n"
+                            "       [--replay SCRIPT [--golden FILE] [--record FILE] [--transcript FILE|-]\n"
+                            "        [--latency-csv FILE] [--key-us N]]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (!hal_flash_host_open(flash)) return 1;
+    if (rp.script) {
+        if (!replay_start(&rp)) return 2;
+    } else if (pty) {
+        int fd = open_pty();
+        if (fd < 0) return 1;
+        host_con_set_fds(fd, fd);
+    } else if (isatty(0)) {
+        tty_chars();
+    } else {
+        host_con_set_exit_on_eof(true);   // scripted: stop at the end of input
+    }
+
+    boot_mark(BOOT_STDIO);
+
+    vfs_init();
+    boot_mark(BOOT_VFS);
+
+    ramfs_init();      // Provide A: drive in RAM
+    boot_mark(BOOT_RAMFS);
+    if (!boot_load_fs()) {
+        // On first run or corruption, keep initial RAMFS
+    }
+    boot_mark(BOOT_FLASH);
+    boot_mark(BOOT_OS);
+
+    dos_init();        // Register shell/apps, etc.
+    boot_mark(BOOT_DOS);
+
+    dos_println("PicoDOS (educational) 0.1");
+    dos_println("Type HELP.");
+
+    dos_run();         // COMMAND loop
+    return 0;
+}
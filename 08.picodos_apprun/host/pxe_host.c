@@ -0,0 +1,60 @@
+// pxe_host.c: PXE loader / core 1 jobs for the host build
+//
+// PXE images are Cortex-M0+ code: RUN / START hand them to the ARMv6-M
+// simulator (sim/), NETRUN reports that it needs the board, and everything
+// else (builtin apps, files, flash, xfer) runs the real code.
+#include "pxe/pxe_loader.h"
+#include "os/job.h"
+#include "vfs/vfs.h"
+#include "dos/dos.h"
+#include "dos/dos_sys.h"
+#include "sim_pxe.h"
+
+#define SIM_MAX_INSNS 100000000u
+
+static pxe_cache_stats_t g_stats;
+static job_info_t g_job;
+static pxe_hdr_t g_last_hdr;
+static bool g_last_valid;
+
+bool pxe_run_fixed(const char* path, int argc, char** argv) {
+    static uint8_t file[SIM_APP_BYTES];
+    vfs_err_t e;
+    int fd = vfs_open(path, VFS_O_RDONLY, &e);
+    if (fd < 0) { dos_puts("Cannot open PXE\r\n"); return false; }
+    int len = 0, n;
+    while (len < (int)sizeof(file) && (n = vfs_read(fd, file + len, sizeof(file) - (size_t)len, &e)) > 0) len += n;
+    vfs_close(fd);
+
+    sim_image_t img;
+    const char* err = NULL;
+    if (!sim_pxe_load(file, (size_t)len, SIM_APP_BASE, &img, &err)) {
+        dos_printf("Bad PXE: %s\r\n", err);
+        return false;
+    }
+    g_last_hdr = img.h;
+    g_last_valid = true;
+    sim_cpu_t cpu = {0};
+    int rc = sim_pxe_run(&cpu, &img, argc, argv, SIM_MAX_INSNS);
+    if (rc == SIM_FAULTED) dos_printf("App fault: %s at %08lx\r\n", cpu.fault, (unsigned long)cpu.fault_pc);
+    else if (rc == SIM_BUDGET) dos_puts("App stopped: instruction budget\r\n");
+    return rc == SIM_RETURNED;
+}
+
+bool pxe_run_wire(const char* save_path, int argc, char** argv) {
+    (void)save_path; (void)argc; (void)argv;
+    dos_puts("PXE apps need the board\r\n");
+    return false;
+}
+
+const pxe_cache_stats_t* pxe_cache_stats(void) { return &g_stats; }
+const pxe_hdr_t* pxe_last_header(void) { return g_last_valid ? &g_last_hdr : NULL; }
+void pxe_cache_flush(void) {}
+
+bool job_start(const char* path, int argc, char** argv) {
+    return pxe_run_fixed(path, argc, argv);
+}
+bool job_active(void) { return false; }
+bool job_wait(void) { return true; }
+bool job_kill(void) { return false; }
+const job_info_t* job_info(void) { return &g_job; }
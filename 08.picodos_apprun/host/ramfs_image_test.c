@@ -0,0 +1,88 @@
+// ramfs_image_test.c: ramfs_deserialize() against damaged images
+//
+// Flash images are trusted before their CRC is checked on a fast boot
+// (flash_fs_load_lazy), so the structural checks are all that stand
+// between a torn slot and out-of-bounds reads. The node layout is private
+// to ramfs.c: the fields to damage are found by value next to the name.
+#define _GNU_SOURCE     // memmem
+#include "fs/ramfs.h"
+#include "vfs/vfs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIZE 777
+
+static int g_fail;
+
+static void check(const char* what, bool ok) {
+    printf("%-32s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) g_fail++;
+}
+
+static bool file_size_is(const char* path, size_t want) {
+    ramfs_dirent_t d;
+    vfs_err_t e;
+    return ramfs_stat(path, &d, &e) && d.size == want;
+}
+
+int main(void) {
+    vfs_init();
+    ramfs_init();
+
+    static uint8_t data[SIZE];
+    vfs_err_t e;
+    int fd = vfs_open("A:\\T.TXT", VFS_O_WRONLY | VFS_O_CREAT | VFS_O_TRUNC, &e);
+    check("write test file", fd >= 0 && vfs_write(fd, data, SIZE, &e) == SIZE);
+    vfs_close(fd);
+
+    size_t len = ramfs_image_size();
+    uint8_t* img = malloc(len);
+    uint8_t* bad = malloc(len);
+    check("serialize", ramfs_serialize(img, len) == len);
+    check("deserialize intact", ramfs_deserialize(img, len) && file_size_is("A:\\T.TXT", SIZE));
+
+    // The test file's node: its name, and its size word a few bytes away
+    uint8_t* name = memmem(img, len, "T.TXT", 6);
+    size_t size_off = 0;
+    for (size_t k = 0; name && k < 64 && !size_off; k++) {
+        size_t v;
+        if (name + k + sizeof(v) <= img + len) {
+            memcpy(&v, name + k, sizeof(v));
+            if (v == SIZE) size_off = (size_t)(name - img) + k;
+        }
+        if (name - k - sizeof(v) >= img) {
+            memcpy(&v, name - k - sizeof(v), sizeof(v));
+            if (v == SIZE) size_off = (size_t)(name - img) - k - sizeof(v);
+        }
+    }
+    check("found node fields", name && size_off);
+
+    memcpy(bad, img, len);
+    size_t huge = 5000;
+    memcpy(bad + size_off, &huge, sizeof(huge));
+    check("file size past capacity", !ramfs_deserialize(bad, len));
+    check("state kept after rejection", file_size_is("A:\\T.TXT", SIZE));
+
+    memcpy(bad, img, len);
+    memset(bad + (name - img), 'X', 16);
+    check("unterminated name", !ramfs_deserialize(bad, len));
+
+    // Parent / child / sibling: the three ints right before the name.
+    // Any of them pointing far out of range must be refused.
+    for (size_t k = 4; k <= 12; k += 4) {
+        memcpy(bad, img, len);
+        int out = 1000;
+        memcpy(bad + (name - img) - k, &out, sizeof(out));
+        char what[40];
+        snprintf(what, sizeof(what), "link %zu bytes before name", k);
+        check(what, !ramfs_deserialize(bad, len));
+    }
+
+    check("deserialize intact again", ramfs_deserialize(img, len) && file_size_is("A:\\T.TXT", SIZE));
+    free(img);
+    free(bad);
+    printf("%d failed\n", g_fail);
+    return g_fail;
+}
@@ -0,0 +1,367 @@
+// replay.c: scripted console for picodos_host (--replay)
+//
+// The script is what a user would type, one shell line per script line;
+// each gets a CR after it. In a line, \b is backspace, \r CR, \xHH any
+// byte and \\ a backslash, so key-level editing can be replayed too.
+// Lines starting with '@' are directives:
+//   @key-us N              gap between keystrokes from here on
+//   @put HOSTFILE [NAME]   copy a host file into ramfs (e.g. a PXE to RUN)
+// '#' lines and blank lines are skipped.
+//
+// Latency of a line is measured from handing over its CR to the shell (or
+// the command) blocking for the next key, so it covers parsing, the
+// command and its console output. The boot is line 0: from main() to the
+// first wait. Non-blocking polls (^C checks) never see the script: type
+// ahead is not replayed, which keeps runs repeatable.
+//
+// Golden files hold the console output (CRs dropped); "{*}" in a golden
+// line matches any text, for times and sizes that vary from run to run.
+#include "replay.h"
+#include "host_con.h"
+#include "dos/dos_sys.h"
+#include "vfs/vfs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RP_KEYS_MAX   (64u * 1024u)
+#define RP_STEPS_MAX  1024
+#define RP_OUT_MAX    (512u * 1024u)
+#define RP_OLINES_MAX 16384
+
+enum { STEP_KEYS, STEP_KEY_US, STEP_PUT };
+
+typedef struct {
+    uint8_t  kind;
+    uint32_t off, len;      // keys (STEP_KEYS) or "host\0name" (STEP_PUT)
+    uint32_t arg;           // STEP_KEY_US
+    uint32_t script_line;
+    uint64_t us;            // measured latency (STEP_KEYS)
+} step_t;
+
+static replay_opts_t g_o;
+static char     g_keys[RP_KEYS_MAX];
+static uint32_t g_keys_len;
+static step_t   g_step[RP_STEPS_MAX];
+static int      g_steps;
+
+static int      g_cur;            // step being typed
+static uint32_t g_pos;            // next byte of it
+static uint32_t g_key_us;
+static uint64_t g_last_key;
+static int      g_waiting = -1;   // step whose CR went out, -1 none
+static uint64_t g_cr_at;
+static uint64_t g_boot_us;
+static bool     g_booted;
+
+// Captured output, with the time each output line started
+static char     g_out[RP_OUT_MAX];
+static uint32_t g_out_len;
+static uint32_t g_oline_off[RP_OLINES_MAX];
+static uint64_t g_oline_t[RP_OLINES_MAX];
+static int      g_olines;
+static bool     g_out_trunc;
+
+// ---- script ----
+
+static bool add_keys(const char* s, uint32_t* n) {
+    while (*s) {
+        char c = *s++;
+        if (c == '\\' && *s) {
+            char e = *s++;
+            if (e == 'b') c = '\b';
+            else if (e == 'r') c = '\r';
+            else if (e == 'x' && s[0] && s[1]) {
+                char hex[3] = { s[0], s[1], 0 };
+                c = (char)strtoul(hex, NULL, 16);
+                s += 2;
+            } else c = e;
+        }
+        if (g_keys_len >= RP_KEYS_MAX) return false;
+        g_keys[g_keys_len++] = c;
+        (*n)++;
+    }
+    return true;
+}
+
+static bool load_script(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) { perror(path); return false; }
+    char line[512];
+    uint32_t ln = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        ln++;
+        line[strcspn(line, "\r\n")] = 0;
+        if (!line[0] || line[0] == '#') continue;
+        if (g_steps >= RP_STEPS_MAX) { fprintf(stderr, "%s: more than %d steps\n", path, RP_STEPS_MAX); ok = false; break; }
+
+        step_t* st = &g_step[g_steps];
+        memset(st, 0, sizeof(*st));
+        st->script_line = ln;
+        st->off = g_keys_len;
+        if (line[0] == '@') {
+            char host[256], name[256];
+            unsigned long v;
+            int k;
+            if (sscanf(line, "@key-us %lu", &v) == 1) {
+                st->kind = STEP_KEY_US;
+                st->arg = (uint32_t)v;
+            } else if ((k = sscanf(line, "@put %255s %255s", host, name)) >= 1) {
+                if (k == 1) {
+                    const char* slash = strrchr(host, '/');
+                    snprintf(name, sizeof(name), "%s", slash ? slash + 1 : host);
+                }
+                st->kind = STEP_PUT;
+                size_t hl = strlen(host) + 1, nl = strlen(name) + 1;
+                if (g_keys_len + hl + nl > RP_KEYS_MAX) { ok = false; break; }
+                memcpy(g_keys + g_keys_len, host, hl);
+                memcpy(g_keys + g_keys_len + hl, name, nl);
+                g_keys_len += (uint32_t)(hl + nl);
+                st->len = (uint32_t)(hl + nl);
+            } else {
+                fprintf(stderr, "%s:%lu: unknown directive %s\n", path, (unsigned long)ln, line);
+                ok = false;
+                break;
+            }
+        } else {
+            st->kind = STEP_KEYS;
+            ok = add_keys(line, &st->len) && add_keys("\\r", &st->len);
+            if (!ok) fprintf(stderr, "%s: script over %u bytes\n", path, RP_KEYS_MAX);
+        }
+        g_steps++;
+    }
+    fclose(f);
+    return ok;
+}
+
+// HOSTFILE -> ramfs NAME; a failure shows up in the output, not as an abort
+static void put_file(const char* host, const char* name) {
+    FILE* f = fopen(host, "rb");
+    static uint8_t buf[64 * 1024];
+    size_t len = f ? fread(buf, 1, sizeof(buf), f) : 0;
+    if (f) fclose(f);
+    vfs_err_t e;
+    int fd = f ? vfs_open(name, VFS_O_WRONLY | VFS_O_CREAT | VFS_O_TRUNC, &e) : -1;
+    bool ok = fd >= 0 && vfs_write(fd, buf, len, &e) == (int)len;
+    if (fd >= 0) vfs_close(fd);
+    if (!ok) fprintf(stderr, "replay: cannot put %s as %s\n", host, name);
+}
+
+// ---- report ----
+
+// The line the shell ends up with: backspaces applied like read_line does
+static void edited(const step_t* st, char* out, size_t cap) {
+    size_t n = 0;
+    for (uint32_t i=0;i<st->len;i++) {
+        char c = g_keys[st->off + i];
+        if (c == 0x7f || c == '\b') { if (n) n--; continue; }
+        if ((uint8_t)c < 0x20) continue;
+        if (n + 1 < cap) out[n++] = c;
+    }
+    out[n] = 0;
+}
+
+// First word of the line, upper-cased: what the latency summary groups by
+static void cmd_name(const step_t* st, char* out, size_t cap) {
+    char line[128];
+    edited(st, line, sizeof(line));
+    size_t n = 0;
+    for (const char* p = line; *p && *p != ' ' && n + 1 < cap; p++)
+        out[n++] = (*p >= 'a' && *p <= 'z') ? (char)(*p - 'a' + 'A') : *p;
+    out[n] = 0;
+}
+
+static int cmp_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void report(FILE* f) {
+    char name[16], text[48];
+    fprintf(f, "  line          us  input\n");
+    fprintf(f, "  %4d %11llu  (boot)\n", 0, (unsigned long long)g_boot_us);
+    for (int i=0;i<g_steps;i++) {
+        if (g_step[i].kind != STEP_KEYS) continue;
+        edited(&g_step[i], text, sizeof(text));
+        fprintf(f, "  %4lu %11llu  %s\n", (unsigned long)g_step[i].script_line,
+            (unsigned long long)g_step[i].us, text);
+    }
+
+    // min / median / max per command, in order of first use
+    static uint64_t v[RP_STEPS_MAX];
+    fprintf(f, "  command      n         min      median         max\n");
+    for (int i=0;i<g_steps;i++) {
+        if (g_step[i].kind != STEP_KEYS) continue;
+        cmd_name(&g_step[i], name, sizeof(name));
+        bool seen = false;
+        char other[16];
+        for (int j=0;j<i && !seen;j++) {
+            if (g_step[j].kind != STEP_KEYS) continue;
+            cmd_name(&g_step[j], other, sizeof(other));
+            seen = !strcmp(name, other);
+        }
+        if (seen || !name[0]) continue;
+        int n = 0;
+        for (int j=i;j<g_steps;j++) {
+            if (g_step[j].kind != STEP_KEYS) continue;
+            cmd_name(&g_step[j], other, sizeof(other));
+            if (!strcmp(name, other)) v[n++] = g_step[j].us;
+        }
+        qsort(v, (size_t)n, sizeof(v[0]), cmp_u64);
+        fprintf(f, "  %-8s %5d %11llu %11llu %11llu\n", name, n, (unsigned long long)v[0],
+            (unsigned long long)v[n / 2], (unsigned long long)v[n - 1]);
+    }
+}
+
+static void write_csv(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) { perror(path); return; }
+    char name[16];
+    fprintf(f, "line,command,us\n0,(boot),%llu\n", (unsigned long long)g_boot_us);
+    for (int i=0;i<g_steps;i++) {
+        if (g_step[i].kind != STEP_KEYS) continue;
+        cmd_name(&g_step[i], name, sizeof(name));
+        fprintf(f, "%lu,%s,%llu\n", (unsigned long)g_step[i].script_line, name, (unsigned long long)g_step[i].us);
+    }
+    fclose(f);
+}
+
+static void write_transcript(const char* path) {
+    FILE* f = strcmp(path, "-") ? fopen(path, "w") : stdout;
+    if (!f) { perror(path); return; }
+    for (int i=0;i<g_olines;i++) {
+        uint32_t a = g_oline_off[i];
+        uint32_t b = i + 1 < g_olines ? g_oline_off[i + 1] : g_out_len;
+        while (b > a && (g_out[b-1] == '\n' || g_out[b-1] == '\r')) b--;
+        fprintf(f, "[%11.3f ms] ", (double)g_oline_t[i] / 1000.0);
+        for (uint32_t k=a;k<b;k++) if (g_out[k] != '\r') fputc(g_out[k], f);
+        fputc('\n', f);
+    }
+    if (f != stdout) fclose(f);
+}
+
+// ---- golden ----
+
+// pat may hold "{*}": any run of characters
+static bool match(const char* p, size_t pl, const char* s, size_t sl) {
+    while (pl) {
+        if (pl >= 3 && !memcmp(p, "{*}", 3)) {
+            for (size_t k=0;k<=sl;k++) if (match(p + 3, pl - 3, s + k, sl - k)) return true;
+            return false;
+        }
+        if (!sl || *p != *s) return false;
+        p++; pl--; s++; sl--;
+    }
+    return sl == 0;
+}
+
+// Next line of buf (CRs dropped into tmp); false at the end
+static bool next_line(const char* buf, size_t len, size_t* pos, char* tmp, size_t cap, size_t* out) {
+    if (*pos >= len) return false;
+    size_t n = 0;
+    while (*pos < len && buf[*pos] != '\n') {
+        if (buf[*pos] != '\r' && n + 1 < cap) tmp[n++] = buf[*pos];
+        (*pos)++;
+    }
+    if (*pos < len) (*pos)++;
+    tmp[n] = 0;
+    *out = n;
+    return true;
+}
+
+static bool compare_golden(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) { perror(path); return false; }
+    static char gold[RP_OUT_MAX];
+    size_t glen = fread(gold, 1, sizeof(gold), f);
+    fclose(f);
+
+    static char a[1024], b[1024];
+    size_t gp = 0, op = 0, al, bl;
+    for (int ln=1;;ln++) {
+        bool ga = next_line(gold, glen, &gp, a, sizeof(a), &al);
+        bool gb = next_line(g_out, g_out_len, &op, b, sizeof(b), &bl);
+        if (!ga && !gb) return true;
+        if (ga && gb && match(a, al, b, bl)) continue;
+        fprintf(stderr, "replay: output differs from %s at line %d\n  expected: %s\n  got:      %s\n",
+            path, ln, ga ? a : "(end of file)", gb ? b : "(end of output)");
+        return false;
+    }
+}
+
+static void finish(void) {
+    host_con_set_hooks(NULL, NULL);
+    if (g_out_trunc) fprintf(stderr, "replay: output over %u bytes, truncated\n", RP_OUT_MAX);
+    if (g_o.record) {
+        FILE* f = fopen(g_o.record, "wb");
+        if (f) {
+            for (uint32_t i=0;i<g_out_len;i++) if (g_out[i] != '\r') fputc(g_out[i], f);
+            fclose(f);
+        }
+        else perror(g_o.record);
+    }
+    if (g_o.transcript) write_transcript(g_o.transcript);
+    if (g_o.csv) write_csv(g_o.csv);
+    report(stderr);
+
+    bool ok = !g_o.golden || compare_golden(g_o.golden);
+    if (g_o.golden) fprintf(stderr, "replay: golden %s\n", ok ? "match" : "MISMATCH");
+    fflush(stdout);
+    exit(ok ? 0 : 1);
+}
+
+// ---- console hooks ----
+
+static void sleep_until(uint64_t t) {
+    uint64_t now = dos_time_us();
+    if (now >= t) return;
+    struct timespec ts = { (time_t)((t - now) / 1000000u), (long)((t - now) % 1000000u) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+static int rp_rx(int timeout_ms) {
+    if (timeout_ms == 0) return -1;
+    uint64_t now = dos_time_us();
+    if (!g_booted) { g_boot_us = now; g_booted = true; }
+    if (g_waiting >= 0) { g_step[g_waiting].us = now - g_cr_at; g_waiting = -1; }
+
+    while (g_cur < g_steps && g_step[g_cur].kind != STEP_KEYS) {
+        const step_t* st = &g_step[g_cur++];
+        if (st->kind == STEP_KEY_US) g_key_us = st->arg;
+        else put_file(g_keys + st->off, g_keys + st->off + strlen(g_keys + st->off) + 1);
+    }
+    if (g_cur >= g_steps) finish();
+
+    if (g_key_us && g_last_key) sleep_until(g_last_key + g_key_us);
+    g_last_key = dos_time_us();
+
+    step_t* st = &g_step[g_cur];
+    char c = g_keys[st->off + g_pos++];
+    if (g_pos == st->len) {
+        g_waiting = g_cur++;
+        g_pos = 0;
+        g_cr_at = dos_time_us();
+    }
+    return (uint8_t)c;
+}
+
+static void rp_tx(char c) {
+    if (g_out_len >= RP_OUT_MAX) { g_out_trunc = true; return; }
+    bool bol = g_out_len == 0 || g_out[g_out_len - 1] == '\n';
+    if (bol && g_olines < RP_OLINES_MAX) {
+        g_oline_off[g_olines] = g_out_len;
+        g_oline_t[g_olines++] = dos_time_us();
+    }
+    g_out[g_out_len++] = c;
+}
+
+bool replay_start(const replay_opts_t* o) {
+    g_o = *o;
+    g_key_us = o->key_us;
+    if (!load_script(o->script)) return false;
+    host_con_set_hooks(rp_rx, rp_tx);
+    return true;
+}
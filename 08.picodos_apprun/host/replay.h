@@ -0,0 +1,18 @@
+// replay.h: drive picodos_host from a script instead of a keyboard
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    const char* script;       // keystroke / line script (replay.c)
+    const char* golden;       // expected console output, or NULL
+    const char* record;       // write the console output here (a golden file)
+    const char* transcript;   // timestamped output ("-" = stdout), or NULL
+    const char* csv;          // per-line latency as CSV, or NULL
+    uint32_t    key_us;       // default gap between keystrokes
+} replay_opts_t;
+
+// Load the script and take over the console. When the shell asks for input
+// after the last line the run is reported and the process exits: 0 if the
+// output matched the golden file (or there was none), 1 if not.
+bool replay_start(const replay_opts_t* o);
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+# session_test.py: RECV /S against picodos_host, frames on its stdin
+#
+#   session_test.py path/to/picodos_host
+#
+# A committed session replaces an existing file; a failed one (bad CRC, or
+# an unknown entry kind) leaves it, and everything else, as it was. Input
+# sent right behind the COMMIT frame still reaches the shell.
+# Frame layout follows src/xfer/xfer_proto.h and tools/send_pxe.py.
+import os, select, struct, subprocess, sys, time
+
+
+def cobs(data):
+    out, idx = bytearray(), 0
+    while idx < len(data):
+        code_pos = len(out)
+        out.append(0)
+        code = 1
+        while idx < len(data) and data[idx] != 0 and code < 0xFF:
+            out.append(data[idx])
+            idx += 1
+            code += 1
+        out[code_pos] = code
+        if idx < len(data) and data[idx] == 0:
+            idx += 1
+    if data and data[-1] == 0:
+        out.append(1)
+    return bytes(out) + b"\0"
+
+
+def crc32_simple(data):
+    x = 0x12345678
+    for b in data:
+        x = ((x * 33) ^ b) & 0xFFFFFFFF
+    return x
+
+
+def session(entries):
+    """entries: (kind, rel, data, crc or None); kind 0 dir, 1 file"""
+    out = cobs(struct.pack("<B I H", 4, 0, len(entries)))
+    seq = 1
+    for kind, rel, data, crc in entries:
+        crc = crc32_simple(data) if crc is None else crc
+        out += cobs(struct.pack("<B I B H I I", 5, seq, kind, len(rel), len(data), crc) + rel.encode())
+        seq += 1
+        if data:
+            out += cobs(struct.pack("<B I H", 2, seq, len(data)) + data)
+            seq += 1
+    return out + cobs(struct.pack("<B I H", 6, seq, len(entries)))
+
+
+class Shell:
+    """picodos_host on pipes; each step waits for what the shell prints"""
+
+    def __init__(self, exe):
+        self.p = subprocess.Popen([exe], stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+        self.out = b""
+        self.log = b""
+
+    def expect(self, token, timeout=10.0):
+        end = time.time() + timeout
+        while token not in self.out:
+            left = end - time.time()
+            if left <= 0 or not select.select([self.p.stdout], [], [], left)[0]:
+                raise SystemExit(f"timeout waiting for {token!r}\n{self.text()}")
+            chunk = os.read(self.p.stdout.fileno(), 4096)
+            if not chunk:
+                raise SystemExit(f"picodos_host exited\n{self.text()}")
+            self.out += chunk
+
+    def send(self, data, wait=b"> "):
+        self.out = b""
+        self.p.stdin.write(data)
+        self.p.stdin.flush()
+        self.expect(wait)
+        self.log += self.out
+
+    def cmd(self, line):
+        self.send(line.encode() + b"\r")
+        return self.text()
+
+    def recv(self, entries):
+        self.send(b"RECV /S A:\\\r", wait=b"#READY")
+        reply = self.text()
+        self.send(session(entries))
+        return reply + self.text()
+
+    def text(self):
+        return self.out.decode("ascii", "replace").replace("\r", "")
+
+
+def main():
+    sh = Shell(sys.argv[1])
+    sh.expect(b"A:\\> ")
+    checks = []
+    sh.cmd("ECHO old > T.TXT")
+
+    r = sh.recv([(1, "T.TXT", b"new\r\n", None), (0, "D", b"", None)])
+    checks.append(("commit replaces existing file", "OK 2 entries" in r and "new" in sh.cmd("TYPE T.TXT")))
+
+    # Fails on the last entry: T.TXT is staged, D\X.TXT created by then
+    r = sh.recv([(1, "T.TXT", b"bad\r\n", None), (1, "D\\X.TXT", b"x", None), (1, "B.TXT", b"b", 0)])
+    checks.append(("bad CRC rolls back", "CRC mismatch" in r and "new" in sh.cmd("TYPE T.TXT")))
+    d = sh.cmd("DIR") + sh.cmd("CD D") + sh.cmd("DIR") + sh.cmd("CD \\")
+    checks.append(("created files removed", "X.TXT" not in d and "B.TXT" not in d))
+    checks.append(("staging file removed", "~SESS" not in d))
+
+    r = sh.recv([(1, "T.TXT", b"bad\r\n", None), (7, "C.TXT", b"", None)])
+    checks.append(("unknown entry kind rejected", "Bad ENTRY kind" in r and "new" in sh.cmd("TYPE T.TXT")))
+
+    # A line typed right behind COMMIT belongs to the shell, not the transfer
+    sh.send(b"RECV /S A:\\\r", wait=b"#READY")
+    sh.send(session([(1, "U.TXT", b"u", None)]) + b"ECHO typed ahead\r",
+            wait=b"\ntyped ahead\r\nA:\\> ")
+    checks.append(("input after COMMIT kept", "OK 1 entry" in sh.text()))
+    sh.p.stdin.close()
+    sh.p.wait(timeout=10)
+
+    fail = 0
+    for what, ok in checks:
+        print(f"{what:<32} {'ok' if ok else 'FAIL'}")
+        fail += not ok
+    if fail:
+        print(sh.log.decode("ascii", "replace"))
+    print(f"{fail} failed")
+    return fail
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,119 @@
+// pxe_sim.c: run a .PXE on the host under the ARMv6-M simulator
+//
+//   pxe_sim [--elf app.elf] [--base ADDR] [--max-insns N] [--csv]
+//           [--put HOSTFILE[=A:\NAME]]... app.pxe [args...]
+//
+// The app's console output goes to stdout through the real syscall / vfs
+// code. A summary line goes to stderr:
+//   # rc=0 insns=1234 cycles=2345 svcs=3
+// and with --elf a per-function profile follows it (CSV with --csv), so
+// app hot paths can be tracked per commit without a board.
+//
+// Exit status: 0 returned, 3 faulted, 4 hit --max-insns, 2 bad usage / image.
+#include "sim_pxe.h"
+#include "sim_prof.h"
+#include "vfs/vfs.h"
+#include "fs/ramfs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint8_t* slurp(const char* path, size_t* len) {
+    FILE* f = fopen(path, "rb");
+    if (!f) { perror(path); return NULL; }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* buf = malloc(n > 0 ? (size_t)n : 1);
+    if (fread(buf, 1, (size_t)n, f) != (size_t)n) { perror(path); free(buf); buf = NULL; }
+    fclose(f);
+    *len = (size_t)n;
+    return buf;
+}
+
+// HOSTFILE[=A:\NAME] -> ramfs, so the app can open it
+static bool put_file(const char* spec) {
+    char host[256];
+    const char* eq = strchr(spec, '=');
+    size_t hl = eq ? (size_t)(eq - spec) : strlen(spec);
+    if (hl >= sizeof(host)) return false;
+    memcpy(host, spec, hl);
+    host[hl] = '\0';
+    const char* name = eq ? eq + 1 : (strrchr(host, '/') ? strrchr(host, '/') + 1 : host);
+
+    size_t len;
+    uint8_t* data = slurp(host, &len);
+    if (!data) return false;
+    vfs_err_t e;
+    int fd = vfs_open(name, VFS_O_WRONLY | VFS_O_CREAT | VFS_O_TRUNC, &e);
+    bool ok = fd >= 0 && vfs_write(fd, data, len, &e) == (int)len;
+    if (fd >= 0) vfs_close(fd);
+    if (!ok) fprintf(stderr, "cannot put %s as %s (ramfs files hold 1 KB)\n", host, name);
+    free(data);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const char* elf = NULL;
+    uint32_t base = SIM_APP_BASE;
+    uint64_t max_insns = 100000000u;
+    bool csv = false;
+
+    vfs_init();
+    ramfs_init();
+    sim_mem_init();
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] == '-'; i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i+1] : "";
+        if (!strcmp(a, "--csv")) { csv = true; continue; }
+        if (!strcmp(a, "--elf")) elf = v;
+        else if (!strcmp(a, "--base")) base = (uint32_t)strtoul(v, NULL, 0);
+        else if (!strcmp(a, "--max-insns")) max_insns = strtoull(v, NULL, 0);
+        else if (!strcmp(a, "--put")) { if (!put_file(v)) return 2; }
+        else { fprintf(stderr, "unknown option %s\n", a); return 2; }
+        i++;
+    }
+    if (i >= argc) {
+        fprintf(stderr, "usage: pxe_sim [--elf app.elf] [--base ADDR] [--max-insns N] [--csv] [--put HOST[=NAME]] app.pxe [args...]\n");
+        return 2;
+    }
+
+    size_t len;
+    uint8_t* file = slurp(argv[i], &len);
+    if (!file) return 2;
+    sim_image_t img;
+    const char* err = NULL;
+    if (!sim_pxe_load(file, len, base, &img, &err)) {
+        fprintf(stderr, "%s: %s\n", argv[i], err);
+        return 2;
+    }
+    free(file);
+
+    sim_cpu_t cpu = {0};
+    sim_prof_t prof;
+    bool profiling = false;
+    if (elf) {
+        // XIP code stays at its link address; v2 images moved by base - link base
+        int32_t delta = (img.h.flags & PXE_F_XIP) ? 0 : (int32_t)(img.base - PXE_LINK_BASE);
+        profiling = sim_prof_load_elf(&prof, elf, delta);
+        if (!profiling) fprintf(stderr, "%s: no function symbols, profile skipped\n", elf);
+        else sim_prof_attach(&prof, &cpu);
+    }
+
+    // The app sees argv[0] = its file name, like RUN
+    int rc = sim_pxe_run(&cpu, &img, argc - i, &argv[i], max_insns);
+    fflush(stdout);
+
+    fprintf(stderr, "# rc=%d insns=%llu cycles=%llu svcs=%u\n", (int)cpu.r[0],
+            (unsigned long long)cpu.insns, (unsigned long long)cpu.cycles, cpu.svcs);
+    if (rc == SIM_FAULTED) fprintf(stderr, "# fault: %s at pc=0x%08x addr=0x%08x\n", cpu.fault, cpu.fault_pc, cpu.fault_addr);
+    if (rc == SIM_BUDGET) fprintf(stderr, "# stopped after %llu instructions\n", (unsigned long long)max_insns);
+    if (profiling) {
+        sim_prof_report(&prof, stderr, csv);
+        sim_prof_free(&prof);
+    }
+    return rc == SIM_RETURNED ? 0 : rc == SIM_FAULTED ? 3 : 4;
+}
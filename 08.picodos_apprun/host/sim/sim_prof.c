@@ -0,0 +1,128 @@
+// sim_prof.c: flat profile of a simulated run
+#include "sim_prof.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ELF32 little-endian, just enough for .symtab
+typedef struct { uint8_t ident[16]; uint16_t type, machine; uint32_t version, entry, phoff, shoff, flags;
+                 uint16_t ehsize, phentsize, phnum, shentsize, shnum, shstrndx; } elf_hdr_t;
+typedef struct { uint32_t name, type, flags, addr, offset, size, link, info, addralign, entsize; } elf_shdr_t;
+typedef struct { uint32_t name, value, size; uint8_t info, other; uint16_t shndx; } elf_sym_t;
+
+#define SHT_SYMTAB 2
+#define STT_FUNC   2
+
+static uint8_t* read_file(const char* path, size_t* len) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* buf = n > 0 ? malloc((size_t)n) : NULL;
+    if (buf && fread(buf, 1, (size_t)n, f) != (size_t)n) { free(buf); buf = NULL; }
+    fclose(f);
+    *len = (size_t)n;
+    return buf;
+}
+
+static int by_start(const void* a, const void* b) {
+    const sim_func_t* x = a;
+    const sim_func_t* y = b;
+    return x->start < y->start ? -1 : x->start > y->start;
+}
+
+bool sim_prof_load_elf(sim_prof_t* p, const char* elf_path, int32_t delta) {
+    memset(p, 0, sizeof(*p));
+    p->last = -1;
+    strcpy(p->other.name, "(unknown)");
+
+    size_t len;
+    uint8_t* buf = read_file(elf_path, &len);
+    if (!buf) return false;
+    const elf_hdr_t* eh = (const elf_hdr_t*)buf;
+    bool ok = len >= sizeof(*eh) && !memcmp(eh->ident, "\x7f" "ELF", 4) && eh->ident[4] == 1 &&
+              eh->shoff + (size_t)eh->shnum * sizeof(elf_shdr_t) <= len;
+
+    for (int s=0; ok && s<eh->shnum; s++) {
+        const elf_shdr_t* sh = (const elf_shdr_t*)(buf + eh->shoff) + s;
+        if (sh->type != SHT_SYMTAB || sh->link >= eh->shnum) continue;
+        const elf_shdr_t* strs = (const elf_shdr_t*)(buf + eh->shoff) + sh->link;
+        if (sh->offset + sh->size > len || strs->offset + strs->size > len) { ok = false; break; }
+
+        int n = (int)(sh->size / sizeof(elf_sym_t));
+        p->f = calloc((size_t)n + 1, sizeof(sim_func_t));
+        for (int i=0;i<n;i++) {
+            const elf_sym_t* sym = (const elf_sym_t*)(buf + sh->offset) + i;
+            if ((sym->info & 0xF) != STT_FUNC || !sym->size || sym->name >= strs->size) continue;
+            sim_func_t* f = &p->f[p->count++];
+            strncpy(f->name, (const char*)buf + strs->offset + sym->name, sizeof(f->name) - 1);
+            f->start = (sym->value & ~1u) + (uint32_t)delta;
+            f->end = f->start + sym->size;
+        }
+        break;
+    }
+    free(buf);
+    if (ok) qsort(p->f, (size_t)p->count, sizeof(sim_func_t), by_start);
+    return ok && p->count > 0;
+}
+
+static int find(const sim_prof_t* p, uint32_t pc) {
+    if (p->last >= 0 && pc >= p->f[p->last].start && pc < p->f[p->last].end) return p->last;
+    int lo = 0, hi = p->count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (pc < p->f[mid].start) hi = mid - 1;
+        else if (pc >= p->f[mid].end) lo = mid + 1;
+        else return mid;
+    }
+    return -1;
+}
+
+static void on_retire(void* ctx, uint32_t pc, uint32_t cycles) {
+    sim_prof_t* p = ctx;
+    int i = find(p, pc);
+    sim_func_t* f = i >= 0 ? &p->f[i] : &p->other;
+    if (i >= 0 && pc == f->start && i != p->last) f->calls++;
+    f->insns++;
+    f->cycles += cycles;
+    p->last = i;
+}
+
+void sim_prof_attach(sim_prof_t* p, sim_cpu_t* cpu) {
+    cpu->on_retire = on_retire;
+    cpu->ctx = p;
+}
+
+static int by_cycles(const void* a, const void* b) {
+    const sim_func_t* x = *(const sim_func_t* const*)a;
+    const sim_func_t* y = *(const sim_func_t* const*)b;
+    return x->cycles > y->cycles ? -1 : x->cycles < y->cycles;
+}
+
+void sim_prof_report(const sim_prof_t* p, FILE* out, bool csv) {
+    const sim_func_t** v = malloc(sizeof(*v) * ((size_t)p->count + 1));
+    int n = 0;
+    uint64_t total = p->other.cycles;
+    for (int i=0;i<p->count;i++) {
+        if (p->f[i].insns) v[n++] = &p->f[i];
+        total += p->f[i].cycles;
+    }
+    if (p->other.insns) v[n++] = &p->other;
+    qsort(v, (size_t)n, sizeof(*v), by_cycles);
+
+    if (csv) fprintf(out, "function,calls,insns,cycles\n");
+    else fprintf(out, "%-32s %8s %12s %12s %6s\n", "function", "calls", "insns", "cycles", "%");
+    for (int i=0;i<n;i++) {
+        const sim_func_t* f = v[i];
+        if (csv) fprintf(out, "%s,%u,%llu,%llu\n", f->name, f->calls, (unsigned long long)f->insns, (unsigned long long)f->cycles);
+        else fprintf(out, "%-32s %8u %12llu %12llu %5.1f%%\n", f->name, f->calls, (unsigned long long)f->insns,
+                     (unsigned long long)f->cycles, total ? 100.0 * (double)f->cycles / (double)total : 0.0);
+    }
+    free(v);
+}
+
+void sim_prof_free(sim_prof_t* p) {
+    free(p->f);
+    p->f = NULL;
+    p->count = 0;
+}
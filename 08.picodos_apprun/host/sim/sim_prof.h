@@ -0,0 +1,28 @@
+// sim_prof.h: per-function instruction / cycle counts from ELF symbols
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "thumb_sim.h"
+
+typedef struct {
+    char     name[48];
+    uint32_t start, end;   // [start, end) as loaded
+    uint64_t insns;
+    uint64_t cycles;
+    uint32_t calls;        // times execution arrived at start from elsewhere
+} sim_func_t;
+
+typedef struct {
+    sim_func_t* f;
+    int         count;
+    int         last;      // index of the function the previous PC was in
+    sim_func_t  other;     // PCs outside every symbol
+} sim_prof_t;
+
+// STT_FUNC symbols of an ARM ELF, shifted by delta (load base - link base)
+bool sim_prof_load_elf(sim_prof_t* p, const char* elf_path, int32_t delta);
+void sim_prof_attach(sim_prof_t* p, sim_cpu_t* cpu);
+// Sorted by cycles; csv = one "function,calls,insns,cycles" line each
+void sim_prof_report(const sim_prof_t* p, FILE* out, bool csv);
+void sim_prof_free(sim_prof_t* p);
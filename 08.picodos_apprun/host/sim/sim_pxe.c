@@ -0,0 +1,97 @@
+// sim_pxe.c: PXE loader for the simulator (same checks as pxe_loader.c)
+#include "sim_pxe.h"
+#include "pxe/pxe_lz.h"
+#include "os/syscall.h"
+#include <string.h>
+
+static uint8_t g_app[SIM_APP_BYTES];
+static uint8_t g_stack[SIM_STACK_BYTES];
+static uint8_t g_xip[64u * 1024u];
+
+bool sim_mem_init(void) {
+    static bool done;
+    if (done) return true;
+    done = syscall_map(SIM_APP_BASE, sizeof(g_app), g_app) &&
+           syscall_map(SIM_STACK_TOP - sizeof(g_stack), sizeof(g_stack), g_stack) &&
+           syscall_map(SIM_XIP_BASE, sizeof(g_xip), g_xip);
+    return done;
+}
+
+static bool fail(const char** err, const char* why) {
+    if (err) *err = why;
+    return false;
+}
+
+bool sim_pxe_load(const uint8_t* file, size_t len, uint32_t base, sim_image_t* img, const char** err) {
+    pxe_hdr_t* h = &img->h;
+    if (!sim_mem_init()) return fail(err, "cannot map guest memory");
+    if (len < sizeof(*h)) return fail(err, "short file");
+    memcpy(h, file, sizeof(*h));
+    if (h->magic != PXE_MAGIC || (h->ver != PXE_VER && h->ver != PXE_VER2)) return fail(err, "not a PXE image");
+    if (h->entry_off >= h->image_size) return fail(err, "entry outside image");
+    if (PXE_API_MAJOR(h)) return fail(err, "needs the OS runtime table (pxe_rt_shared), not simulated");
+
+    const bool xip = (h->flags & PXE_F_XIP) != 0;
+    const uint32_t rel_n = h->ver == PXE_VER2 ? h->reloc_count : 0;
+    const size_t payload = sizeof(*h) + PXE_RELOC_BYTES(h);
+    if (len < payload) return fail(err, "truncated relocation table");
+    if (h->ver != PXE_VER2 || xip) base = SIM_APP_BASE;   // only v2 moves
+    if (base < SIM_APP_BASE || (base & 7u)) return fail(err, "bad load address");
+
+    uint32_t ram = xip ? h->data_size + h->bss_size : h->image_size + h->bss_size;
+    if (ram > SIM_APP_BASE + SIM_APP_BYTES - base) return fail(err, "does not fit the app arena");
+    if (xip && h->image_size > sizeof(g_xip)) return fail(err, "does not fit the XIP window");
+
+    uint8_t* dst = xip ? g_xip : sys_uptr(base, h->image_size);
+    if (h->flags & PXE_F_LZ) {
+        pxe_lz_t z;
+        pxe_lz_init(&z, dst, h->image_size);
+        if (!pxe_lz_push(&z, file + payload, len - payload) || !pxe_lz_done(&z)) return fail(err, "bad LZ4 block");
+    } else {
+        if (len - payload < h->image_size) return fail(err, "truncated image");
+        memcpy(dst, file + payload, h->image_size);
+    }
+
+    // v2: add the load delta to every listed word
+    const int32_t delta = (int32_t)(base - PXE_LINK_BASE);
+    for (uint32_t i=0;i<rel_n;i++) {
+        uint32_t off = (uint32_t)file[sizeof(*h) + 2*i] | (uint32_t)file[sizeof(*h) + 2*i + 1] << 8;
+        if (off + 4 > h->image_size) return fail(err, "relocation outside image");
+        uint32_t v;
+        memcpy(&v, dst + off, 4);
+        v += (uint32_t)delta;
+        memcpy(dst + off, &v, 4);
+    }
+
+    uint8_t* bss = dst + h->image_size;
+    img->code = base;
+    if (xip) {
+        if (!(h->flags & PXE_F_DATA) || h->data_off + h->data_size > h->image_size) return fail(err, "XIP image without .data bounds");
+        memcpy(g_app, g_xip + h->data_off, h->data_size);
+        bss = g_app + h->data_size;
+        img->code = SIM_XIP_BASE;
+    }
+    memset(bss, 0, h->bss_size);
+    img->base = base;
+    img->entry = (img->code + h->entry_off) | 1u;
+    return true;
+}
+
+int sim_pxe_run(sim_cpu_t* cpu, const sim_image_t* img, int argc, char** argv, uint64_t max_insns) {
+    // argv strings, then the pointer array, at the top of the stack
+    uint32_t sp = SIM_STACK_TOP;
+    uint32_t ptr[16];
+    if (argc > 16) argc = 16;
+    for (int i=argc-1;i>=0;i--) {
+        size_t n = strlen(argv[i]) + 1;
+        sp -= (uint32_t)n;
+        memcpy(sys_uptr(sp, (uint32_t)n), argv[i], n);
+        ptr[i] = sp;
+    }
+    sp = (sp - 4u * (uint32_t)(argc + 1)) & ~7u;
+    uint8_t* av = sys_uptr(sp, 4u * (uint32_t)(argc + 1));
+    memcpy(av, ptr, 4u * (uint32_t)argc);
+    memset(av + 4u * (uint32_t)argc, 0, 4);
+
+    return sim_call(cpu, img->entry, sp, (uint32_t)argc, sp, 0, max_insns);
+}
@@ -0,0 +1,28 @@
+// sim_pxe.h: PXE images in the simulator, loaded by the board's rules
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pxe/pxe_format.h"
+#include "thumb_sim.h"
+
+#define SIM_APP_BASE    PXE_LINK_BASE   // 64 KB app arena (os/app_slot.h)
+#define SIM_APP_BYTES   (64u * 1024u)
+#define SIM_STACK_TOP   0x20042000u     // end of SRAM: apps run on the shell's stack
+#define SIM_STACK_BYTES (16u * 1024u)
+#define SIM_XIP_BASE    (0x10000000u + (2u * 1024u * 1024u) - 128u * 1024u)   // APP_XIP_OFFSET, 2 MB flash
+
+typedef struct {
+    pxe_hdr_t h;
+    uint32_t  base;    // where the image (XIP: .data) landed
+    uint32_t  code;    // where the code runs
+    uint32_t  entry;   // Thumb address of app_entry
+} sim_image_t;
+
+// Map app arena, stack and XIP window into the syscall guest map (once)
+bool sim_mem_init(void);
+// Load a whole .PXE file at base (v1 / XIP images ignore base). Clears
+// .bss. On failure *err says why.
+bool sim_pxe_load(const uint8_t* file, size_t len, uint32_t base, sim_image_t* img, const char** err);
+// app_entry(argc, argv, NULL) on the simulated stack
+int  sim_pxe_run(sim_cpu_t* cpu, const sim_image_t* img, int argc, char** argv, uint64_t max_insns);
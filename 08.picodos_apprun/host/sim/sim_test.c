@@ -0,0 +1,114 @@
+// sim_test.c: hand-assembled PXE images through the simulator
+//
+// Each case builds a tiny .PXE in memory (header, optional relocation table,
+// Thumb code), loads it with sim_pxe_load() and runs app_entry. One line per
+// case; the exit status is the failure count.
+#include "sim_pxe.h"
+#include "os/syscall.h"
+#include "vfs/vfs.h"
+#include "fs/ramfs.h"
+#include "host_con.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static int g_fail;
+static uint8_t g_file[1024];
+
+static void check(const char* what, bool ok) {
+    printf("%-32s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) g_fail++;
+}
+
+// Code halfwords (and literal words, little-endian) after a v1/v2 header
+static size_t build(uint16_t ver, const uint16_t* relocs, uint32_t nrel, const uint16_t* code, size_t n) {
+    pxe_hdr_t h = { .magic = PXE_MAGIC, .ver = ver, .image_size = (uint32_t)(n * 2), .reloc_count = nrel };
+    size_t off = sizeof(h);
+    memcpy(g_file, &h, sizeof(h));
+    memset(g_file + off, 0, PXE_RELOC_BYTES(&h));
+    for (uint32_t i=0;i<nrel;i++) { g_file[off + 2*i] = (uint8_t)relocs[i]; g_file[off + 2*i + 1] = (uint8_t)(relocs[i] >> 8); }
+    off += PXE_RELOC_BYTES(&h);
+    for (size_t i=0;i<n;i++) { g_file[off++] = (uint8_t)code[i]; g_file[off++] = (uint8_t)(code[i] >> 8); }
+    return off;
+}
+
+static int run(sim_cpu_t* cpu, size_t len, uint32_t base) {
+    sim_image_t img;
+    const char* err = NULL;
+    if (!sim_pxe_load(g_file, len, base, &img, &err)) { printf("  load: %s\n", err); return -99; }
+    char* argv[] = { "T.PXE", NULL };
+    memset(cpu, 0, sizeof(*cpu));
+    return sim_pxe_run(cpu, &img, 1, argv, 10000);
+}
+
+int main(void) {
+    vfs_init();
+    ramfs_init();
+    check("map guest memory", sim_mem_init());
+
+    // Console output into a pipe we read back
+    int in[2], out[2];
+    if (pipe(in) < 0 || pipe(out) < 0) return 1;
+    fcntl(out[0], F_SETFL, O_NONBLOCK);
+    host_con_set_fds(in[0], out[1]);
+
+    sim_cpu_t cpu;
+
+    // movs r0,#0; movs r1,#10; 1: adds r0,r1; subs r1,#1; bne 1b; bx lr
+    static const uint16_t sum[] = { 0x2000, 0x210A, 0x1840, 0x3901, 0xD1FC, 0x4770 };
+    int rc = run(&cpu, build(PXE_VER, NULL, 0, sum, 6), SIM_APP_BASE);
+    check("loop sums 1..10", rc == SIM_RETURNED && cpu.r[0] == 55);
+    check("loop retires 33 insns", cpu.insns == 33);
+    check("taken branches cost extra", cpu.cycles > cpu.insns);
+
+    // push {r4,lr}; bl f; adds r0,#1; pop {r4,pc}; f: movs r0,#41; bx lr
+    static const uint16_t call[] = { 0xB510, 0xF000, 0xF802, 0x3001, 0xBD10, 0x2029, 0x4770 };
+    rc = run(&cpu, build(PXE_VER, NULL, 0, call, 7), SIM_APP_BASE);
+    check("bl / push / pop", rc == SIM_RETURNED && cpu.r[0] == 42);
+
+    // movs r0,#1; adr r1,msg; movs r2,#3; movs r3,#SYS_write; mov r12,r3; svc 0; bx lr; msg: "hi\n"
+    static const uint16_t svc[] = { 0x2001, 0xA103, 0x2203, 0x2300 | SYS_write, 0x469C, 0xDF00, 0x4770, 0x0000,
+                                    'h' | 'i' << 8, '\n' };
+    rc = run(&cpu, build(PXE_VER, NULL, 0, svc, 10), SIM_APP_BASE);
+    char got[16] = {0};
+    ssize_t n = read(out[0], got, sizeof(got) - 1);
+    check("svc write reaches the console", rc == SIM_RETURNED && cpu.r[0] == 3 && cpu.svcs == 1);
+    check("console shows the text", n >= 3 && !memcmp(got, "hi", 2));
+
+    // ldr r0,=str; ldrb r0,[r0]; bx lr; .word LINK+12; str: "Z"  (v2, literal relocated)
+    static const uint16_t rel[] = { 0x4801, 0x7800, 0x4770, 0x0000,
+                                    (uint16_t)(PXE_LINK_BASE + 12), (uint16_t)((PXE_LINK_BASE + 12) >> 16), 'Z' };
+    static const uint16_t rel_at[] = { 8 };
+    rc = run(&cpu, build(PXE_VER2, rel_at, 1, rel, 7), SIM_APP_BASE + 0x100);
+    check("v2 relocation at base+0x100", rc == SIM_RETURNED && cpu.r[0] == 'Z');
+
+    // movs r0,#0; subs r0,#5; cmp r0,#0; blt 1f; bx lr; 1: lsrs r0,r0,#28; bx lr
+    static const uint16_t sgn[] = { 0x2000, 0x3805, 0x2800, 0xDB00, 0x4770, 0x0F00, 0x4770 };
+    rc = run(&cpu, build(PXE_VER, NULL, 0, sgn, 7), SIM_APP_BASE);
+    check("signed compare / lsrs", rc == SIM_RETURNED && cpu.r[0] == 0xF);
+
+    // movs r0,#0x12; movs r1,#3; muls r0,r1; rev16 r0,r0; lsrs r0,#8; uxtb r0,r0; bx lr
+    static const uint16_t mul[] = { 0x2012, 0x2103, 0x4348, 0xBA40, 0x0A00, 0xB2C0, 0x4770 };
+    rc = run(&cpu, build(PXE_VER, NULL, 0, mul, 7), SIM_APP_BASE);
+    check("muls / rev16 / uxtb", rc == SIM_RETURNED && cpu.r[0] == 0x36);
+
+    // adds r1,#1; ldr r0,[r1]; bx lr  (argv + 1 is not word aligned)
+    static const uint16_t una[] = { 0x3101, 0x6808, 0x4770 };
+    rc = run(&cpu, build(PXE_VER, NULL, 0, una, 3), SIM_APP_BASE);
+    check("unaligned ldr faults", rc == SIM_FAULTED && cpu.fault_pc == SIM_APP_BASE + 2);
+
+    // b . never returns
+    static const uint16_t spin[] = { 0xE7FE };
+    rc = run(&cpu, build(PXE_VER, NULL, 0, spin, 1), SIM_APP_BASE);
+    check("instruction budget stops it", rc == SIM_BUDGET && cpu.insns == 10000);
+
+    // Same image, but asking for the OS runtime table
+    size_t len = build(PXE_VER, NULL, 0, spin, 1);
+    ((pxe_hdr_t*)g_file)->flags = 1u << PXE_F_API_SHIFT;
+    sim_image_t img;
+    const char* err;
+    check("runtime-table image is refused", !sim_pxe_load(g_file, len, SIM_APP_BASE, &img, &err));
+    return g_fail;
+}
@@ -0,0 +1,400 @@
+// thumb_sim.c: ARMv6-M instruction set, one halfword at a time
+#include "thumb_sim.h"
+#include "os/syscall.h"
+#include <string.h>
+
+static bool fault(sim_cpu_t* c, uint32_t pc, const char* why, uint32_t addr) {
+    c->fault = why;
+    c->fault_pc = pc;
+    c->fault_addr = addr;
+    return false;
+}
+
+// ---- memory (through the syscall guest map) ----
+
+static uint8_t* mem(sim_cpu_t* c, uint32_t pc, uint32_t addr, uint32_t size) {
+    if (addr & (size - 1)) { fault(c, pc, "unaligned access", addr); return NULL; }
+    uint8_t* p = sys_uptr(addr, size);
+    if (!p) fault(c, pc, "bus fault", addr);
+    return p;
+}
+
+static bool ld(sim_cpu_t* c, uint32_t pc, uint32_t addr, uint32_t size, uint32_t* out) {
+    uint8_t* p = mem(c, pc, addr, size);
+    if (!p) return false;
+    if (size == 4) *out = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    else if (size == 2) *out = (uint32_t)p[0] | (uint32_t)p[1] << 8;
+    else *out = p[0];
+    return true;
+}
+
+static bool st(sim_cpu_t* c, uint32_t pc, uint32_t addr, uint32_t size, uint32_t v) {
+    uint8_t* p = mem(c, pc, addr, size);
+    if (!p) return false;
+    for (uint32_t i=0;i<size;i++) p[i] = (uint8_t)(v >> (8 * i));
+    return true;
+}
+
+// ---- flags ----
+
+static void nz(sim_cpu_t* c, uint32_t r) {
+    c->n = (r >> 31) != 0;
+    c->z = r == 0;
+}
+
+static uint32_t adc(sim_cpu_t* c, uint32_t x, uint32_t y, bool carry) {
+    uint64_t u = (uint64_t)x + y + carry;
+    uint32_t r = (uint32_t)u;
+    nz(c, r);
+    c->c = (u >> 32) != 0;
+    c->v = ((~(x ^ y) & (x ^ r)) >> 31) != 0;
+    return r;
+}
+
+static uint32_t sub(sim_cpu_t* c, uint32_t x, uint32_t y) { return adc(c, x, ~y, true); }
+
+static bool cond(const sim_cpu_t* c, uint32_t cc) {
+    switch (cc) {
+    case 0x0: return c->z;
+    case 0x1: return !c->z;
+    case 0x2: return c->c;
+    case 0x3: return !c->c;
+    case 0x4: return c->n;
+    case 0x5: return !c->n;
+    case 0x6: return c->v;
+    case 0x7: return !c->v;
+    case 0x8: return c->c && !c->z;
+    case 0x9: return !c->c || c->z;
+    case 0xA: return c->n == c->v;
+    case 0xB: return c->n != c->v;
+    case 0xC: return !c->z && c->n == c->v;
+    case 0xD: return c->z || c->n != c->v;
+    default:  return true;
+    }
+}
+
+// Shift by register (amount = low byte), carry out as the ARM ARM defines it
+enum { SH_LSL, SH_LSR, SH_ASR, SH_ROR };
+
+static uint32_t shift(sim_cpu_t* c, int type, uint32_t m, uint32_t n) {
+    if (n == 0) return m;
+    switch (type) {
+    case SH_LSL:
+        if (n < 32) { c->c = (m >> (32 - n)) & 1; return m << n; }
+        c->c = n == 32 ? (m & 1) : 0;
+        return 0;
+    case SH_LSR:
+        if (n < 32) { c->c = (m >> (n - 1)) & 1; return m >> n; }
+        c->c = n == 32 ? (m >> 31) : 0;
+        return 0;
+    case SH_ASR:
+        if (n < 32) { c->c = (m >> (n - 1)) & 1; return (uint32_t)((int32_t)m >> n); }
+        c->c = m >> 31;
+        return (uint32_t)((int32_t)m >> 31);
+    default: {
+        n &= 31;
+        uint32_t r = n ? (m >> n) | (m << (32 - n)) : m;
+        c->c = r >> 31;
+        return r;
+    }
+    }
+}
+
+static uint32_t sext(uint32_t v, int bits) {
+    uint32_t m = 1u << (bits - 1);
+    return (v ^ m) - m;
+}
+
+static uint32_t popcount(uint32_t v) { return (uint32_t)__builtin_popcount(v); }
+
+void sim_reset(sim_cpu_t* c) {
+    void (*on_insn)(void*, uint32_t) = c->on_insn;
+    void (*on_retire)(void*, uint32_t, uint32_t) = c->on_retire;
+    void* ctx = c->ctx;
+    memset(c, 0, sizeof(*c));
+    c->on_insn = on_insn;
+    c->on_retire = on_retire;
+    c->ctx = ctx;
+}
+
+// Everything that writes the PC lands here
+static bool branch(sim_cpu_t* c, uint32_t pc, uint32_t target, uint32_t* next) {
+    if ((target & ~1u) == SIM_RETURN_ADDR) { *next = SIM_RETURN_ADDR; return true; }
+    *next = target & ~1u;
+    return true;
+}
+
+static bool exchange(sim_cpu_t* c, uint32_t pc, uint32_t target, uint32_t* next) {
+    // ARMv6-M has no ARM state: BX to an even address is a HardFault
+    if (!(target & 1u) && (target & ~1u) != SIM_RETURN_ADDR) return fault(c, pc, "interworking to ARM state", target);
+    return branch(c, pc, target, next);
+}
+
+static bool exec32(sim_cpu_t* c, uint32_t pc, uint16_t hw1, uint32_t* next, uint32_t* cyc) {
+    uint32_t hw2;
+    if (!ld(c, pc, pc + 2, 2, &hw2)) return false;
+    uint32_t* r = c->r;
+    *next = pc + 4;
+
+    if ((hw1 & 0xF800) == 0xF000 && (hw2 & 0xD000) == 0xD000) {            // BL
+        uint32_t s = (hw1 >> 10) & 1, j1 = (hw2 >> 13) & 1, j2 = (hw2 >> 11) & 1;
+        uint32_t i1 = !(j1 ^ s), i2 = !(j2 ^ s);
+        uint32_t imm = s << 24 | i1 << 23 | i2 << 22 | (hw1 & 0x3FFu) << 12 | (hw2 & 0x7FFu) << 1;
+        r[14] = (pc + 4) | 1u;
+        *cyc = 3;
+        return branch(c, pc, pc + 4 + sext(imm, 25), next);
+    }
+    if ((hw1 & 0xFFF0) == 0xF380 && (hw2 & 0xFF00) == 0x8800) {             // MSR
+        uint32_t sysm = hw2 & 0xFF;
+        uint32_t v = r[hw1 & 0xF];
+        if (sysm == 8 || sysm == 9) r[13] = v & ~3u;   // MSP / PSP: one stack here
+        else if (sysm <= 3) { c->n = v >> 31; c->z = (v >> 30) & 1; c->c = (v >> 29) & 1; c->v = (v >> 28) & 1; }
+        *cyc = 3;
+        return true;
+    }
+    if (hw1 == 0xF3EF && (hw2 & 0xF000) == 0x8000) {                        // MRS
+        uint32_t sysm = hw2 & 0xFF, d = (hw2 >> 8) & 0xF, v = 0;
+        if (sysm == 8 || sysm == 9) v = r[13];
+        else if (sysm <= 3) v = (uint32_t)c->n << 31 | (uint32_t)c->z << 30 | (uint32_t)c->c << 29 | (uint32_t)c->v << 28;
+        r[d] = v;
+        *cyc = 3;
+        return true;
+    }
+    if (hw1 == 0xF3BF && (hw2 & 0xFF00) == 0x8F00) {                        // DSB / DMB / ISB
+        *cyc = 3;
+        return true;
+    }
+    return fault(c, pc, "undefined 32-bit instruction", pc);
+}
+
+bool sim_step(sim_cpu_t* c) {
+    uint32_t* r = c->r;
+    const uint32_t pc = r[15];
+    if (pc == SIM_RETURN_ADDR || c->fault) return false;
+    if (c->on_insn) c->on_insn(c->ctx, pc);
+
+    uint32_t op;
+    if (!ld(c, pc, pc, 2, &op)) return false;
+    const uint32_t pcr = pc + 4;          // PC as instructions read it
+    uint32_t next = pc + 2, cyc = 1;
+    const uint32_t lo_d = op & 7, lo_n = (op >> 3) & 7;
+
+    switch (op >> 11) {
+    case 0x00: case 0x01: case 0x02: {                                      // LSLS/LSRS/ASRS imm
+        uint32_t imm = (op >> 6) & 31, m = r[lo_n];
+        int type = (int)(op >> 11);
+        if (imm == 0 && type != SH_LSL) imm = 32;
+        r[lo_d] = shift(c, type, m, imm);
+        nz(c, r[lo_d]);
+        break;
+    }
+    case 0x03: {                                                            // ADDS/SUBS reg / imm3
+        uint32_t x = r[lo_n], y = (op & 0x400) ? (op >> 6) & 7 : r[(op >> 6) & 7];
+        r[lo_d] = (op & 0x200) ? sub(c, x, y) : adc(c, x, y, false);
+        break;
+    }
+    case 0x04: r[(op >> 8) & 7] = op & 0xFF; nz(c, op & 0xFF); break;      // MOVS imm8
+    case 0x05: sub(c, r[(op >> 8) & 7], op & 0xFF); break;                  // CMP imm8
+    case 0x06: r[(op >> 8) & 7] = adc(c, r[(op >> 8) & 7], op & 0xFF, false); break;
+    case 0x07: r[(op >> 8) & 7] = sub(c, r[(op >> 8) & 7], op & 0xFF); break;
+
+    case 0x08:
+        if (!(op & 0x400)) {                                                // data processing
+            uint32_t d = lo_d, m = r[lo_n], x = r[d], res;
+            switch ((op >> 6) & 0xF) {
+            case 0x0: r[d] = x & m; nz(c, r[d]); break;
+            case 0x1: r[d] = x ^ m; nz(c, r[d]); break;
+            case 0x2: r[d] = shift(c, SH_LSL, x, m & 0xFF); nz(c, r[d]); break;
+            case 0x3: r[d] = shift(c, SH_LSR, x, m & 0xFF); nz(c, r[d]); break;
+            case 0x4: r[d] = shift(c, SH_ASR, x, m & 0xFF); nz(c, r[d]); break;
+            case 0x5: r[d] = adc(c, x, m, c->c); break;
+            case 0x6: r[d] = adc(c, x, ~m, c->c); break;
+            case 0x7: r[d] = shift(c, SH_ROR, x, m & 0xFF); nz(c, r[d]); break;
+            case 0x8: nz(c, x & m); break;
+            case 0x9: r[d] = sub(c, 0, m); break;                           // RSBS #0
+            case 0xA: sub(c, x, m); break;
+            case 0xB: adc(c, x, m, false); break;
+            case 0xC: r[d] = x | m; nz(c, r[d]); break;
+            case 0xD: r[d] = x * m; nz(c, r[d]); break;                     // single-cycle multiplier
+            case 0xE: r[d] = x & ~m; nz(c, r[d]); break;
+            default:  res = ~m; r[d] = res; nz(c, res); break;
+            }
+            break;
+        }
+        {                                                                   // hi registers / BX
+            uint32_t d = (op & 7) | ((op >> 4) & 8), m = (op >> 3) & 0xF;
+            uint32_t vm = m == 15 ? pcr : r[m], vd = d == 15 ? pcr : r[d];
+            switch ((op >> 8) & 3) {
+            case 0:
+                if (d == 15) { cyc = 2; if (!branch(c, pc, vd + vm, &next)) return false; }
+                else r[d] = d == 13 ? (vd + vm) & ~3u : vd + vm;
+                break;
+            case 1: sub(c, vd, vm); break;
+            case 2:
+                if (d == 15) { cyc = 2; if (!branch(c, pc, vm, &next)) return false; }
+                else r[d] = d == 13 ? vm & ~3u : vm;
+                break;
+            default:
+                if (op & 0x80) r[14] = (pc + 2) | 1u;                       // BLX
+                cyc = 2;
+                if (!exchange(c, pc, vm, &next)) return false;
+                break;
+            }
+        }
+        break;
+
+    case 0x09: {                                                            // LDR literal
+        uint32_t v;
+        if (!ld(c, pc, (pcr & ~3u) + (op & 0xFF) * 4, 4, &v)) return false;
+        r[(op >> 8) & 7] = v;
+        cyc = 2;
+        break;
+    }
+    case 0x0A: case 0x0B: {                                                 // load / store, register offset
+        uint32_t a = r[lo_n] + r[(op >> 6) & 7], v;
+        cyc = 2;
+        switch ((op >> 9) & 7) {
+        case 0: if (!st(c, pc, a, 4, r[lo_d])) return false; break;
+        case 1: if (!st(c, pc, a, 2, r[lo_d])) return false; break;
+        case 2: if (!st(c, pc, a, 1, r[lo_d])) return false; break;
+        case 3: if (!ld(c, pc, a, 1, &v)) return false; r[lo_d] = sext(v, 8); break;
+        case 4: if (!ld(c, pc, a, 4, &v)) return false; r[lo_d] = v; break;
+        case 5: if (!ld(c, pc, a, 2, &v)) return false; r[lo_d] = v; break;
+        case 6: if (!ld(c, pc, a, 1, &v)) return false; r[lo_d] = v; break;
+        default: if (!ld(c, pc, a, 2, &v)) return false; r[lo_d] = sext(v, 16); break;
+        }
+        break;
+    }
+    case 0x0C: case 0x0D: case 0x0E: case 0x0F: case 0x10: case 0x11: {   // load / store, imm5
+        static const uint8_t size[] = { 4, 4, 1, 1, 2, 2 };
+        uint32_t k = (op >> 11) - 0x0C, sz = size[k];
+        uint32_t a = r[lo_n] + ((op >> 6) & 31) * sz, v;
+        cyc = 2;
+        if (k & 1) { if (!ld(c, pc, a, sz, &v)) return false; r[lo_d] = v; }
+        else if (!st(c, pc, a, sz, r[lo_d])) return false;
+        break;
+    }
+    case 0x12: case 0x13: {                                                 // STR / LDR [sp, #imm8*4]
+        uint32_t a = r[13] + (op & 0xFF) * 4, t = (op >> 8) & 7, v;
+        cyc = 2;
+        if (op & 0x800) { if (!ld(c, pc, a, 4, &v)) return false; r[t] = v; }
+        else if (!st(c, pc, a, 4, r[t])) return false;
+        break;
+    }
+    case 0x14: r[(op >> 8) & 7] = (pcr & ~3u) + (op & 0xFF) * 4; break;    // ADR
+    case 0x15: r[(op >> 8) & 7] = r[13] + (op & 0xFF) * 4; break;           // ADD rd, sp, #imm
+
+    case 0x16: case 0x17:                                                   // miscellaneous
+        if ((op & 0xFF00) == 0xB000) {                                      // ADD/SUB sp, #imm7*4
+            uint32_t imm = (op & 0x7F) * 4;
+            r[13] = (op & 0x80) ? r[13] - imm : r[13] + imm;
+        } else if ((op & 0xFF00) == 0xB200) {                               // SXTH/SXTB/UXTH/UXTB
+            uint32_t m = r[lo_n];
+            switch ((op >> 6) & 3) {
+            case 0: r[lo_d] = sext(m & 0xFFFF, 16); break;
+            case 1: r[lo_d] = sext(m & 0xFF, 8); break;
+            case 2: r[lo_d] = m & 0xFFFF; break;
+            default: r[lo_d] = m & 0xFF; break;
+            }
+        } else if ((op & 0xFE00) == 0xB400) {                               // PUSH
+            uint32_t list = (op & 0xFF) | ((op & 0x100) ? 0x4000u : 0);
+            uint32_t a = r[13] - 4 * popcount(list);
+            r[13] = a;
+            for (int i=0;i<15;i++) {
+                if (!(list & (1u << i))) continue;
+                if (!st(c, pc, a, 4, r[i])) return false;
+                a += 4;
+            }
+            cyc = 1 + popcount(list);
+        } else if ((op & 0xFFEF) == 0xB662) {                               // CPSIE/CPSID i
+        } else if ((op & 0xFFC0) == 0xBA00) {                               // REV
+            uint32_t m = r[lo_n];
+            r[lo_d] = m >> 24 | (m >> 8 & 0xFF00) | (m << 8 & 0xFF0000) | m << 24;
+        } else if ((op & 0xFFC0) == 0xBA40) {                               // REV16
+            uint32_t m = r[lo_n];
+            r[lo_d] = (m >> 8 & 0x00FF00FF) | (m << 8 & 0xFF00FF00);
+        } else if ((op & 0xFFC0) == 0xBAC0) {                               // REVSH
+            uint32_t m = r[lo_n];
+            r[lo_d] = sext(((m >> 8) & 0xFF) | ((m & 0xFF) << 8), 16);
+        } else if ((op & 0xFE00) == 0xBC00) {                               // POP
+            uint32_t list = op & 0xFF, a = r[13], v;
+            for (int i=0;i<8;i++) {
+                if (!(list & (1u << i))) continue;
+                if (!ld(c, pc, a, 4, &v)) return false;
+                r[i] = v;
+                a += 4;
+            }
+            cyc = 1 + popcount(list);
+            if (op & 0x100) {
+                if (!ld(c, pc, a, 4, &v)) return false;
+                a += 4;
+                cyc += 3;
+                r[13] = a;
+                if (!exchange(c, pc, v, &next)) return false;
+            }
+            r[13] = a;
+        } else if ((op & 0xFF00) == 0xBE00) {
+            return fault(c, pc, "breakpoint", pc);
+        } else if ((op & 0xFF0F) == 0xBF00) {                               // NOP/YIELD/WFE/WFI/SEV
+        } else {
+            return fault(c, pc, "undefined instruction", pc);
+        }
+        break;
+
+    case 0x18: case 0x19: {                                                 // STM / LDM
+        uint32_t n = (op >> 8) & 7, list = op & 0xFF, a = r[n], v;
+        if (!list) return fault(c, pc, "empty register list", pc);
+        for (int i=0;i<8;i++) {
+            if (!(list & (1u << i))) continue;
+            if (op & 0x800) { if (!ld(c, pc, a, 4, &v)) return false; r[i] = v; }
+            else if (!st(c, pc, a, 4, r[i])) return false;
+            a += 4;
+        }
+        if (!(op & 0x800) || !(list & (1u << n))) r[n] = a;               // writeback
+        cyc = 1 + popcount(list);
+        break;
+    }
+    case 0x1A: case 0x1B: {
+        uint32_t cc = (op >> 8) & 0xF;
+        if (cc == 0xE) return fault(c, pc, "undefined (UDF)", pc);
+        if (cc == 0xF) {                                                    // SVC
+            r[0] = (uint32_t)syscall_dispatch(r[12], r[0], r[1], r[2], r[3]);
+            c->svcs++;
+            cyc = SIM_SVC_CYCLES;
+            break;
+        }
+        if (cond(c, cc)) { cyc = 2; branch(c, pc, pcr + sext((op & 0xFF) << 1, 9), &next); }
+        break;
+    }
+    case 0x1C:                                                              // B
+        cyc = 2;
+        branch(c, pc, pcr + sext((op & 0x7FF) << 1, 12), &next);
+        break;
+    case 0x1E: case 0x1F:
+        if (!exec32(c, pc, (uint16_t)op, &next, &cyc)) return false;
+        break;
+    default:
+        return fault(c, pc, "undefined instruction", pc);
+    }
+
+    r[15] = next;
+    c->insns++;
+    c->cycles += cyc;
+    if (c->on_retire) c->on_retire(c->ctx, pc, cyc);
+    return next != SIM_RETURN_ADDR;
+}
+
+int sim_call(sim_cpu_t* c, uint32_t entry, uint32_t sp, uint32_t a0, uint32_t a1, uint32_t a2, uint64_t max_insns) {
+    c->r[0] = a0;
+    c->r[1] = a1;
+    c->r[2] = a2;
+    c->r[13] = sp & ~7u;
+    c->r[14] = SIM_RETURN_ADDR | 1u;
+    c->r[15] = entry & ~1u;
+    c->fault = NULL;
+    const uint64_t stop = c->insns + max_insns;
+    while (sim_step(c)) {
+        if (max_insns && c->insns >= stop) return SIM_BUDGET;
+    }
+    return c->fault ? SIM_FAULTED : SIM_RETURNED;
+}
@@ -0,0 +1,46 @@
+// thumb_sim.h: ARMv6-M (Cortex-M0+) Thumb interpreter for PXE apps
+//
+// Guest memory is whatever syscall_map() (os/syscall.h) maps, so the CPU and
+// the syscall table see the same addresses. svc 0 calls syscall_dispatch()
+// with the number in r12, as isr_svcall_c does on the board.
+//
+// Cycles follow the Cortex-M0+ TRM timings with zero-wait-state memory:
+// 1 per instruction, 2 for loads / stores / taken branches, 1+N for
+// LDM / STM / PUSH / POP (3+N for POP {pc}), 3 for BL and barriers.
+// An SVC is charged exception entry + return (SIM_SVC_CYCLES); the host
+// side of the call is not modelled.
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SIM_RETURN_ADDR 0xFFFFFFF0u   // LR of the entry call; branching here ends the run
+#define SIM_SVC_CYCLES  31u           // 15 entry + 16 return
+
+typedef struct sim_cpu sim_cpu_t;
+
+struct sim_cpu {
+    uint32_t r[16];
+    bool n, z, c, v;
+
+    uint64_t insns;
+    uint64_t cycles;
+    uint32_t svcs;
+
+    const char* fault;     // why the run stopped, NULL if it returned
+    uint32_t fault_pc;
+    uint32_t fault_addr;
+
+    // Called before each instruction (profiling); may be NULL
+    void (*on_insn)(void* ctx, uint32_t pc);
+    // Cycles charged to the instruction just executed
+    void (*on_retire)(void* ctx, uint32_t pc, uint32_t cycles);
+    void* ctx;
+};
+
+enum { SIM_RETURNED = 0, SIM_FAULTED = -1, SIM_BUDGET = 1 };
+
+void sim_reset(sim_cpu_t* cpu);
+// Execute one instruction; false once the run is over (returned or faulted)
+bool sim_step(sim_cpu_t* cpu);
+// Call entry(r0..r2) with sp; runs until it returns, faults or max_insns
+int  sim_call(sim_cpu_t* cpu, uint32_t entry, uint32_t sp, uint32_t a0, uint32_t a1, uint32_t a2, uint64_t max_insns);
@@ -0,0 +1,234 @@
+// sys_shim.c: drive src/os/syscall.c the way a PXE app would, on the host
+//
+// A 64 KB buffer stands in for the app slot at 0x20020000; arguments are
+// guest addresses inside it, exactly as r0-r3 would carry them after an
+// SVC. Each case prints one line and the exit status is the failure count.
+//
+//   sys_shim --bench [--min-us N]   ns per call of a few dispatch paths
+//                                   (CSV: case,iters,ns_per_call)
+#include "os/syscall.h"
+#include "os/app_slot.h"
+#include "vfs/vfs.h"
+#include "fs/ramfs.h"
+#include "host_con.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define GUEST 0x20020000u
+
+static uint8_t g_mem[APP_SLOT_BYTES];
+static int g_fail;
+
+// Guest address of something placed at offset off
+static uint32_t put(uint32_t off, const void* p, size_t n) {
+    memcpy(g_mem + off, p, n);
+    return GUEST + off;
+}
+
+static int32_t sys(uint32_t no, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3) {
+    return syscall_dispatch(no, a0, a1, a2, a3);
+}
+
+static void check(const char* what, bool ok) {
+    printf("%-32s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) g_fail++;
+}
+
+// ---- --bench ----
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t g_path, g_text, g_ops, g_iov;
+static int32_t g_fd;
+
+static void op_write_nul(void) { sys(SYS_write, 1, g_text, 15, 0); }
+static void op_read(void)      { sys(SYS_lseek, (uint32_t)g_fd, 0, VFS_SEEK_SET, 0);
+                                 sys(SYS_read, (uint32_t)g_fd, GUEST + 0x300, 15, 0); }
+static void op_stat(void)      { sys(SYS_stat, g_path, GUEST + 0x400, 0, 0); }
+static void op_time(void)      { sys(SYS_time, GUEST + 0x600, 0, 0, 0); }
+static void op_writev(void)    { sys(SYS_writev, 1, g_iov, 4, 0); }
+static void op_batch(void)     { sys(SYS_batch, g_ops, 16, 0, 0); }
+
+// Same doubling scheme as fs_bench: grow the batch until it lasts min_us
+static void time_op(const char* name, void (*op)(void), uint32_t calls, uint32_t min_us) {
+    uint32_t n = 1;
+    uint64_t ns;
+    while (1) {
+        uint64_t t0 = now_ns();
+        for (uint32_t i=0;i<n;i++) op();
+        ns = now_ns() - t0;
+        if (ns >= (uint64_t)min_us * 1000u || n >= (1u << 24)) break;
+        n *= 2;
+    }
+    printf("%s,%u,%.1f\n", name, n * calls, (double)ns / ((double)n * calls));
+}
+
+static int bench_main(uint32_t min_us) {
+    // Console output goes to /dev/null: write() measures dispatch plus
+    // the console path, not a terminal
+    g_path = put(0x100, "A:\\T.TXT", 9);
+    g_text = put(0x200, "hello, syscalls", 15);
+    int32_t fd = sys(SYS_open, g_path, VFS_O_WRONLY | VFS_O_CREAT | VFS_O_TRUNC, 0, 0);
+    sys(SYS_write, (uint32_t)fd, g_text, 15, 0);
+    sys(SYS_close, (uint32_t)fd, 0, 0, 0);
+    g_fd = sys(SYS_open, g_path, VFS_O_RDONLY, 0, 0);
+
+    sys_iovec_t iov[4];
+    for (int i=0;i<4;i++) iov[i] = (sys_iovec_t){ g_text, 4 };
+    g_iov = put(0x800, iov, sizeof(iov));
+    sys_op_t ops[16];
+    for (int i=0;i<16;i++) ops[i] = (sys_op_t){ SYS_write, { 1, g_text, 4, 0 }, 0 };
+    g_ops = put(0xa00, ops, sizeof(ops));
+
+    printf("case,iters,ns_per_call\n");
+    time_op("write_nul", op_write_nul, 1, min_us);
+    time_op("lseek_read_ramfs", op_read, 2, min_us);
+    time_op("stat", op_stat, 1, min_us);
+    time_op("time", op_time, 1, min_us);
+    time_op("writev_4", op_writev, 1, min_us);
+    time_op("batch_16_per_op", op_batch, 16, min_us);
+    sys(SYS_close, (uint32_t)g_fd, 0, 0, 0);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    vfs_init();
+    ramfs_init();
+    syscall_map(GUEST, sizeof(g_mem), g_mem);
+
+    // Console: input from a pipe we control, output discarded
+    int in[2];
+    if (pipe(in) < 0) return 1;
+    host_con_set_fds(in[0], open("/dev/null", O_WRONLY));
+
+    if (argc > 1 && !strcmp(argv[1], "--bench")) {
+        uint32_t min_us = argc > 3 && !strcmp(argv[2], "--min-us") ? (uint32_t)strtoul(argv[3], NULL, 0) : 20000;
+        return bench_main(min_us);
+    }
+
+    uint32_t path = put(0x100, "A:\\T.TXT", 9);
+    uint32_t text = put(0x200, "hello, syscalls", 15);
+    uint32_t buf = GUEST + 0x300;
+
+    int32_t fd = sys(SYS_open, path, VFS_O_WRONLY | VFS_O_CREAT | VFS_O_TRUNC, 0, 0);
+    check("open for write", fd >= 0);
+    check("write", sys(SYS_write, (uint32_t)fd, text, 15, 0) == 15);
+    check("close", sys(SYS_close, (uint32_t)fd, 0, 0, 0) == 0);
+
+    fd = sys(SYS_open, path, VFS_O_RDONLY, 0, 0);
+    check("read", sys(SYS_read, (uint32_t)fd, buf, 64, 0) == 15 && !memcmp(g_mem + 0x300, "hello, syscalls", 15));
+    check("read at EOF", sys(SYS_read, (uint32_t)fd, buf, 64, 0) == 0);
+    check("lseek SET", sys(SYS_lseek, (uint32_t)fd, 7, VFS_SEEK_SET, 0) == 7);
+    check("read after seek", sys(SYS_read, (uint32_t)fd, buf, 4, 0) == 4 && !memcmp(g_mem + 0x300, "sysc", 4));
+    check("lseek END-4", sys(SYS_lseek, (uint32_t)fd, (uint32_t)-4, VFS_SEEK_END, 0) == 11);
+    check("lseek before start", sys(SYS_lseek, (uint32_t)fd, (uint32_t)-99, VFS_SEEK_CUR, 0) == -1);
+    sys(SYS_close, (uint32_t)fd, 0, 0, 0);
+
+    sys_stat_t* st = (sys_stat_t*)(g_mem + 0x400);
+    check("stat file", sys(SYS_stat, path, GUEST + 0x400, 0, 0) == 0 && st->size == 15 && !st->is_dir);
+    check("stat root", sys(SYS_stat, put(0x120, "A:\\", 4), GUEST + 0x400, 0, 0) == 0 && st->is_dir);
+    check("stat missing", sys(SYS_stat, put(0x140, "NOPE.TXT", 9), GUEST + 0x400, 0, 0) == -1);
+
+    sys_dirent_t* d = (sys_dirent_t*)(g_mem + 0x500);
+    int n = 0, found = 0;
+    while (sys(SYS_readdir, 0, (uint32_t)n, GUEST + 0x500, 0) == 1) {
+        if (!strcmp(d->name, "T.TXT") && d->size == 15) found++;
+        n++;
+    }
+    check("readdir cwd", n == 2 && found == 1);   // README.TXT + T.TXT
+
+    // Pointer checks: outside the map, or running off its end
+    check("bad pointer", sys(SYS_write, 1, 0x1000, 4, 0) == -1);
+    check("buffer past end", sys(SYS_read, 0, GUEST + APP_SLOT_BYTES - 2, 8, 0) == -1);
+    g_mem[APP_SLOT_BYTES - 1] = 'x';
+    check("unterminated path", sys(SYS_open, GUEST + APP_SLOT_BYTES - 1, VFS_O_RDONLY, 0, 0) == -1);
+    check("unknown syscall", sys(SYS_COUNT, 0, 0, 0, 0) == -1 && sys(0, 0, 0, 0, 0) == -1);
+
+    uint64_t t0;
+    int32_t lo = sys(SYS_time, GUEST + 0x601, 0, 0, 0);   // unaligned on purpose
+    memcpy(&t0, g_mem + 0x601, 8);
+    check("time", (uint32_t)lo == (uint32_t)t0 && t0 > 0);
+    sys(SYS_sleep, 20000, 0, 0, 0);
+    uint64_t t1;
+    sys(SYS_time, GUEST + 0x601, 0, 0, 0);
+    memcpy(&t1, g_mem + 0x601, 8);
+    check("sleep 20 ms", t1 - t0 >= 20000);
+    check("yield", sys(SYS_yield, 0, 0, 0, 0) == 0);
+
+    // writev: two pieces in one call; readv back into three
+    sys_iovec_t iov[3] = { { put(0x700, "abc", 3), 3 }, { put(0x710, "defgh", 5), 5 } };
+    uint32_t iv = put(0x800, iov, sizeof(iov));
+    fd = sys(SYS_open, path, VFS_O_WRONLY | VFS_O_TRUNC, 0, 0);
+    check("writev", sys(SYS_writev, (uint32_t)fd, iv, 2, 0) == 8);
+    sys(SYS_close, (uint32_t)fd, 0, 0, 0);
+    iov[0] = (sys_iovec_t){ GUEST + 0x900, 2 };
+    iov[1] = (sys_iovec_t){ GUEST + 0x910, 4 };
+    iov[2] = (sys_iovec_t){ GUEST + 0x920, 8 };
+    iv = put(0x800, iov, sizeof(iov));
+    fd = sys(SYS_open, path, VFS_O_RDONLY, 0, 0);
+    check("readv short", sys(SYS_readv, (uint32_t)fd, iv, 3, 0) == 8 &&
+          !memcmp(g_mem + 0x900, "ab", 2) && !memcmp(g_mem + 0x910, "cdef", 4) && !memcmp(g_mem + 0x920, "gh", 2));
+    sys(SYS_close, (uint32_t)fd, 0, 0, 0);
+
+    // batch: per-op results, a bad op does not stop the others
+    sys_op_t ops[4] = {
+        { SYS_write, { 1, text, 5, 0 } },
+        { SYS_write, { 1, 0x1000, 5, 0 } },
+        { SYS_batch, { 0, 0, 0, 0 } },
+        { SYS_stat,  { path, GUEST + 0x400, 0, 0 } },
+    };
+    uint32_t ob = put(0xa00, ops, sizeof(ops));
+    check("batch", sys(SYS_batch, ob, 4, 0, 0) == 4);
+    memcpy(ops, g_mem + 0xa00, sizeof(ops));
+    check("batch results", ops[0].ret == 5 && ops[1].ret == -1 && ops[2].ret == -1 && ops[3].ret == 0);
+
+    // ring: queued writes run at the next trap of any kind
+    const uint32_t RING = 0x1000, N = 4;
+    sys_ring_t* r = (sys_ring_t*)(g_mem + RING);
+    sys_sqe_t* sq = (sys_sqe_t*)(r + 1);
+    sys_cqe_t* cq = (sys_cqe_t*)(sq + N);
+    check("ring setup rejects 3 entries", sys(SYS_ring_setup, GUEST + RING, 3, 0, 0) == -1);
+    check("ring setup", sys(SYS_ring_setup, GUEST + RING, N, 0, 0) == 0);
+    for (uint32_t i=0;i<3;i++) {
+        sq[r->sq_tail & (N-1)] = (sys_sqe_t){ SYS_write, { 1, text, 2 + i, 0 }, 100 + i };
+        r->sq_tail++;
+    }
+    check("ring idle until a trap", r->cq_tail == 0);
+    sys(SYS_yield, 0, 0, 0, 0);
+    check("ring drained by yield", r->sq_head == 3 && r->cq_tail == 3 &&
+          cq[0].user == 100 && cq[0].res == 2 && cq[2].user == 102 && cq[2].res == 4);
+
+    // CQ has room for one more; the rest waits until the app reaps
+    for (uint32_t i=0;i<3;i++) {
+        sq[r->sq_tail & (N-1)] = (sys_sqe_t){ SYS_write, { 1, text, 1, 0 }, 200 + i };
+        r->sq_tail++;
+    }
+    check("ring enter, CQ full", sys(SYS_ring_enter, GUEST + RING, 0, 0, 0) == 4 && (r->flags & SYS_RING_F_CQ_FULL));
+    r->cq_head = r->cq_tail;
+    check("ring enter after reaping", sys(SYS_ring_enter, GUEST + RING, 0, 0, 0) == 2 && !(r->flags & SYS_RING_F_CQ_FULL) &&
+          cq[r->cq_head & (N-1)].user == 201);
+    // exit would release the ring it is drained from
+    sq[r->sq_tail & (N-1)] = (sys_sqe_t){ SYS_exit, { 0, 0, 0, 0 }, 300 };
+    r->sq_tail++;
+    sys(SYS_yield, 0, 0, 0, 0);
+    check("ring rejects exit", r->sq_head == r->sq_tail && cq[(r->cq_tail - 1) & (N-1)].user == 300 &&
+          cq[(r->cq_tail - 1) & (N-1)].res == -1 && sys(SYS_ring_enter, GUEST + RING, 0, 0, 0) >= 0);
+    sys_ring_release();
+    check("ring released", sys(SYS_ring_enter, GUEST + RING, 0, 0, 0) == -1);
+
+    check("getchar timeout", sys(SYS_getchar, 10000, 0, 0, 0) == -1);
+    (void)!write(in[1], "K", 1);
+    check("getchar", sys(SYS_getchar, 100000, 0, 0, 0) == 'K');
+
+    printf("%d failed\n", g_fail);
+    return g_fail;
+}
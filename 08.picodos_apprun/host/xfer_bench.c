@@ -0,0 +1,257 @@
+// xfer_bench.c: RECV throughput over a pty, without a board
+//
+// The real xfer_recv.c / cobs.c / vfs.c / ramfs.c run on the pty slave, with
+// dos_getc_blocking() reading from it (dos_sys_host.c). A sender thread plays
+// tools/send_pxe.py on the master side and can drop bytes, add per-frame
+// latency or pace itself to a UART baud rate. A failed transfer is resent as
+// a whole (the protocol has no per-frame ACK), which is what "retransmit"
+// counts below.
+//
+//   xfer_bench [--sizes 64,256,1024,16384] [--chunks 64,128,240,480]
+//              [--loss-ppm N] [--latency-us N] [--baud N]
+//              [--reps N] [--retries N] [--min-bps N] [--csv]
+//   xfer_bench --listen        serve RECV on a pty for tools/send_pxe.py
+//
+// overlap / waits / stalls are the xfer_pipe stage counters summed over all
+// attempts: bytes taken off the wire during commits, times the commit stage
+// waited for the wire, and times the RX stage had no free buffer.
+//
+// Exit status is non-zero if a transfer never succeeded or the throughput
+// of any case is below --min-bps, so it can gate protocol changes.
+#include "xfer/xfer_recv.h"
+#include "xfer/xfer_pipe.h"
+#include "xfer/cobs.h"
+#include "vfs/vfs.h"
+#include "fs/ramfs.h"
+#include "host_con.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <pty.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_LIST   16
+#define RAMFS_CAP  1024   // bigger files go to NUL: (RAMFS_FILE_CAP)
+
+typedef struct {
+    int master;
+    const uint8_t* data;
+    uint32_t size;
+    uint16_t chunk;
+    uint32_t loss_ppm;
+    uint32_t latency_us;
+    uint32_t baud;
+    uint32_t frames;        // out: frames written
+    volatile int done;
+} sender_t;
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static uint32_t crc_simple(const uint8_t* p, size_t n) {
+    uint32_t x = 0x12345678u;
+    for (size_t i=0;i<n;i++) x = (x * 33u) ^ p[i];
+    return x;
+}
+
+static void put16(uint8_t* p, uint16_t v){ p[0]=(uint8_t)v; p[1]=(uint8_t)(v>>8); }
+static void put32(uint8_t* p, uint32_t v){ p[0]=(uint8_t)v; p[1]=(uint8_t)(v>>8); p[2]=(uint8_t)(v>>16); p[3]=(uint8_t)(v>>24); }
+
+// One frame onto the "wire": COBS + delimiter, with loss / pacing applied
+static void wire_frame(sender_t* s, const uint8_t* pkt, size_t n, uint64_t t0, uint64_t* sent_bytes) {
+    uint8_t enc[700];
+    size_t m = cobs_encode(pkt, n, enc, sizeof(enc) - 1);
+    enc[m++] = 0;
+
+    uint8_t out[700];
+    size_t k = 0;
+    for (size_t i=0;i<m;i++) {
+        if (s->loss_ppm && (uint32_t)(rand() % 1000000) < s->loss_ppm) continue;
+        out[k++] = enc[i];
+    }
+    if (s->latency_us) usleep(s->latency_us);
+    if (s->baud) {
+        // 10 bit times per byte (8N1)
+        *sent_bytes += m;
+        uint64_t due = t0 + *sent_bytes * 10u * 1000000u / s->baud;
+        uint64_t t = now_us();
+        if (due > t) usleep((useconds_t)(due - t));
+    }
+    for (size_t off = 0; off < k; ) {
+        ssize_t w = write(s->master, out + off, k - off);
+        if (w <= 0) return;
+        off += (size_t)w;
+    }
+    s->frames++;
+}
+
+static void* sender_main(void* arg) {
+    sender_t* s = (sender_t*)arg;
+    uint8_t pkt[16 + 64 + 520];
+    uint64_t t0 = now_us(), sent = 0;
+    const char* name = "A:\\BENCH.BIN";
+    size_t nl = strlen(name);
+
+    pkt[0] = 1; put32(&pkt[1], 0); put16(&pkt[5], (uint16_t)nl);
+    put32(&pkt[7], s->size); put32(&pkt[11], crc_simple(s->data, s->size));
+    memcpy(&pkt[15], name, nl);
+    wire_frame(s, pkt, 15 + nl, t0, &sent);
+
+    uint32_t seq = 1;
+    for (uint32_t off = 0; off < s->size; off += s->chunk) {
+        uint16_t n = (uint16_t)(s->size - off < s->chunk ? s->size - off : s->chunk);
+        pkt[0] = 2; put32(&pkt[1], seq++); put16(&pkt[5], n);
+        memcpy(&pkt[7], s->data + off, n);
+        wire_frame(s, pkt, 7u + n, t0, &sent);
+    }
+    pkt[0] = 3; put32(&pkt[1], seq);
+    wire_frame(s, pkt, 5, t0, &sent);
+
+    s->done = 1;
+    return NULL;
+}
+
+static void drain(int fd, int ms) {
+    uint8_t buf[512];
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    while (poll(&pfd, 1, ms) > 0 && read(fd, buf, sizeof(buf)) > 0) {}
+}
+
+static int parse_list(const char* s, uint32_t* out) {
+    int n = 0;
+    while (*s && n < MAX_LIST) {
+        out[n++] = (uint32_t)strtoul(s, (char**)&s, 0);
+        if (*s == ',') s++;
+    }
+    return n;
+}
+
+static int open_pty(int* master, int* slave) {
+    char name[64];
+    if (openpty(master, slave, name, NULL, NULL) < 0) { perror("openpty"); return -1; }
+    struct termios t;
+    tcgetattr(*slave, &t);
+    cfmakeraw(&t);
+    tcsetattr(*slave, TCSANOW, &t);
+    tcgetattr(*master, &t);
+    cfmakeraw(&t);
+    tcsetattr(*master, TCSANOW, &t);
+    printf("# pty %s\n", name);
+    return 0;
+}
+
+static int listen_main(void) {
+    int master, slave;
+    if (open_pty(&master, &slave) < 0) return 1;
+    // Keep the master open so the slave survives send_pxe.py closing it
+    host_con_set_fds(slave, 1);
+    host_con_set_idle_timeout_ms(-1);
+    printf("# run: tools/send_pxe.py <pty> <file> A:\\RECV.BIN\n");
+    fflush(stdout);
+    while (1) {
+        bool ok = xfer_recv_file("A:\\RECV.BIN");
+        printf("# %s\n", ok ? "received" : "failed");
+        fflush(stdout);
+        if (!ok) { drain(slave, 50); host_con_flush(); }
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t sizes[MAX_LIST] = { 64, 256, 1024, 16384 };
+    uint32_t chunks[MAX_LIST] = { 64, 128, 240, 480 };
+    int nsizes = 4, nchunks = 4;
+    uint32_t loss_ppm = 0, latency_us = 0, baud = 0, reps = 20, retries = 5;
+    double min_bps = 0;
+    bool csv = false;
+
+    for (int i=1;i<argc;i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i+1] : "0";
+        if (!strcmp(a, "--listen")) return listen_main();
+        else if (!strcmp(a, "--csv")) { csv = true; continue; }
+        else if (!strcmp(a, "--sizes")) nsizes = parse_list(v, sizes);
+        else if (!strcmp(a, "--chunks")) nchunks = parse_list(v, chunks);
+        else if (!strcmp(a, "--loss-ppm")) loss_ppm = (uint32_t)atoi(v);
+        else if (!strcmp(a, "--latency-us")) latency_us = (uint32_t)atoi(v);
+        else if (!strcmp(a, "--baud")) baud = (uint32_t)atoi(v);
+        else if (!strcmp(a, "--reps")) reps = (uint32_t)atoi(v);
+        else if (!strcmp(a, "--retries")) retries = (uint32_t)atoi(v);
+        else if (!strcmp(a, "--min-bps")) min_bps = atof(v);
+        else { fprintf(stderr, "unknown option %s\n", a); return 2; }
+        i++;
+    }
+
+    vfs_init();
+    ramfs_init();
+
+    int master, slave;
+    if (open_pty(&master, &slave) < 0) return 1;
+    int devnull = open("/dev/null", O_WRONLY);
+    host_con_set_fds(slave, devnull);
+    host_con_set_idle_timeout_ms(200);
+    srand(1);
+
+    if (csv) printf("size,chunk,reps,ok,attempts,frames,retx_frames,bytes_per_s,frames_per_s,retx_rate,overlap_bytes,commit_waits,rx_stalls\n");
+    else printf("%8s %6s %5s %8s %9s %12s %10s %8s %9s %7s %7s\n", "size", "chunk", "ok", "attempts", "frames", "bytes/s", "frames/s", "retx", "overlap", "waits", "stalls");
+
+    int rc = 0;
+    for (int si=0; si<nsizes; si++) {
+        uint8_t* data = malloc(sizes[si] ? sizes[si] : 1);
+        for (uint32_t k=0;k<sizes[si];k++) data[k] = (uint8_t)rand();
+        const char* path = sizes[si] <= RAMFS_CAP ? "A:\\BENCH.BIN" : "NUL:";
+
+        for (int ci=0; ci<nchunks; ci++) {
+            uint32_t ok = 0, attempts = 0, frames = 0, retx = 0;
+            uint32_t overlap = 0, waits = 0, stalls = 0;
+            uint64_t t0 = now_us();
+
+            for (uint32_t r=0; r<reps; r++) {
+                for (uint32_t a=0; a<=retries; a++) {
+                    sender_t s = { .master = master, .data = data, .size = sizes[si],
+                                   .chunk = (uint16_t)chunks[ci], .loss_ppm = loss_ppm,
+                                   .latency_us = latency_us, .baud = baud };
+                    pthread_t th;
+                    pthread_create(&th, NULL, sender_main, &s);
+                    bool good = xfer_recv_file(path);
+                    // Swallow whatever the sender still has in flight
+                    while (!s.done) drain(slave, 5);
+                    pthread_join(th, NULL);
+                    drain(slave, good ? 0 : 20);
+                    host_con_flush();
+
+                    const xfer_pipe_stats_t* ps = xfer_pipe_stats();
+                    overlap += ps->overlap_bytes;
+                    waits += ps->commit_waits;
+                    stalls += ps->rx_stalls;
+                    attempts++;
+                    frames += s.frames;
+                    if (good) { ok++; break; }
+                    retx += s.frames;
+                }
+            }
+
+            double dt = (double)(now_us() - t0) / 1e6;
+            double bps = (double)sizes[si] * ok / dt;
+            double fps = frames / dt;
+            double rate = frames ? (double)retx / frames : 0.0;
+            if (csv) printf("%u,%u,%u,%u,%u,%u,%u,%.0f,%.0f,%.4f,%u,%u,%u\n", sizes[si], chunks[ci], reps, ok, attempts, frames, retx, bps, fps, rate, overlap, waits, stalls);
+            else printf("%8u %6u %2u/%-2u %8u %9u %12.0f %10.0f %7.2f%% %9u %7u %7u\n", sizes[si], chunks[ci], ok, reps, attempts, frames, bps, fps, rate * 100, overlap, waits, stalls);
+            fflush(stdout);
+
+            if (ok < reps) rc = 1;
+            if (min_bps > 0 && bps < min_bps) rc = 1;
+        }
+        free(data);
+    }
+    return rc;
+}
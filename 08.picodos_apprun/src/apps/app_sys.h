@@ -2,13 +2,51 @@
 #pragma once
 #include <stdint.h>
 
+// Keep in sync with src/os/syscall.h
 enum {
-  SYS_exit  = 1,
-  SYS_write = 2,
-  SYS_open  = 3,
-  SYS_close = 4,
+  SYS_exit    = 1,
+  SYS_write   = 2,
+  SYS_open    = 3,
+  SYS_close   = 4,
+  SYS_read    = 5,
+  SYS_lseek   = 6,
+  SYS_stat    = 7,
+  SYS_readdir = 8,
+  SYS_getchar = 9,
+  SYS_time    = 10,
+  SYS_sleep   = 11,
+  SYS_yield   = 12,
+  SYS_writev  = 13,
+  SYS_readv   = 14,
+  SYS_batch   = 15,
+  SYS_ring_setup = 16,
+  SYS_ring_enter = 17,
 };
 
+#define SYS_IOV_MAX    64
+#define SYS_BATCH_MAX  64
+
+typedef struct {
+    const void* base;
+    uint32_t    len;
+} sys_iovec_t;
+
+typedef struct {
+    uint32_t no;
+    uint32_t a[4];
+    int32_t  ret;    // filled in by SYS_batch
+} sys_op_t;
+
+typedef struct {
+    uint32_t size;
+    uint32_t is_dir;
+} sys_stat_t;
+
+typedef struct {
+    char     name[16];
+    uint32_t size;
+    uint32_t is_dir;
+} sys_dirent_t;
 
 static inline int sys_call(int no, int a0, int a1, int a2, int a3) {
     register int r0  __asm("r0")  = a0;
@@ -30,16 +68,120 @@ static inline void sys_exit(int code) {
     sys_call(SYS_exit, code, 0, 0, 0);
 }
 
-// Minimal set of vfs flags exposed to apps
-#define O_RDONLY  0
-#define O_WRONLY  1
+// Minimal set of vfs flags exposed to apps (same values as vfs.h)
+#define O_RDONLY  1
+#define O_WRONLY  2
+#define O_RDWR    3
 #define O_CREAT   (1<<8)
 #define O_TRUNC   (1<<9)
 #define O_APPEND  (1<<10)
 
+#define SEEK_SET  0
+#define SEEK_CUR  1
+#define SEEK_END  2
+
 static inline int sys_open(const char* path, int flags) {
     return sys_call(SYS_open, (int)path, flags, 0, 0);
 }
 static inline int sys_close(int fd) {
     return sys_call(SYS_close, fd, 0, 0, 0);
 }
+static inline int sys_read(int fd, void* buf, int len) {
+    return sys_call(SYS_read, fd, (int)buf, len, 0);
+}
+static inline int sys_lseek(int fd, int off, int whence) {
+    return sys_call(SYS_lseek, fd, off, whence, 0);
+}
+static inline int sys_stat(const char* path, sys_stat_t* st) {
+    return sys_call(SYS_stat, (int)path, (int)st, 0, 0);
+}
+// 1 = entry filled, 0 = end of directory; path 0 = current directory
+static inline int sys_readdir(const char* path, int idx, sys_dirent_t* d) {
+    return sys_call(SYS_readdir, (int)path, idx, (int)d, 0);
+}
+// timeout_us < 0 waits forever; -1 on timeout
+static inline int sys_getchar(int timeout_us) {
+    return sys_call(SYS_getchar, timeout_us, 0, 0, 0);
+}
+static inline uint32_t sys_time_us(void) {
+    return (uint32_t)sys_call(SYS_time, 0, 0, 0, 0);
+}
+static inline uint64_t sys_time_us64(void) {
+    uint64_t t;
+    sys_call(SYS_time, (int)&t, 0, 0, 0);
+    return t;
+}
+static inline void sys_sleep_us(uint32_t us) {
+    sys_call(SYS_sleep, (int)us, 0, 0, 0);
+}
+static inline void sys_yield(void) {
+    sys_call(SYS_yield, 0, 0, 0, 0);
+}
+
+// One trap for several buffers / several calls
+static inline int sys_writev(int fd, const sys_iovec_t* iov, int count) {
+    return sys_call(SYS_writev, fd, (int)iov, count, 0);
+}
+static inline int sys_readv(int fd, sys_iovec_t* iov, int count) {
+    return sys_call(SYS_readv, fd, (int)iov, count, 0);
+}
+static inline int sys_batch(sys_op_t* ops, int count) {
+    return sys_call(SYS_batch, (int)ops, count, 0, 0);
+}
+
+// ---- Submission / completion ring ----
+// Declare storage with SYS_RING_DECL, call sys_ring_setup once, then queue
+// work with sys_ring_sqe + sys_ring_submit. Queued entries run at the next
+// syscall of any kind (or sys_ring_enter); results show up as CQEs.
+#define SYS_RING_F_CQ_FULL 1u
+
+typedef struct {
+    uint32_t no;
+    uint32_t a[4];
+    uint32_t user;
+} sys_sqe_t;
+
+typedef struct {
+    uint32_t user;
+    int32_t  res;
+} sys_cqe_t;
+
+typedef struct {
+    uint32_t entries;
+    volatile uint32_t sq_head;
+    volatile uint32_t sq_tail;
+    volatile uint32_t cq_head;
+    volatile uint32_t cq_tail;
+    volatile uint32_t flags;
+} sys_ring_t;
+
+// n must be a power of two (<= 64)
+#define SYS_RING_DECL(name, n) \
+    static struct { sys_ring_t r; sys_sqe_t sq[n]; sys_cqe_t cq[n]; } name
+
+static inline int sys_ring_setup(sys_ring_t* r, int entries) {
+    return sys_call(SYS_ring_setup, (int)r, entries, 0, 0);
+}
+// Runs anything queued; returns the number of CQEs waiting
+static inline int sys_ring_enter(sys_ring_t* r) {
+    return sys_call(SYS_ring_enter, (int)r, 0, 0, 0);
+}
+// Next free SQE, or 0 if the SQ is full
+static inline sys_sqe_t* sys_ring_sqe(sys_ring_t* r) {
+    if (r->sq_tail - r->sq_head >= r->entries) return 0;
+    return &((sys_sqe_t*)(r + 1))[r->sq_tail & (r->entries - 1)];
+}
+static inline void sys_ring_submit(sys_ring_t* r) {
+    __sync_synchronize();
+    r->sq_tail++;
+}
+// Oldest unread CQE, or 0; call sys_ring_cqe_seen when done with it
+static inline sys_cqe_t* sys_ring_cqe(sys_ring_t* r) {
+    if (r->cq_head == r->cq_tail) return 0;
+    __sync_synchronize();
+    sys_cqe_t* cq = (sys_cqe_t*)((sys_sqe_t*)(r + 1) + r->entries);
+    return &cq[r->cq_head & (r->entries - 1)];
+}
+static inline void sys_ring_cqe_seen(sys_ring_t* r) {
+    r->cq_head++;
+}
@@ -0,0 +1,14 @@
+// app_args.c: runtime demo - argv, printf, file I/O through pxe_rt
+#include "rt/rt.h"
+
+int main(int argc, char** argv) {
+    printf("%s: %d arg(s)\n", argv[0], argc - 1);
+    for (int i=1;i<argc;i++) printf("  [%d] %-12s (%u bytes)\n", i, argv[i], (unsigned)strlen(argv[i]));
+
+    if (argc > 1) {
+        sys_stat_t st;
+        if (sys_stat(argv[1], &st) == 0) printf("%s: %s, %u bytes\n", argv[1], st.is_dir ? "dir" : "file", (unsigned)st.size);
+        else fprintf(stderr, "%s: not found\n", argv[1]);
+    }
+    return 0;
+}
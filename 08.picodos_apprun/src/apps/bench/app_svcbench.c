@@ -0,0 +1,106 @@
+// app_svcbench.c: SVC trap cost, one call per trap vs writev / batch
+//
+//   RUN SVCBENCH
+//
+// Counts core clock cycles with SysTick (24-bit, counting down) around
+// N_OPS one-byte writes to NUL: as N_OPS traps, as one writev, as one
+// batch and through the SQ/CQ ring (one trap to flush). SYS_yield does no
+// work, so its per-call figure is the bare trap.
+#include "app_sys.h"
+
+#define N_OPS 32
+
+#define SYST_CSR (*(volatile uint32_t*)0xE000E010u)
+#define SYST_RVR (*(volatile uint32_t*)0xE000E014u)
+#define SYST_CVR (*(volatile uint32_t*)0xE000E018u)
+
+static uint32_t ticks(void) { return SYST_CVR; }
+static uint32_t elapsed(uint32_t t0, uint32_t t1) { return (t0 - t1) & 0xFFFFFFu; }
+
+static void put_str(const char* s) {
+    int n = 0;
+    while (s[n]) n++;
+    sys_write(1, s, n);
+}
+
+static void put_u(uint32_t v) {
+    char b[11];
+    int i = sizeof(b);
+    do { b[--i] = (char)('0' + v % 10); v /= 10; } while (v);
+    sys_write(1, &b[i], (int)sizeof(b) - i);
+}
+
+static void report(const char* name, uint32_t cyc, uint32_t traps) {
+    put_str(name);
+    put_str(": ");
+    put_u(cyc);
+    put_str(" cycles, ");
+    put_u(cyc / N_OPS);
+    put_str("/op, ");
+    put_u(traps);
+    put_str(" trap(s)\n");
+}
+
+__attribute__((section(".text.app_entry")))
+int app_entry(int argc, char** argv) {
+    (void)argc; (void)argv;
+    static const char one = 'x';
+    static sys_iovec_t iov[N_OPS];
+    static sys_op_t ops[N_OPS];
+    SYS_RING_DECL(ring, N_OPS);
+
+    SYST_RVR = 0xFFFFFFu;
+    SYST_CVR = 0;
+    SYST_CSR = 5;   // enable, core clock, no interrupt
+
+    int nul = sys_open("NUL", O_WRONLY);
+    if (nul < 0) { put_str("cannot open NUL\n"); return 1; }
+
+    for (int i=0;i<N_OPS;i++) {
+        iov[i].base = &one;
+        iov[i].len = 1;
+        ops[i].no = SYS_write;
+        ops[i].a[0] = (uint32_t)nul;
+        ops[i].a[1] = (uint32_t)&one;
+        ops[i].a[2] = 1;
+        ops[i].a[3] = 0;
+    }
+
+    uint32_t t0 = ticks();
+    for (int i=0;i<N_OPS;i++) sys_yield();
+    uint32_t t1 = ticks();
+    report("yield  x32", elapsed(t0, t1), N_OPS);
+
+    t0 = ticks();
+    for (int i=0;i<N_OPS;i++) sys_write(nul, &one, 1);
+    t1 = ticks();
+    report("write  x32", elapsed(t0, t1), N_OPS);
+
+    t0 = ticks();
+    sys_writev(nul, iov, N_OPS);
+    t1 = ticks();
+    report("writev x32", elapsed(t0, t1), 1);
+
+    t0 = ticks();
+    sys_batch(ops, N_OPS);
+    t1 = ticks();
+    report("batch  x32", elapsed(t0, t1), 1);
+
+    sys_ring_setup(&ring.r, N_OPS);
+    t0 = ticks();
+    for (int i=0;i<N_OPS;i++) {
+        sys_sqe_t* e = sys_ring_sqe(&ring.r);
+        e->no = SYS_write;
+        e->a[0] = (uint32_t)nul;
+        e->a[1] = (uint32_t)&one;
+        e->a[2] = 1;
+        e->user = (uint32_t)i;
+        sys_ring_submit(&ring.r);
+    }
+    sys_ring_enter(&ring.r);
+    t1 = ticks();
+    report("ring   x32", elapsed(t0, t1), 1);
+
+    sys_close(nul);
+    return 0;
+}
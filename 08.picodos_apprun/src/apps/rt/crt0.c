@@ -0,0 +1,37 @@
+// crt0.c: PXE entry point -> main, with exit() unwinding back here
+//
+// The loader has already set up .data and cleared .bss, so all that is
+// left is a way out of main from any depth and a final flush.
+#include "rt/rt.h"
+#ifdef RT_SHARED
+#include "rt/rt_api.h"
+
+#define RT_XSTR(x) #x
+#define RT_STR(x)  RT_XSTR(x)
+
+const rt_api_t* rt_api;
+
+// Picked up by mkpxe_from_elf.py and stored in the PXE flags (PXE_API_MAJOR)
+__asm__(".global __pxe_api_major\n.set __pxe_api_major, " RT_STR(RT_API_MAJOR));
+#endif
+
+static void* g_exit_jmp[5];
+static int g_exit_code;
+
+__attribute__((section(".text.app_entry")))
+int app_entry(int argc, char** argv, const void* api) {
+#ifdef RT_SHARED
+    rt_api = (const rt_api_t*)api;
+#else
+    (void)api;
+#endif
+    if (__builtin_setjmp(g_exit_jmp) == 0) g_exit_code = main(argc, argv);
+    fflush(stdout);
+    fflush(stderr);
+    return g_exit_code;
+}
+
+void exit(int code) {
+    g_exit_code = code;
+    __builtin_longjmp(g_exit_jmp, 1);
+}
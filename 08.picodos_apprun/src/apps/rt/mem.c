@@ -0,0 +1,104 @@
+// mem.c: memory and string primitives for Cortex-M0+
+//
+// The M0+ has no unaligned word access and no LDRD/STRD, so the fast paths
+// only kick in when both pointers share word alignment; the 16-byte loops
+// let the compiler use LDM/STM. Built with -fno-builtin and
+// -fno-tree-loop-distribute-patterns so these loops are not turned back
+// into calls to themselves.
+#include "rt/rt.h"
+
+#ifdef RT_SHARED
+#include "rt/rt_api.h"
+
+// pxe_rt_shared: the OS has these already (rt_api.h)
+void*  memcpy(void* d, const void* s, size_t n)  { return rt_api->memcpy(d, s, n); }
+void*  memmove(void* d, const void* s, size_t n) { return rt_api->memmove(d, s, n); }
+void*  memset(void* d, int c, size_t n)          { return rt_api->memset(d, c, n); }
+int    memcmp(const void* a, const void* b, size_t n) { return rt_api->memcmp(a, b, n); }
+size_t strlen(const char* s)                     { return rt_api->strlen(s); }
+int    strcmp(const char* a, const char* b)      { return rt_api->strcmp(a, b); }
+int    strncmp(const char* a, const char* b, size_t n) { return rt_api->strncmp(a, b, n); }
+char*  strcpy(char* d, const char* s)            { return rt_api->strcpy(d, s); }
+
+#else
+
+void* memcpy(void* dst, const void* src, size_t n) {
+    uint8_t* d = (uint8_t*)dst;
+    const uint8_t* s = (const uint8_t*)src;
+    if ((((uintptr_t)d ^ (uintptr_t)s) & 3u) == 0) {
+        while (n && ((uintptr_t)d & 3u)) { *d++ = *s++; n--; }
+        uint32_t* dw = (uint32_t*)d;
+        const uint32_t* sw = (const uint32_t*)s;
+        while (n >= 16) {
+            uint32_t a = sw[0], b = sw[1], c = sw[2], e = sw[3];
+            dw[0] = a; dw[1] = b; dw[2] = c; dw[3] = e;
+            dw += 4; sw += 4; n -= 16;
+        }
+        while (n >= 4) { *dw++ = *sw++; n -= 4; }
+        d = (uint8_t*)dw;
+        s = (const uint8_t*)sw;
+    }
+    while (n--) *d++ = *s++;
+    return dst;
+}
+
+void* memmove(void* dst, const void* src, size_t n) {
+    uint8_t* d = (uint8_t*)dst;
+    const uint8_t* s = (const uint8_t*)src;
+    if (d <= s || d >= s + n) return memcpy(dst, src, n);
+    while (n--) d[n] = s[n];   // overlapping, copy backwards
+    return dst;
+}
+
+void* memset(void* dst, int c, size_t n) {
+    uint8_t* d = (uint8_t*)dst;
+    const uint8_t b = (uint8_t)c;
+    while (n && ((uintptr_t)d & 3u)) { *d++ = b; n--; }
+    uint32_t w = b * 0x01010101u;
+    uint32_t* dw = (uint32_t*)d;
+    while (n >= 16) { dw[0] = w; dw[1] = w; dw[2] = w; dw[3] = w; dw += 4; n -= 16; }
+    while (n >= 4) { *dw++ = w; n -= 4; }
+    d = (uint8_t*)dw;
+    while (n--) *d++ = b;
+    return dst;
+}
+
+int memcmp(const void* a, const void* b, size_t n) {
+    const uint8_t* p = (const uint8_t*)a;
+    const uint8_t* q = (const uint8_t*)b;
+    for (size_t i=0;i<n;i++) {
+        if (p[i] != q[i]) return p[i] - q[i];
+    }
+    return 0;
+}
+
+size_t strlen(const char* s) {
+    const char* p = s;
+    while ((uintptr_t)p & 3u) { if (!*p) return (size_t)(p - s); p++; }
+    // A word has a zero byte iff (w - 0x01..) & ~w & 0x80.. is non-zero
+    const uint32_t* w = (const uint32_t*)p;
+    while (!((*w - 0x01010101u) & ~*w & 0x80808080u)) w++;
+    p = (const char*)w;
+    while (*p) p++;
+    return (size_t)(p - s);
+}
+
+int strcmp(const char* a, const char* b) {
+    while (*a && *a == *b) { a++; b++; }
+    return (unsigned char)*a - (unsigned char)*b;
+}
+
+int strncmp(const char* a, const char* b, size_t n) {
+    for (; n; n--, a++, b++) {
+        if (*a != *b || !*a) return (unsigned char)*a - (unsigned char)*b;
+    }
+    return 0;
+}
+
+char* strcpy(char* dst, const char* src) {
+    char* d = dst;
+    while ((*d++ = *src++)) {}
+    return dst;
+}
+
+#endif
@@ -0,0 +1,159 @@
+// printf.c: compact formatter shared by printf / fprintf / snprintf
+#include "rt/rt.h"
+
+#ifdef RT_SHARED
+#include "rt/rt_api.h"
+
+int vsnprintf(char* buf, size_t n, const char* fmt, va_list ap) {
+    return rt_api->vsnprintf(buf, n, fmt, ap);
+}
+
+int vfprintf(FILE* f, const char* fmt, va_list ap) {
+    char line[RT_FMT_MAX];
+    int n = rt_api->vsnprintf(line, sizeof(line), fmt, ap);
+    return fputs(line, f) == EOF ? EOF : n;
+}
+
+#else
+
+typedef void (*emit_fn)(void* ctx, char c);
+
+typedef struct {
+    char*  p;
+    size_t left;   // room, keeping one byte for the terminator
+    int    n;
+} sbuf_t;
+
+static void emit_file(void* ctx, char c) { fputc(c, (FILE*)ctx); }
+
+static void emit_buf(void* ctx, char c) {
+    sbuf_t* b = (sbuf_t*)ctx;
+    if (b->left) { *b->p++ = c; b->left--; }
+}
+
+static int pad(emit_fn out, void* ctx, char c, int n) {
+    for (int i=0;i<n;i++) out(ctx, c);
+    return n > 0 ? n : 0;
+}
+
+static int format(emit_fn out, void* ctx, const char* f, va_list ap) {
+    int total = 0;
+    for (; *f; f++) {
+        if (*f != '%') { out(ctx, *f); total++; continue; }
+        f++;
+
+        bool left = false, zero = false;
+        for (;; f++) {
+            if (*f == '-') left = true;
+            else if (*f == '0') zero = true;
+            else break;
+        }
+        int width = 0, prec = -1;
+        if (*f == '*') { width = va_arg(ap, int); f++; }
+        else while (*f >= '0' && *f <= '9') width = width * 10 + (*f++ - '0');
+        if (*f == '.') {
+            f++;
+            prec = 0;
+            if (*f == '*') { prec = va_arg(ap, int); f++; }
+            else while (*f >= '0' && *f <= '9') prec = prec * 10 + (*f++ - '0');
+        }
+        while (*f == 'l' || *f == 'z' || *f == 'h') f++;   // int == long == size_t here
+
+        char tmp[12];
+        const char* s = tmp;
+        int len = 0;
+        char sign = 0;
+        unsigned base = 10;
+        bool upper = false;
+
+        switch (*f) {
+        case 'd': case 'i': {
+            int v = va_arg(ap, int);
+            uint32_t u = v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+            if (v < 0) sign = '-';
+            char* e = tmp + sizeof(tmp);
+            do { *--e = (char)('0' + u % 10); u /= 10; } while (u);
+            s = e; len = (int)(tmp + sizeof(tmp) - e);
+            break;
+        }
+        case 'X': upper = true; /* fallthrough */
+        case 'x': base = 16; goto unsigned_num;
+        case 'o': base = 8; goto unsigned_num;
+        case 'p': base = 16; zero = true; width = 8; goto unsigned_num;
+        case 'u':
+        unsigned_num: {
+            uint32_t u = va_arg(ap, uint32_t);
+            const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+            char* e = tmp + sizeof(tmp);
+            do { *--e = digits[u % base]; u /= base; } while (u);
+            s = e; len = (int)(tmp + sizeof(tmp) - e);
+            break;
+        }
+        case 'c':
+            tmp[0] = (char)va_arg(ap, int);
+            len = 1;
+            break;
+        case 's':
+            s = va_arg(ap, const char*);
+            if (!s) s = "(null)";
+            while (s[len] && (prec < 0 || len < prec)) len++;
+            zero = false;
+            break;
+        case '%':
+            tmp[0] = '%';
+            len = 1;
+            break;
+        default:   // unknown: print it as is
+            if (!*f) return total;
+            tmp[0] = *f;
+            len = 1;
+            break;
+        }
+
+        int fill = width - len - (sign ? 1 : 0);
+        if (!left && !zero) total += pad(out, ctx, ' ', fill);
+        if (sign) { out(ctx, sign); total++; }
+        if (!left && zero) total += pad(out, ctx, '0', fill);
+        for (int i=0;i<len;i++) out(ctx, s[i]);
+        total += len;
+        if (left) total += pad(out, ctx, ' ', fill);
+    }
+    return total;
+}
+
+int vfprintf(FILE* f, const char* fmt, va_list ap) {
+    return format(emit_file, f, fmt, ap);
+}
+
+int vsnprintf(char* buf, size_t n, const char* fmt, va_list ap) {
+    sbuf_t b = { buf, n ? n - 1 : 0, 0 };
+    int total = format(emit_buf, &b, fmt, ap);
+    if (n) *b.p = '\0';
+    return total;
+}
+
+#endif
+
+int printf(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vfprintf(stdout, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+int fprintf(FILE* f, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vfprintf(f, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+int snprintf(char* buf, size_t n, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int r = vsnprintf(buf, n, fmt, ap);
+    va_end(ap);
+    return r;
+}
@@ -0,0 +1,57 @@
+// rt.h: runtime for PXE apps (link pxe_rt; the app provides main)
+//
+// stdout/stderr are buffered and flushed on '\n', when full, and at exit.
+// printf understands %d %i %u %x %X %o %c %s %p %% with '-', '0', width,
+// precision (strings) and the 'l' / 'z' length modifiers; no floating point.
+//
+// Two builds of the same API: pxe_rt carries everything in the app, while
+// pxe_rt_shared forwards printf formatting and the mem/str routines to the
+// OS table (rt/rt_api.h) and only keeps crt0 and the stream buffers. With
+// pxe_rt_shared, formatting is the OS's vsnprintf and one printf call
+// prints at most RT_FMT_MAX-1 characters.
+#pragma once
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "app_sys.h"
+
+#define RT_BUF_SIZE 128
+#define RT_FMT_MAX  256   // pxe_rt_shared: longest single printf output
+#define EOF (-1)
+
+typedef struct rt_file {
+    int      fd;
+    uint16_t len;
+    char     buf[RT_BUF_SIZE];
+} FILE;
+
+extern FILE rt_stdout, rt_stderr;
+#define stdout (&rt_stdout)
+#define stderr (&rt_stderr)
+
+int  main(int argc, char** argv);
+void exit(int code) __attribute__((noreturn));
+
+// ---- stdio ----
+int fputc(int c, FILE* f);
+int fputs(const char* s, FILE* f);
+int fflush(FILE* f);
+int putchar(int c);
+int puts(const char* s);
+
+int printf(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+int fprintf(FILE* f, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+int snprintf(char* buf, size_t n, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+int vfprintf(FILE* f, const char* fmt, va_list ap);
+int vsnprintf(char* buf, size_t n, const char* fmt, va_list ap);
+
+// ---- memory / strings (word-at-a-time where alignment allows) ----
+void*  memcpy(void* dst, const void* src, size_t n);
+void*  memmove(void* dst, const void* src, size_t n);
+void*  memset(void* dst, int c, size_t n);
+int    memcmp(const void* a, const void* b, size_t n);
+size_t strlen(const char* s);
+int    strcmp(const char* a, const char* b);
+int    strncmp(const char* a, const char* b, size_t n);
+char*  strcpy(char* dst, const char* src);
@@ -0,0 +1,47 @@
+// rt_api.h (App-side): the OS runtime table, for apps linked with pxe_rt_shared
+//
+// pxe_rt_shared's memcpy / strlen / printf ... are one-line jumps through
+// this table, so the code lives once in OS flash instead of in every PXE.
+// The app's PXE header records RT_API_MAJOR and the loader refuses to start
+// it on an OS with a different major version.
+// Keep in sync with src/os/rt_api.h
+#pragma once
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "app_sys.h"
+
+#define RT_API_MAGIC 0x42415452u   // 'RTAB'
+#define RT_API_MAJOR 1
+#define RT_API_MINOR 0
+
+typedef struct {
+    uint32_t magic;
+    uint16_t major;
+    uint16_t minor;
+    uint32_t count;
+
+    int    (*vsnprintf)(char* buf, size_t n, const char* fmt, va_list ap);
+    void*  (*memcpy)(void* dst, const void* src, size_t n);
+    void*  (*memmove)(void* dst, const void* src, size_t n);
+    void*  (*memset)(void* dst, int c, size_t n);
+    int    (*memcmp)(const void* a, const void* b, size_t n);
+    size_t (*strlen)(const char* s);
+    int    (*strcmp)(const char* a, const char* b);
+    int    (*strncmp)(const char* a, const char* b, size_t n);
+    char*  (*strcpy)(char* dst, const char* src);
+    char*  (*strchr)(const char* s, int c);
+    uint32_t (*crc)(uint32_t x, const void* p, size_t n);
+    int    (*open)(const char* path, int flags);
+    int    (*close)(int fd);
+    int    (*read)(int fd, void* buf, int len);
+    int    (*write)(int fd, const void* buf, int len);
+    int    (*lseek)(int fd, int off, int whence);
+    int    (*stat)(const char* path, sys_stat_t* st);
+    int    (*readdir)(const char* path, int idx, sys_dirent_t* de);
+} rt_api_t;
+
+#define RT_CRC_INIT 0x12345678u
+
+// Set by crt0 before main runs
+extern const rt_api_t* rt_api;
@@ -0,0 +1,36 @@
+// stdio.c: line-buffered output over SYS_write
+#include "rt/rt.h"
+
+FILE rt_stdout = { .fd = 1 };
+FILE rt_stderr = { .fd = 2 };
+
+int fflush(FILE* f) {
+    int rc = 0;
+    if (f->len && sys_write(f->fd, f->buf, f->len) != f->len) rc = EOF;
+    f->len = 0;
+    return rc;
+}
+
+int fputc(int c, FILE* f) {
+    f->buf[f->len++] = (char)c;
+    if (c == '\n' || f->len == RT_BUF_SIZE) {
+        if (fflush(f)) return EOF;
+    }
+    return (unsigned char)c;
+}
+
+int fputs(const char* s, FILE* f) {
+    while (*s) {
+        if (fputc(*s++, f) == EOF) return EOF;
+    }
+    return 0;
+}
+
+int putchar(int c) {
+    return fputc(c, stdout);
+}
+
+int puts(const char* s) {
+    if (fputs(s, stdout) == EOF) return EOF;
+    return fputc('\n', stdout);
+}
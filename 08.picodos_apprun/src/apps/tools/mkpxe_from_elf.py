@@ -1,51 +1,141 @@
 #!/usr/bin/env python3
 import pathlib, re, struct, subprocess, sys
 
+import pxe_lz
+
 PXE_MAGIC = 0x30584550  # 'PXE0'
 PXE_VER   = 1
-BASE      = 0x20020000  # match app.ld
+PXE_VER2  = 2           # relocatable: u16 reloc table between header and image
+BASE      = 0x20020000  # match app.ld (used if the ELF has no __image_base)
 SYMBOL    = "app_entry"
 
-def write_pxe(bin_path: pathlib.Path, out_pxe: pathlib.Path, entry_off: int, bss_size: int = 0):
+PXE_F_XIP  = 0x0001  # linked with app_xip.ld
+PXE_F_DATA = 0x0002  # data_off / data_size valid
+PXE_F_LZ   = 0x0004  # image stored as one LZ4 block (pxe_lz.py)
+PXE_F_API_SHIFT = 8  # bits 8-15: OS runtime table major version (rt/rt_api.h)
+API_SYMBOL = "__pxe_api_major"  # absolute symbol set by pxe_rt_shared's crt0
+
+# Absolute 32-bit relocations; everything else on Cortex-M0+ is PC-relative
+ABS_RELOCS = ("R_ARM_ABS32", "R_ARM_TARGET1")
+IMAGE_SECTIONS = (".rel.text", ".rel.rodata", ".rel.data")
+
+def write_pxe(bin_path: pathlib.Path, out_pxe: pathlib.Path, entry_off: int, bss_size: int = 0,
+              flags: int = 0, data_off: int = 0, data_size: int = 0, relocs=None):
     data = bin_path.read_bytes()
-    hdr = struct.pack("<IHHIII3I",
-                      PXE_MAGIC, PXE_VER, 0,
+    ver = PXE_VER if relocs is None else PXE_VER2
+    relocs = relocs or []
+    hdr = struct.pack("<IHHIIIIII",
+                      PXE_MAGIC, ver, flags,
                       len(data), bss_size, entry_off,
-                      0, 0, 0)
-    out_pxe.write_bytes(hdr + data)
+                      data_off, data_size, len(relocs))
+    table = struct.pack(f"<{len(relocs)}H", *relocs)
+    table += b"\0" * (-len(table) % 4)
+    # image_size stays the unpacked size; the loader decodes until it is reached
+    payload = pxe_lz.compress(data) if flags & PXE_F_LZ else data
+    out_pxe.write_bytes(hdr + table + payload)
+    return len(payload)
+
+def read_relocs(readelf: str, elf: pathlib.Path, image: bytes, base: int, span: int) -> list:
+    """Image offsets of words holding absolute addresses inside the app (needs -Wl,-q)."""
+    out = subprocess.check_output([readelf, "-rW", str(elf)], text=True, errors="ignore")
+    offs, section = set(), ""
+    for line in out.splitlines():
+        m = re.match(r"^Relocation section '([^']+)'", line)
+        if m:
+            section = m.group(1)
+            continue
+        f = line.split()
+        if len(f) < 3 or not section.startswith(IMAGE_SECTIONS):
+            continue
+        try:
+            addr = int(f[0], 16)
+        except ValueError:
+            continue
+        if f[2].startswith("R_ARM_ABS") and f[2] not in ABS_RELOCS:
+            raise SystemExit(f"unsupported relocation {f[2]} at 0x{addr:x}")
+        if f[2] not in ABS_RELOCS:
+            continue
+        off = addr - base
+        if off < 0 or off + 4 > len(image):
+            continue
+        # Only words that point into the app itself move with it
+        value = struct.unpack_from("<I", image, off)[0]
+        if base <= value < base + span:
+            offs.add(off)
+    offs = sorted(offs)
+    if offs and offs[-1] > 0xFFFF:
+        raise SystemExit("image too large for a u16 relocation table")
+    return offs
+
+def read_symbols(nm: str, elf: pathlib.Path) -> dict:
+    nm_out = subprocess.check_output([nm, "-n", str(elf)], text=True, errors="ignore")
+    syms = {}
+    for line in nm_out.splitlines():
+        m = re.match(r"^([0-9a-fA-F]+)\s+\w\s+(\S+)$", line.strip())
+        if m:
+            syms[m.group(2)] = int(m.group(1), 16)
+    return syms
 
 def main():
-    if len(sys.argv) != 4:
-        print("Usage: mkpxe_from_elf.py <app.elf> <out.pxe> <objcopy_prefix>", file=sys.stderr)
+    args = [a for a in sys.argv[1:] if a != "--lz"]
+    lz = len(args) != len(sys.argv) - 1
+    if len(args) != 3:
+        print("Usage: mkpxe_from_elf.py [--lz] <app.elf> <out.pxe> <objcopy_prefix>", file=sys.stderr)
         print("  objcopy_prefix example: arm-none-eabi", file=sys.stderr)
+        print("  --lz: compress the image (PXE_F_LZ, not for XIP images)", file=sys.stderr)
         sys.exit(1)
 
-    elf = pathlib.Path(sys.argv[1])
-    out_pxe = pathlib.Path(sys.argv[2])
-    prefix = sys.argv[3]
+    elf = pathlib.Path(args[0])
+    out_pxe = pathlib.Path(args[1])
+    prefix = args[2]
     objcopy = f"{prefix}-objcopy"
     nm      = f"{prefix}-nm"
+    readelf = f"{prefix}-readelf"
 
     bin_path = elf.with_suffix(".bin")
 
     # ELF -> BIN
     subprocess.check_call([objcopy, "-O", "binary", str(elf), str(bin_path)])
 
-    # Get app_entry address via nm
-    nm_out = subprocess.check_output([nm, "-n", str(elf)], text=True, errors="ignore")
-    addr = None
-    for line in nm_out.splitlines():
-        m = re.match(r"^([0-9a-fA-F]+)\s+\w\s+" + re.escape(SYMBOL) + r"$", line.strip())
-        if m:
-            addr = int(m.group(1), 16)
-            break
-    if addr is None:
+    # Get app_entry and the layout symbols from app.ld / app_xip.ld via nm
+    syms = read_symbols(nm, elf)
+    if SYMBOL not in syms:
         print("app_entry not found in nm output", file=sys.stderr)
         sys.exit(2)
 
-    entry_off = addr - BASE
-    write_pxe(bin_path, out_pxe, entry_off, 0)
-    print(f"Wrote {out_pxe}: image={bin_path.stat().st_size} entry_off=0x{entry_off:x} bss=0x0")
+    base = syms.get("__image_base", BASE)
+    entry_off = syms[SYMBOL] - base
+    bss_size = syms.get("__bss_end", 0) - syms.get("__bss_start", 0)
+
+    flags, data_off, data_size = 0, 0, 0
+    if "__data_start" in syms and "__data_load" in syms:
+        flags |= PXE_F_DATA
+        data_off = syms["__data_load"] - base
+        data_size = syms["__data_end"] - syms["__data_start"]
+    if "__xip_image" in syms:
+        flags |= PXE_F_XIP
+    if API_SYMBOL in syms:
+        if not 0 < syms[API_SYMBOL] < 256:
+            raise SystemExit(f"bad {API_SYMBOL} {syms[API_SYMBOL]}")
+        flags |= syms[API_SYMBOL] << PXE_F_API_SHIFT
+
+    # XIP text cannot move; everything else becomes a relocatable v2 image
+    relocs = None
+    if not flags & PXE_F_XIP:
+        image = bin_path.read_bytes()
+        relocs = read_relocs(readelf, elf, image, base, len(image) + bss_size)
+
+    # XIP images are compared against the flash window as stored
+    if lz and not flags & PXE_F_XIP:
+        flags |= PXE_F_LZ
+
+    stored = write_pxe(bin_path, out_pxe, entry_off, bss_size, flags, data_off, data_size, relocs)
+    image_size = bin_path.stat().st_size
+    if flags & PXE_F_LZ:
+        print(f"LZ: {image_size} -> {stored} bytes ({100.0 * stored / max(1, image_size):.1f}%)")
+    print(f"Wrote {out_pxe}: image={image_size} entry_off=0x{entry_off:x} "
+          f"bss=0x{bss_size:x} data=0x{data_off:x}+0x{data_size:x} flags=0x{flags:x} "
+          f"relocs={len(relocs) if relocs is not None else '-'}")
 
 if __name__ == "__main__":
     main()
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""LZ4 block compressor for PXE_F_LZ images (decoder: src/pxe/pxe_lz.c).
+
+Greedy, one hash probe per position; good enough for small Thumb images and
+the output is a standard LZ4 block (lz4.block.decompress can read it).
+"""
+import sys, pathlib
+
+MIN_MATCH     = 4
+LAST_LITERALS = 5   # LZ4: the last 5 bytes are always literals
+MF_LIMIT      = 12  # LZ4: no match may start in the last 12 bytes
+MAX_OFFSET    = 0xFFFF
+
+def _len_bytes(n: int) -> bytes:
+    out = bytearray()
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+    return bytes(out)
+
+def _sequence(lit: bytes, off: int = 0, mlen: int = 0) -> bytes:
+    lit_nib = min(len(lit), 15)
+    m = mlen - MIN_MATCH if off else 0
+    m_nib = min(m, 15) if off else 0
+    out = bytearray([(lit_nib << 4) | m_nib])
+    if lit_nib == 15:
+        out += _len_bytes(len(lit) - 15)
+    out += lit
+    if off:
+        out += off.to_bytes(2, "little")
+        if m_nib == 15:
+            out += _len_bytes(m - 15)
+    return bytes(out)
+
+def compress(data: bytes) -> bytes:
+    n = len(data)
+    out = bytearray()
+    table = {}
+    anchor = i = 0
+    match_end_limit = n - LAST_LITERALS
+    while i < n - MF_LIMIT:
+        key = data[i:i + MIN_MATCH]
+        cand = table.get(key)
+        table[key] = i
+        if cand is None or i - cand > MAX_OFFSET:
+            i += 1
+            continue
+        m = MIN_MATCH
+        while i + m < match_end_limit and data[cand + m] == data[i + m]:
+            m += 1
+        out += _sequence(data[anchor:i], i - cand, m)
+        # Index a couple of positions inside the match for the next search
+        for j in range(i + 1, min(i + m, n - MIN_MATCH), max(1, m // 2)):
+            table[data[j:j + MIN_MATCH]] = j
+        i += m
+        anchor = i
+    out += _sequence(data[anchor:])
+    return bytes(out)
+
+def decompress(block: bytes, size: int) -> bytes:
+    """Reference decoder, used to self-check compress()."""
+    out = bytearray()
+    i = 0
+    while True:
+        token = block[i]; i += 1
+        lit = token >> 4
+        if lit == 15:
+            while True:
+                b = block[i]; i += 1
+                lit += b
+                if b != 255:
+                    break
+        out += block[i:i + lit]; i += lit
+        if len(out) >= size:
+            break
+        off = block[i] | (block[i + 1] << 8); i += 2
+        m = token & 15
+        if m == 15:
+            while True:
+                b = block[i]; i += 1
+                m += b
+                if b != 255:
+                    break
+        for _ in range(m + MIN_MATCH):
+            out.append(out[-off])
+    return bytes(out)
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        print("Usage: pxe_lz.py <file> [<out.lz>]   (prints the compression ratio)", file=sys.stderr)
+        sys.exit(1)
+    data = pathlib.Path(sys.argv[1]).read_bytes()
+    z = compress(data)
+    assert decompress(z, len(data)) == data
+    if len(sys.argv) == 3:
+        pathlib.Path(sys.argv[2]).write_bytes(z)
+    print(f"{len(data)} -> {len(z)} bytes ({100.0 * len(z) / max(1, len(data)):.1f}%)")
+
+if __name__ == "__main__":
+    main()
@@ -1,5 +1,8 @@
 #include "vfs/vfs.h"
+#include "fs/ramfs.h"
 #include "dos/dos.h"
+#include "dos/autoexec.h"
+#include "os/boot.h"
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -8,72 +11,129 @@
 // Existing: function to execute a single command line (rename as suits your implementation)
 extern void shell_execute_line(const char* line);
 
+#define AX_PATH      "A:\\AUTOEXEC.BAT"
+#define AX_TEXT_MAX  1024   // a ramfs file
+#define AX_LINES_MAX ((AX_TEXT_MAX + 1) / 2)   // every kept line has a char and a newline
+#define AX_LINE_MAX  127    // longer lines are truncated, as before
+
+// off[] entries: text offset (< AX_TEXT_MAX) plus two flags
+#define AX_OFF_MASK  0x3FFFu
+#define AX_DEFER     0x4000u   // line was "DEFER <cmd>"
+#define AX_PENDING   0x8000u   // deferred line not run yet
+
+// Parsed AUTOEXEC: the file once, split into runnable lines (blank / REM
+// lines dropped, "DEFER " stripped and flagged). Keyed on the file's ramfs
+// generation, so the deferred pass and later runs reuse it unread.
+static struct {
+    bool     valid;
+    int      node;
+    uint32_t gen;
+    int      count;
+    bool     pending;      // some AX_PENDING lines left
+    uint16_t off[AX_LINES_MAX];
+    char     text[AX_TEXT_MAX + 1];
+} g_ax;
+
 // Skip leading whitespace
 static const char* lskip(const char* s){
     while (*s == ' ' || *s == '\t') s++;
     return s;
 }
 
+static bool starts_with_word(const char* s, const char* w){
+    size_t n = strlen(w);
+    for (size_t i=0;i<n;i++) {
+        char c = s[i];
+        if (c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
+        if (c != w[i]) return false;
+    }
+    return s[n]==0 || s[n]==' ' || s[n]=='\t';
+}
+
 static bool starts_with_rem(const char* s){
     // Allow REM / rem / Rem (simple)
-    if ((s[0]=='R'||s[0]=='r') && (s[1]=='E'||s[1]=='e') && (s[2]=='M'||s[2]=='m')) {
-        char c = s[3];
-        return (c==0 || c==' ' || c=='\t');
+    return starts_with_word(s, "REM");
+}
+
+static bool ax_parse(void) {
+    vfs_err_t e;
+    int node;
+    uint32_t gen;
+    if (!ramfs_file_gen(AX_PATH, &node, &gen, &e)) { g_ax.valid = false; return false; }
+    if (g_ax.valid && g_ax.node == node && g_ax.gen == gen) return true;
+
+    int fd = vfs_open(AX_PATH, VFS_O_RDONLY, &e);
+    if (fd < 0) { g_ax.valid = false; return false; }
+    int len = 0, r;
+    while (len < AX_TEXT_MAX && (r = vfs_read(fd, g_ax.text + len, (size_t)(AX_TEXT_MAX - len), &e)) > 0) len += r;
+    vfs_close(fd);
+    g_ax.text[len] = 0;
+
+    g_ax.count = 0;
+    g_ax.pending = false;
+    char* p = g_ax.text;
+    while (*p && g_ax.count < AX_LINES_MAX) {
+        char* eol = p;
+        while (*eol && *eol != '\n') eol++;
+        char* next = *eol ? eol + 1 : eol;
+        *eol = 0;
+        if (eol > p && eol[-1] == '\r') eol[-1] = 0;
+        if (strlen(p) > AX_LINE_MAX) p[AX_LINE_MAX] = 0;
+
+        char* s = (char*)lskip(p);
+        if (*s && !starts_with_rem(s)) {
+            uint16_t flags = 0;
+            if (starts_with_word(s, "DEFER")) {
+                s = (char*)lskip(s + 5);
+                flags = AX_DEFER;
+            }
+            if (*s) g_ax.off[g_ax.count++] = (uint16_t)(s - g_ax.text) | flags;
+        }
+        p = next;
     }
-    return false;
+    g_ax.node = node;
+    g_ax.gen = gen;
+    g_ax.valid = true;
+    return true;
 }
 
 void dos_run_autoexec(void){
-    vfs_err_t e;
-    int fd = vfs_open("A:\\AUTOEXEC.BAT", VFS_O_RDONLY, &e);
-    if (fd < 0) return; // Do nothing if not present
+    if (!ax_parse()) return; // Do nothing if not present
 
     dos_puts("[AUTOEXEC]\r\n");
-
-    // Small is enough (line buffer)
-    char line[128];
-    int  li = 0;
-
-    // Read buffer
-    uint8_t buf[64];
-
-    while (1) {
-        int r = vfs_read(fd, buf, sizeof(buf), &e);
-        if (r <= 0) break;
-
-        for (int i=0; i<r; i++) {
-            char c = (char)buf[i];
-
-            if (c == '\r') continue;
-
-            if (c == '\n') {
-                line[li] = 0;
-                li = 0;
-
-                const char* s = lskip(line);
-                if (*s == 0) continue;
-                if (starts_with_rem(s)) continue;
-
-                // Execute (optionally echo here)
-                shell_execute_line(s);
-                continue;
-            }
-
-            if (li < (int)sizeof(line)-1) {
-                line[li++] = c;
-            } else {
-                // If line is too long: truncate tail (minimal implementation)
-            }
+    // Fast boot leaves DEFER lines for after the first prompt
+    const bool fast = boot_fast();
+    g_ax.pending = false;
+    for (int i=0;i<g_ax.count;i++) {
+        uint16_t o = g_ax.off[i];
+        if (fast && (o & AX_DEFER)) {
+            g_ax.off[i] = o | AX_PENDING;
+            g_ax.pending = true;
+            continue;
         }
+        g_ax.off[i] = o & (uint16_t)~AX_PENDING;
+        shell_execute_line(g_ax.text + (o & AX_OFF_MASK));
     }
+    dos_puts("[AUTOEXEC END]\r\n");
+}
 
-    // If the last line lacked a trailing newline
-    if (li > 0) {
-        line[li] = 0;
-        const char* s = lskip(line);
-        if (*s && !starts_with_rem(s)) shell_execute_line(s);
-    }
+bool dos_run_autoexec_deferred(void){
+    if (!g_ax.pending || !g_ax.valid) return false;
+    g_ax.pending = false;
 
-    vfs_close(fd);
+    // The RAM disk was reloaded (failed lazy CRC) or the file changed since
+    vfs_err_t e;
+    int node;
+    uint32_t gen;
+    if (!ramfs_file_gen(AX_PATH, &node, &gen, &e) || node != g_ax.node || gen != g_ax.gen) return false;
+
+    dos_puts("\r\n[AUTOEXEC DEFER]\r\n");
+    for (int i=0;i<g_ax.count;i++) {
+        uint16_t o = g_ax.off[i];
+        if (!(o & AX_PENDING)) continue;
+        g_ax.off[i] = o & (uint16_t)~AX_PENDING;
+        shell_execute_line(g_ax.text + (o & AX_OFF_MASK));
+    }
     dos_puts("[AUTOEXEC END]\r\n");
+    return true;
 }
@@ -1,2 +1,5 @@
 #pragma once
+#include <stdbool.h>
 void dos_run_autoexec(void);
+// Fast boot: the DEFER lines dos_run_autoexec() skipped; false if none
+bool dos_run_autoexec_deferred(void);
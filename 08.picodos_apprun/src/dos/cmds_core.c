@@ -1,13 +1,27 @@
 // cmds_core.c
+#include <stdlib.h>
 #include <string.h>
 #include "dos/cmds_core.h"
 #include "dos/dos_sys.h"
+#include "dos/dos.h"
+#include "dos/shell_exec.h"
 #include "dos/apps_builtin.h"
 #include "vfs/vfs.h"
 #include "fs/flash_fs.h"
 #include "fs/ramfs.h"
+#include "fs/fs_bench.h"
 #include "pxe/pxe_loader.h"
+#include "os/app_slot.h"
+#include "os/job.h"
+#include "os/trace.h"
+#include "os/boot.h"
+#include "os/stats.h"
+#include "os/mem.h"
 #include "xfer/xfer_recv.h"
+#include "xfer/xfer_session.h"
+#include "xfer/xfer_send.h"
+#include "xfer/xfer_pipe.h"
+#include "util/strutil.h"
 
 static void cmd_help(void) {
     dos_puts(
@@ -16,6 +30,11 @@ static void cmd_help(void) {
         "  ECHO [text]\r\n"
         "  CLS\r\n"
         "  RUN <app> [args]\r\n"
+        "  CACHE [/FLUSH]\r\n"
+        "  START <app> [args]\r\n"
+        "  JOBS\r\n"
+        "  WAIT\r\n"
+        "  KILL\r\n"
         "  DIR\r\n"
         "  TYPE <file>\r\n"
         "  COPY <src> <dst>\r\n"
@@ -26,6 +45,16 @@ static void cmd_help(void) {
         "  SAVE\r\n"
         "  LOAD\r\n"
         "  RECV <file>\r\n"
+        "  RECV /S [dir] [/SAVE]\r\n"
+        "  RECV /STAT\r\n"
+        "  NETRUN [/SAVE <file>] [args]\r\n"
+        "  SEND <file> | /IMAGE\r\n"
+        "  FSBENCH [/CSV | /JSON] [/FLASH] [/MS n]\r\n"
+        "  TRACE [ON | OFF | CLEAR | DUMP]\r\n"
+        "  BOOTSTAT\r\n"
+        "  TIME <command line>\r\n"
+        "  STATS\r\n"
+        "  MEM\r\n"
     );
 }
 
@@ -98,6 +127,15 @@ static void cmd_load(void) {
 
 
 #define PATH_MAX 64
+
+// Example: append .PXE if no extension
+static void pxe_path(char* path, const char* name) {
+    strncpy(path, name, PATH_MAX-1);
+    path[PATH_MAX-1] = 0;
+    // Simplest: append .PXE at end (skip if already present; PATH search later)
+    if (!strstr(path, ".PXE")) strncat(path, ".PXE", PATH_MAX-strlen(path)-1);
+}
+
 static bool cmd_run_pxe(int argc, char** argv) {
 
     if (argc < 2) { dos_puts("Usage: RUN <app>\r\n"); return true; }
@@ -105,12 +143,8 @@ static bool cmd_run_pxe(int argc, char** argv) {
     // First, try builtin apps by name
     if (apps_builtin_run(argv[1], argc-1, &argv[1])) return true;
 
-    // Example: append .PXE if no extension
     char path[PATH_MAX];
-    strncpy(path, argv[1], sizeof(path)-1);
-    path[sizeof(path)-1] = 0;
-    // Simplest: append .PXE at end (skip if already present; PATH search later)
-    if (!strstr(path, ".PXE")) strncat(path, ".PXE", sizeof(path)-strlen(path)-1);
+    pxe_path(path, argv[1]);
 
     if (!pxe_run_fixed(path, argc-1, &argv[1])) {
         dos_puts("PXE load/run failed.\r\n");
@@ -118,6 +152,200 @@ static bool cmd_run_pxe(int argc, char** argv) {
     return true;
 }
 
+// START <app> [args]: run a PXE on core 1; the shell stays on core 0
+static void cmd_start(int argc, char** argv) {
+    if (argc < 2) { dos_puts("Usage: START <app> [args]\r\n"); return; }
+    char path[PATH_MAX];
+    pxe_path(path, argv[1]);
+    if (!job_start(path, argc-1, &argv[1])) { dos_puts("START failed\r\n"); return; }
+    dos_printf("[1] %s\r\n", job_info()->name);
+}
+
+// JOBS: state of the core 1 job
+static void cmd_jobs(void) {
+    const job_info_t* j = job_info();
+    if (j->state == JOB_NONE) { dos_puts("No jobs\r\n"); return; }
+    uint64_t end = j->end_us ? j->end_us : dos_time_us();
+    unsigned long ms = (unsigned long)((end - j->start_us) / 1000u);
+    if (j->state == JOB_RUNNING) dos_printf("[1] %-12s running  %lu ms  calls=%lu\r\n", j->name, ms, (unsigned long)j->calls);
+    else if (j->state == JOB_EXITED) dos_printf("[1] %-12s exit %d  %lu ms  calls=%lu\r\n", j->name, j->rc, ms, (unsigned long)j->calls);
+    else dos_printf("[1] %-12s killed  %lu ms\r\n", j->name, ms);
+}
+
+// RECV /S [dir] [/SAVE]: batch session into dir (default: current directory)
+static void cmd_recv_session(int argc, char** argv) {
+    const char* base = "";
+    bool save = false;
+    for (int i=2;i<argc;i++) {
+        if (str_eq_nocase(argv[i], "/SAVE")) save = true;
+        else base = argv[i];
+    }
+    if (!xfer_recv_session(base, save)) dos_puts("RECV failed\r\n");
+}
+
+// SEND <file> | /IMAGE: framed export to the host (tools/recv_file.py)
+static void cmd_send(const char* what) {
+    bool ok;
+    if (str_eq_nocase(what, "/IMAGE")) {
+        const uint8_t* img;
+        uint32_t size;
+        if (!flash_fs_active_image(&img, &size)) { dos_puts("No saved image.\r\n"); return; }
+        ok = xfer_send_buffer("FLASH.IMG", img, size);
+    } else {
+        ok = xfer_send_file(what);
+    }
+    dos_puts(ok ? "\r\n" : "SEND failed\r\n");
+}
+
+// CACHE [/FLUSH]: resident PXE images and loader hit/miss counters
+static void cmd_cache(int argc, char** argv) {
+    if (argc >= 2 && str_eq_nocase(argv[1], "/FLUSH")) pxe_cache_flush();
+    const pxe_cache_stats_t* st = pxe_cache_stats();
+    dos_printf("hits=%lu misses=%lu evictions=%lu\r\n",
+        (unsigned long)st->hits, (unsigned long)st->misses, (unsigned long)st->evictions);
+    for (int i=0;;i++) {
+        const app_slot_t* s = app_slot_get(i);
+        if (!s) break;
+        if (s->base) dos_printf("  %08lx %6lu %s\r\n", (unsigned long)(uintptr_t)s->base, (unsigned long)s->size, s->name);
+    }
+}
+
+// FSBENCH [/CSV | /JSON] [/FLASH] [/MS n]: ramfs / vfs / flash_fs timings
+static void cmd_fsbench(int argc, char** argv) {
+    fs_bench_opts_t o = { .fmt = FS_BENCH_TABLE, .min_us = 20000 };
+    for (int i=1;i<argc;i++) {
+        if (str_eq_nocase(argv[i], "/CSV")) o.fmt = FS_BENCH_CSV;
+        else if (str_eq_nocase(argv[i], "/JSON")) o.fmt = FS_BENCH_JSON;
+        else if (str_eq_nocase(argv[i], "/FLASH")) o.flash = true;
+        else if (str_eq_nocase(argv[i], "/MS") && i + 1 < argc) o.min_us = (uint32_t)strtoul(argv[++i], NULL, 10) * 1000u;
+        else { dos_puts("Usage: FSBENCH [/CSV | /JSON] [/FLASH] [/MS n]\r\n"); return; }
+    }
+    if (job_active()) { dos_puts("A job is running (WAIT or KILL it first)\r\n"); return; }
+
+    // The ramfs image buffer borrows the app arena; cached PXEs make room
+    uint32_t need = (uint32_t)fs_bench_scratch_bytes();
+    o.scratch = app_slot_alloc(need, "FSBENCH");
+    if (!o.scratch) { pxe_cache_flush(); o.scratch = app_slot_alloc(need, "FSBENCH"); }
+    if (!o.scratch) { dos_puts("App arena busy\r\n"); return; }
+
+    if (!fs_bench_run(&o)) dos_puts("FSBENCH failed\r\n");
+    app_slot_free(o.scratch);
+}
+
+// TRACE [ON | OFF | CLEAR | DUMP]: event ring (os/trace.h). DUMP sends it
+// framed like SEND; tools/trace2perfetto.py makes a timeline of TRACE.BIN
+static void cmd_trace(int argc, char** argv) {
+    const char* op = argc >= 2 ? argv[1] : "";
+    if (str_eq_nocase(op, "ON")) trace_enable(true);
+    else if (str_eq_nocase(op, "OFF")) trace_enable(false);
+    else if (str_eq_nocase(op, "CLEAR")) trace_clear();
+    else if (str_eq_nocase(op, "DUMP")) {
+        bool on = trace_enabled();
+        uint32_t size;
+        const uint8_t* img = trace_snapshot(&size);
+        bool ok = xfer_send_buffer("TRACE.BIN", img, size);
+        trace_enable(on);
+        dos_puts(ok ? "\r\n" : "SEND failed\r\n");
+        return;
+    }
+    else if (op[0]) { dos_puts("Usage: TRACE [ON | OFF | CLEAR | DUMP]\r\n"); return; }
+
+    const trace_hdr_t* h = trace_header();
+    dos_printf("Trace %s, groups %02lx, core0 %lu events, core1 %lu (last %lu kept)\r\n",
+        trace_enabled() ? "on" : "off", (unsigned long)h->groups,
+        (unsigned long)h->head[0], (unsigned long)h->head[1], (unsigned long)h->entries);
+}
+
+// Syscall counts: all of st, or only what grew since base
+static void print_syscalls(const stats_t* st, const stats_t* base) {
+    int shown = 0;
+    for (uint32_t no=1;no<SYS_COUNT;no++) {
+        uint32_t n = st->sys[no] - (base ? base->sys[no] : 0);
+        if (!n) continue;
+        dos_printf("%s%s=%lu", shown++ % 6 ? " " : "  ", stats_sys_name(no), (unsigned long)n);
+        if (shown % 6 == 0) dos_puts("\r\n");
+    }
+    if (shown % 6) dos_puts("\r\n");
+}
+
+// TIME <command line>: run it (also from batch files) and report its cost
+#define TIME_NEST_MAX 4
+static void cmd_time(int argc, char** argv) {
+    if (argc < 2) { dos_puts("Usage: TIME <command line>\r\n"); return; }
+    char line[160];
+    size_t n = 0;
+    for (int i=1;i<argc;i++) {
+        bool q = strchr(argv[i], ' ') != NULL;
+        size_t len = strlen(argv[i]);
+        if (n + len + 4 > sizeof(line)) { dos_puts("Line too long\r\n"); return; }
+        if (i > 1) line[n++] = ' ';
+        if (q) line[n++] = '"';
+        memcpy(line + n, argv[i], len);
+        n += len;
+        if (q) line[n++] = '"';
+    }
+    line[n] = 0;
+
+    // One snapshot per nesting level (TIME TIME ..., TIME CALL with TIMEs
+    // inside); too big for the shell stack
+    static stats_t before_at[TIME_NEST_MAX];
+    static int depth;
+    if (depth == TIME_NEST_MAX) { dos_puts("TIME nested too deep\r\n"); return; }
+    stats_t* before = &before_at[depth++];
+    *before = *stats_get();
+    uint32_t outer_peak = stats_mark_slots();
+    uint64_t t0 = dos_time_us();
+    shell_execute_line(line);
+    uint32_t us = (uint32_t)(dos_time_us() - t0);
+    depth--;
+    const stats_t* st = stats_get();
+    uint32_t peak = st->slot_mark_peak;
+    stats_unmark_slots(outer_peak);
+
+    dos_printf("[TIME] %lu us, %lu syscalls\r\n", (unsigned long)us,
+        (unsigned long)(st->sys_total - before->sys_total));
+    print_syscalls(st, before);
+    dos_printf("  vfs: %lu opens, %lu B read, %lu B written\r\n",
+        (unsigned long)(st->vfs_opens - before->vfs_opens),
+        (unsigned long)(st->vfs_rd_bytes - before->vfs_rd_bytes),
+        (unsigned long)(st->vfs_wr_bytes - before->vfs_wr_bytes));
+    if (st->flash_writes != before->flash_writes)
+        dos_printf("  flash: %lu sectors erased, %lu pages programmed\r\n",
+            (unsigned long)(st->flash_sectors - before->flash_sectors),
+            (unsigned long)(st->flash_pages - before->flash_pages));
+    dos_printf("  app slots: peak %lu B\r\n", (unsigned long)peak);
+}
+
+// STATS: counters since boot
+static void cmd_stats(void) {
+    const stats_t* st = stats_get();
+    dos_printf("Up %lu ms, %lu commands\r\n", (unsigned long)(dos_time_us() / 1000), (unsigned long)st->cmds);
+    dos_printf("Syscalls: %lu\r\n", (unsigned long)st->sys_total);
+    print_syscalls(st, NULL);
+    dos_printf("VFS: %lu opens, %lu B read, %lu B written\r\n",
+        (unsigned long)st->vfs_opens, (unsigned long)st->vfs_rd_bytes, (unsigned long)st->vfs_wr_bytes);
+    dos_printf("Flash: %lu writes, %lu sectors erased, %lu pages programmed\r\n",
+        (unsigned long)st->flash_writes, (unsigned long)st->flash_sectors, (unsigned long)st->flash_pages);
+    dos_printf("App slots: %lu B in use, peak %lu B\r\n",
+        (unsigned long)st->slot_used, (unsigned long)st->slot_peak);
+}
+
+// NETRUN [/SAVE <file>] [args]: receive a PXE and run it without going through ramfs
+static bool cmd_netrun(int argc, char** argv) {
+    const char* save = NULL;
+    int first = 1;
+    if (argc >= 2 && str_eq_nocase(argv[1], "/SAVE")) {
+        if (argc < 3) { dos_puts("Usage: NETRUN [/SAVE <file>] [args]\r\n"); return true; }
+        save = argv[2];
+        first = 3;
+    }
+    // The app sees argv[0] = "NETRUN", followed by its own args
+    argv[first-1] = argv[0];
+    if (!pxe_run_wire(save, argc-first+1, &argv[first-1])) {
+        dos_puts("NETRUN failed\r\n");
+    }
+    return true;
+}
 
 bool cmds_core_try(int argc, char** argv) {
     if (strcmp(argv[0], "HELP") == 0) {
@@ -141,6 +369,29 @@ bool cmds_core_try(int argc, char** argv) {
         return true;
 #endif
         }
+    if (strcmp(argv[0], "START") == 0) {
+        cmd_start(argc, argv);
+        return true;
+    }
+    if (strcmp(argv[0], "JOBS") == 0) {
+        cmd_jobs();
+        return true;
+    }
+    if (strcmp(argv[0], "WAIT") == 0) {
+        if (!job_active()) dos_puts("No running job\r\n");
+        else if (job_wait()) cmd_jobs();
+        else dos_puts("^C\r\n");
+        return true;
+    }
+    if (strcmp(argv[0], "KILL") == 0) {
+        if (!job_kill()) dos_puts("No running job\r\n");
+        else cmd_jobs();
+        return true;
+    }
+    if (strcmp(argv[0], "CACHE") == 0) {
+        cmd_cache(argc, argv);
+        return true;
+    }
     if (strcmp(argv[0], "SAVE") == 0) {
         cmd_save();
         return true;
@@ -152,9 +403,52 @@ bool cmds_core_try(int argc, char** argv) {
 
     if (strcmp(argv[0], "RECV") == 0) {
         if (argc < 2) { dos_puts("Usage: RECV <path>\r\n"); return true; }
+        if (str_eq_nocase(argv[1], "/STAT")) {
+            const xfer_pipe_stats_t* st = xfer_pipe_stats();
+            dos_printf("frames=%lu waits=%lu stalls=%lu overlap=%lu max_ready=%lu\r\n",
+                (unsigned long)st->frames, (unsigned long)st->commit_waits, (unsigned long)st->rx_stalls,
+                (unsigned long)st->overlap_bytes, (unsigned long)st->max_ready);
+            return true;
+        }
+        if (str_eq_nocase(argv[1], "/S")) {
+            cmd_recv_session(argc, argv);
+            return true;
+        }
         if (!xfer_recv_file(argv[1])) dos_puts("RECV failed\r\n");
         return true;
     }
+    if (strcmp(argv[0], "SEND") == 0) {
+        if (argc < 2) { dos_puts("Usage: SEND <file> | /IMAGE\r\n"); return true; }
+        cmd_send(argv[1]);
+        return true;
+    }
+    if (strcmp(argv[0], "NETRUN") == 0) {
+        return cmd_netrun(argc, argv);
+    }
+    if (strcmp(argv[0], "BOOTSTAT") == 0) {
+        boot_print();
+        return true;
+    }
+    if (strcmp(argv[0], "TRACE") == 0) {
+        cmd_trace(argc, argv);
+        return true;
+    }
+    if (strcmp(argv[0], "TIME") == 0) {
+        cmd_time(argc, argv);
+        return true;
+    }
+    if (strcmp(argv[0], "STATS") == 0) {
+        cmd_stats();
+        return true;
+    }
+    if (strcmp(argv[0], "MEM") == 0) {
+        mem_print();
+        return true;
+    }
+    if (strcmp(argv[0], "FSBENCH") == 0) {
+        cmd_fsbench(argc, argv);
+        return true;
+    }
 
     return false;
 }
@@ -4,6 +4,7 @@
 #include "dos/apps_builtin.h"
 #include "dos/autoexec.h"
 #include "dos/shell_exec.h"
+#include "os/boot.h"
 #include <stdarg.h>
 
 void dos_init(void) {
@@ -12,6 +13,7 @@ void dos_init(void) {
 
 void dos_run(void) {
     dos_run_autoexec();
+    boot_mark(BOOT_AUTOEXEC);
     shell_run();
 }
 
@@ -5,14 +5,25 @@
 #include "pico/stdlib.h"
 #include "pico/stdio.h"
 
+static void (*g_idle)(void);
+
 void dos_sys_init(void) {}
 
+void dos_set_idle_hook(void (*fn)(void)) { g_idle = fn; }
+
 int dos_getc_blocking(void) {
     int c;
-    do { c = getchar_timeout_us(0); } while (c == PICO_ERROR_TIMEOUT);
+    while ((c = getchar_timeout_us(0)) == PICO_ERROR_TIMEOUT) {
+        if (g_idle) g_idle();
+    }
     return c;
 }
 
+int dos_getc_nowait(void) {
+    int c = getchar_timeout_us(0);
+    return c < 0 ? -1 : c;
+}
+
 void dos_putc(char c) { putchar_raw(c); }
 
 void dos_puts(const char* s) {
@@ -23,3 +34,10 @@ void dos_vprintf(const char* fmt, va_list ap) {
     vprintf(fmt, ap);
 }
 
+
+uint64_t dos_time_us(void) { return time_us_64(); }
+
+void dos_yield(void) {
+    if (g_idle) g_idle();
+    tight_loop_contents();
+}
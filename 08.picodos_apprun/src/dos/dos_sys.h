@@ -3,10 +3,16 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 void dos_sys_init(void);
 int  dos_getc_blocking(void);
+int  dos_getc_nowait(void);     // -1 if nothing is pending
 void dos_putc(char c);
 void dos_puts(const char* s);
 void dos_vprintf(const char* fmt, va_list ap);
+uint64_t dos_time_us(void);     // monotonic, since boot
+void dos_yield(void);           // let background work run (the idle hook)
+// Called whenever the console waits for input or code yields (os/job.c)
+void dos_set_idle_hook(void (*fn)(void));
 // high-level `dos_printf` is provided by dos.h/dos.c
@@ -7,6 +7,9 @@
 #include "dos/cmds_fs.h"
 #include "fs/ramfs.h"
 #include "util/strutil.h"
+#include "os/trace.h"
+#include "os/boot.h"
+#include "os/stats.h"
 #include <string.h>
 #include <stdbool.h>
 
@@ -36,7 +39,9 @@ void shell_run(void) {
         char pwd[PWD_MAX_PATH];
         ramfs_pwd(pwd, sizeof(pwd));
         dos_printf("%s> ", pwd);
-        
+        // The first prompt ends the boot; deferred work may print below it
+        if (boot_prompt()) continue;
+
         read_line(line, sizeof(line));
         if (!line[0]) continue;
 
@@ -46,8 +51,11 @@ void shell_run(void) {
         // Treat command as uppercase (DOS-like)
         str_to_upper(av.argv[0]);
 
-        if (cmds_core_try(av.argc, av.argv)) continue;
-        if (cmds_fs_try(av.argc, av.argv)) continue;
+        stats_cmd();
+        TRACE(TR_CMD_BEGIN, trace_tag(av.argv[0]), av.argc);
+        bool done = cmds_core_try(av.argc, av.argv) || cmds_fs_try(av.argc, av.argv);
+        TRACE(TR_CMD_END, trace_tag(av.argv[0]), done);
+        if (done) continue;
 
         dos_printf("Bad command or file name: %s\n", av.argv[0]);
     }
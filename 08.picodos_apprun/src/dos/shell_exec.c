@@ -5,6 +5,8 @@
 #include "dos/dos_sys.h"
 #include "dos/cmds_core.h"
 #include "dos/cmds_fs.h"
+#include "os/trace.h"
+#include "os/stats.h"
 
 static bool is_space(char c) { return c==' ' || c=='\t'; }
 
@@ -67,8 +69,11 @@ void shell_execute_line(const char* line) {
 
     if (argc <= 0) return;
 
-    if (cmds_core_try(argc, argv)) return;
-    if (cmds_fs_try(argc, argv)) return;
+    stats_cmd();
+    TRACE(TR_CMD_BEGIN, trace_tag(argv[0]), argc);
+    bool done = cmds_core_try(argc, argv) || cmds_fs_try(argc, argv);
+    TRACE(TR_CMD_END, trace_tag(argv[0]), done);
+    if (done) return;
 
     dos_puts("Bad command or file name.\r\n");
 }
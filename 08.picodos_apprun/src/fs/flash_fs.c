@@ -4,9 +4,7 @@
 #include <string.h>
 #include <stdint.h>
 
-#include "hardware/flash.h"
-#include "pico/flash.h"
-#include "pico/stdlib.h"
+#include "hal/hal_flash.h"
 
 
 // ---- Adjust these as needed ----
@@ -36,7 +34,7 @@ static uint32_t crc32_simple(const void *data, size_t len) {
 }
 
 static const uint8_t* flash_ptr(uint32_t off) {
-    return (const uint8_t*)(XIP_BASE + off);
+    return hal_flash_map(off);
 }
 
 static bool hdr_valid(const fs_hdr_t *h) {
@@ -56,23 +54,9 @@ static bool read_slot(uint32_t slot_off, fs_hdr_t *hdr_out) {
     return crc == hdr_out->crc;
 }
 
-typedef struct {
-    uint32_t offset;
-    const uint8_t *src;
-    size_t len; // MUST be FS_SLOT_BYTES
-} prog_args_t;
-
-// Run from RAM since XIP halts during flash writes
-static void __not_in_flash_func(do_erase_prog)(void *p) {
-    prog_args_t *a = (prog_args_t*)p;
-
-    // Erase entire slot (4KB sectors)
-    flash_range_erase(a->offset, a->len);
-
-    // Program in 256B pages
-    for (size_t i = 0; i < a->len; i += FLASH_PAGE_SIZE) {
-        flash_range_program(a->offset + (uint32_t)i, a->src + i, FLASH_PAGE_SIZE);
-    }
+bool flash_fs_program_region(uint32_t offset, const uint8_t* src, size_t len) {
+    if (offset + len > FS_FLASH_BASE_OFFSET) return false;   // never over the FS slots
+    return hal_flash_write(offset, src, len);
 }
 
 bool flash_fs_load(void) {
@@ -91,6 +75,44 @@ bool flash_fs_load(void) {
     return ramfs_deserialize(payload, best.size);
 }
 
+// Slot loaded by flash_fs_load_lazy() whose CRC is still unchecked
+static bool g_lazy_pending;
+static uint32_t g_lazy_off;
+static fs_hdr_t g_lazy_hdr;
+
+bool flash_fs_load_lazy(void) {
+    fs_hdr_t h0 = *(const fs_hdr_t*)flash_ptr(FS_SLOT0_OFFSET);
+    fs_hdr_t h1 = *(const fs_hdr_t*)flash_ptr(FS_SLOT1_OFFSET);
+    bool v0 = hdr_valid(&h0), v1 = hdr_valid(&h1);
+    if (!v0 && !v1) return false;
+
+    bool use0 = v0 && (!v1 || h0.seq >= h1.seq);
+    g_lazy_off = use0 ? FS_SLOT0_OFFSET : FS_SLOT1_OFFSET;
+    g_lazy_hdr = use0 ? h0 : h1;
+    // A torn newest slot usually fails the image checks; then do it properly
+    if (!ramfs_deserialize(flash_ptr(g_lazy_off + sizeof(fs_hdr_t)), g_lazy_hdr.size)) return flash_fs_load();
+    g_lazy_pending = true;
+    return true;
+}
+
+bool flash_fs_verify(void) {
+    if (!g_lazy_pending) return true;
+    g_lazy_pending = false;
+    return crc32_simple(flash_ptr(g_lazy_off + sizeof(fs_hdr_t)), g_lazy_hdr.size) == g_lazy_hdr.crc;
+}
+
+bool flash_fs_active_image(const uint8_t** data, uint32_t* size) {
+    fs_hdr_t h0, h1;
+    bool v0 = read_slot(FS_SLOT0_OFFSET, &h0);
+    bool v1 = read_slot(FS_SLOT1_OFFSET, &h1);
+    if (!v0 && !v1) return false;
+
+    bool use0 = v0 && (!v1 || h0.seq >= h1.seq);
+    *data = flash_ptr(use0 ? FS_SLOT0_OFFSET : FS_SLOT1_OFFSET);
+    *size = (uint32_t)sizeof(fs_hdr_t) + (use0 ? h0.size : h1.size);
+    return true;
+}
+
 bool flash_fs_save(void) {
     fs_hdr_t h0, h1;
     bool v0 = read_slot(FS_SLOT0_OFFSET, &h0);
@@ -117,9 +139,7 @@ bool flash_fs_save(void) {
     hdr->size  = (uint32_t)sz;
     hdr->crc   = crc32_simple(payload, sz);
 
-    prog_args_t args = { .offset = dst_off, .src = slot_buf, .len = FS_SLOT_BYTES };
-
-    // Execute safely with IRQ/multicore coordination
-    int rc = flash_safe_execute(do_erase_prog, &args, 2000);
-    return rc == PICO_OK;
+    return hal_flash_write(dst_off, slot_buf, FS_SLOT_BYTES);
 }
+
+size_t flash_fs_ram_bytes(void) { return FS_SLOT_BYTES; }   // slot_buf in flash_fs_save
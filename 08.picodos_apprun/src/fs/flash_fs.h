@@ -1,5 +1,17 @@
 #pragma once
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
 
 bool flash_fs_load(void);  // Flash -> RAMFS
 bool flash_fs_save(void);  // RAMFS -> Flash
+// Fast boot: newest slot by header only, CRC left to flash_fs_verify()
+bool flash_fs_load_lazy(void);
+// CRC of the slot flash_fs_load_lazy() used (true if nothing is pending)
+bool flash_fs_verify(void);
+// Newest valid slot as stored in flash (header + ramfs image), for SEND /IMAGE
+bool flash_fs_active_image(const uint8_t** data, uint32_t* size);
+// Erase + program whole sectors outside the FS slots (PXE XIP window)
+bool flash_fs_program_region(uint32_t offset, const uint8_t* src, size_t len);
+// Static RAM behind SAVE (one whole slot, staged before programming)
+size_t flash_fs_ram_bytes(void);
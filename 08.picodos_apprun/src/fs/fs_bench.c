@@ -0,0 +1,300 @@
+// fs_bench.c: timings for the ramfs / vfs / flash_fs hot paths
+//
+// Every case repeats one operation, doubling the count until a batch takes
+// at least min_us (dos_time_us(): the RP2040 timer on the board, the
+// monotonic clock on the host), and reports the last batch:
+//
+//   case,param,iters,ns_per_op,kb_per_s
+//
+// as a table, CSV or one JSON object. The cases live in A:\FSBENCH, which
+// is removed afterwards; serialize / deserialize round-trip the whole RAM
+// disk through scratch (so open file handles, e.g. a > redirect, are lost).
+// Cases that do not fit the 16 ramfs nodes left over are skipped.
+#include "fs/fs_bench.h"
+#include "fs/ramfs.h"
+#include "fs/flash_fs.h"
+#include "vfs/vfs.h"
+#include "dos/dos_sys.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_DIR     "A:\\FSBENCH"
+#define BENCH_FILE    BENCH_DIR "\\DATA.BIN"
+#define BENCH_FILE_SZ 1024u   // RAMFS_FILE_CAP
+#define FLASH_ITERS   4u      // cap: each save erases a 32 KB slot
+
+static const fs_bench_opts_t* g_o;
+static uint32_t g_rows;
+static bool g_err;
+
+// State for the op being timed
+static int g_h;
+static uint32_t g_chunk;
+static uint32_t g_rng;
+static uint32_t g_entries;
+static char g_path[96];
+static uint8_t g_buf[BENCH_FILE_SZ];
+static size_t g_img_len;
+
+size_t fs_bench_ram_bytes(void) { return sizeof(g_path) + sizeof(g_buf); }
+
+// dos_printf() without dos.c, so host/fs_bench links only the fs pieces
+static void out(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    dos_vprintf(fmt, ap);
+    va_end(ap);
+}
+
+static uint32_t rnd(void) {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return g_rng >> 8;
+}
+
+static void emit(const char* name, uint32_t param, uint32_t iters, uint64_t us, uint32_t bytes) {
+    unsigned long ns = (unsigned long)(us * 1000u / iters);
+    unsigned long kbs = us ? (unsigned long)((uint64_t)bytes * iters * 1000000u / 1024u / us) : 0;
+    switch (g_o->fmt) {
+    case FS_BENCH_CSV:
+        out("%s,%lu,%lu,%lu,%lu\r\n", name, (unsigned long)param, (unsigned long)iters, ns, kbs);
+        break;
+    case FS_BENCH_JSON:
+        out("%s\r\n  {\"case\":\"%s\",\"param\":%lu,\"iters\":%lu,\"ns_per_op\":%lu,\"kb_per_s\":%lu}",
+            g_rows ? "," : "", name, (unsigned long)param, (unsigned long)iters, ns, kbs);
+        break;
+    default:
+        if (bytes) out("%-14s %6lu %8lu %10lu %10lu\r\n", name, (unsigned long)param, (unsigned long)iters, ns, kbs);
+        else out("%-14s %6lu %8lu %10lu %10s\r\n", name, (unsigned long)param, (unsigned long)iters, ns, "-");
+        break;
+    }
+    g_rows++;
+}
+
+static void skip(const char* name, uint32_t param) {
+    if (g_o->fmt == FS_BENCH_TABLE) out("%-14s %6lu  skipped (no free ramfs nodes)\r\n", name, (unsigned long)param);
+}
+
+static void fail(const char* name) {
+    if (g_o->fmt == FS_BENCH_TABLE) out("%-14s  FAILED\r\n", name);
+    g_err = true;
+}
+
+// Time op() in doubling batches until one lasts min_us (or max_iters ran)
+static void run(const char* name, uint32_t param, bool (*op)(void), uint32_t bytes, uint32_t max_iters) {
+    uint32_t n = 1;
+    uint64_t us;
+    while (1) {
+        uint64_t t0 = dos_time_us();
+        for (uint32_t i=0;i<n;i++) {
+            if (!op()) { fail(name); return; }
+        }
+        us = dos_time_us() - t0;
+        if (us >= g_o->min_us || n >= max_iters) break;
+        n = n * 2 > max_iters ? max_iters : n * 2;
+    }
+    emit(name, param, n, us, bytes);
+}
+
+// ---- ops ----
+
+static bool op_open_close(void) {
+    vfs_err_t e;
+    int h = ramfs_open(BENCH_FILE, VFS_O_RDONLY, &e);
+    if (h < 0) return false;
+    ramfs_close(h);
+    return true;
+}
+
+static bool op_vfs_open_close(void) {
+    vfs_err_t e;
+    int fd = vfs_open(BENCH_FILE, VFS_O_RDONLY, &e);
+    if (fd < 0) return false;
+    vfs_close(fd);
+    return true;
+}
+
+static bool op_seq_write(void) {
+    vfs_err_t e;
+    if (ramfs_lseek(g_h, 0, VFS_SEEK_SET, &e) < 0) return false;
+    for (uint32_t off = 0; off < BENCH_FILE_SZ; off += g_chunk) {
+        if (ramfs_write(g_h, g_buf, g_chunk, &e) != (int)g_chunk) return false;
+    }
+    return true;
+}
+
+static bool op_seq_read(void) {
+    vfs_err_t e;
+    if (ramfs_lseek(g_h, 0, VFS_SEEK_SET, &e) < 0) return false;
+    for (uint32_t off = 0; off < BENCH_FILE_SZ; off += g_chunk) {
+        if (ramfs_read(g_h, g_buf, g_chunk, &e) != (int)g_chunk) return false;
+    }
+    return true;
+}
+
+static bool op_rand_write(void) {
+    vfs_err_t e;
+    int32_t off = (int32_t)(rnd() % (BENCH_FILE_SZ - g_chunk + 1));
+    return ramfs_lseek(g_h, off, VFS_SEEK_SET, &e) == off && ramfs_write(g_h, g_buf, g_chunk, &e) == (int)g_chunk;
+}
+
+static bool op_rand_read(void) {
+    vfs_err_t e;
+    int32_t off = (int32_t)(rnd() % (BENCH_FILE_SZ - g_chunk + 1));
+    return ramfs_lseek(g_h, off, VFS_SEEK_SET, &e) == off && ramfs_read(g_h, g_buf, g_chunk, &e) == (int)g_chunk;
+}
+
+static bool op_walk(void) {
+    vfs_err_t e;
+    ramfs_dirent_t de;
+    return ramfs_stat(g_path, &de, &e) && de.is_dir;
+}
+
+static bool op_list_dir(void) {
+    vfs_err_t e;
+    ramfs_dirent_t de;
+    for (uint32_t i=0;;i++) {
+        if (!ramfs_list_dir(BENCH_DIR, (int)i, &de, &e)) return false;
+        if (!de.used) return i == g_entries;
+    }
+}
+
+static bool op_serialize(void) {
+    return ramfs_serialize(g_o->scratch, g_img_len) == g_img_len;
+}
+
+static bool op_deserialize(void) {
+    return ramfs_deserialize(g_o->scratch, g_img_len);
+}
+
+static bool op_flash_save(void) { return flash_fs_save(); }
+static bool op_flash_load(void) { return flash_fs_load(); }
+
+// ---- cases ----
+
+static bool make_file(void) {
+    vfs_err_t e;
+    int h = ramfs_open(BENCH_FILE, VFS_O_WRONLY | VFS_O_CREAT | VFS_O_TRUNC, &e);
+    if (h < 0) return false;
+    memset(g_buf, 0xA5, sizeof(g_buf));
+    bool ok = ramfs_write(h, g_buf, sizeof(g_buf), &e) == (int)sizeof(g_buf);
+    ramfs_close(h);
+    return ok;
+}
+
+static void bench_file_io(void) {
+    static const uint16_t chunks[] = { 16, 64, 256, 1024 };
+    vfs_err_t e;
+    if (!make_file()) { skip("open_close", 0); return; }
+
+    run("open_close", 0, op_open_close, 0, 1u << 20);
+    run("vfs_open_close", 0, op_vfs_open_close, 0, 1u << 20);
+
+    g_h = ramfs_open(BENCH_FILE, VFS_O_RDWR, &e);
+    if (g_h < 0) { fail("seq_write"); return; }
+    for (size_t i=0;i<sizeof(chunks)/sizeof(chunks[0]);i++) {
+        g_chunk = chunks[i];
+        run("seq_write", g_chunk, op_seq_write, BENCH_FILE_SZ, 1u << 20);
+        run("seq_read", g_chunk, op_seq_read, BENCH_FILE_SZ, 1u << 20);
+        g_rng = 1;
+        run("rand_write", g_chunk, op_rand_write, g_chunk, 1u << 20);
+        g_rng = 1;
+        run("rand_read", g_chunk, op_rand_read, g_chunk, 1u << 20);
+    }
+    ramfs_close(g_h);
+    ramfs_delete(BENCH_FILE, &e);
+}
+
+// FSBENCH\D\D\...\D: each level is one more walk_dir() step
+static void bench_walk(void) {
+    static const uint8_t depths[] = { 1, 2, 4, 8, 12 };
+    vfs_err_t e;
+    int made = 0;
+    strcpy(g_path, BENCH_DIR);
+    for (size_t i=0;i<sizeof(depths);i++) {
+        bool room = true;
+        while (made < depths[i]) {
+            strcat(g_path, "\\D");
+            if (!ramfs_mkdir(g_path, &e)) { g_path[strlen(g_path) - 2] = '\0'; room = false; break; }
+            made++;
+        }
+        if (!room) { skip("walk_dir", depths[i]); break; }
+        run("walk_dir", depths[i], op_walk, 0, 1u << 20);
+    }
+    while (made-- > 0) {
+        ramfs_rmdir(g_path, &e);
+        g_path[strlen(g_path) - 2] = '\0';
+    }
+}
+
+// Full DIR of FSBENCH with n entries (ramfs_list_dir(idx) rescans from the start)
+static void bench_list(void) {
+    static const uint8_t counts[] = { 1, 4, 8, 12 };
+    vfs_err_t e;
+    g_entries = 0;
+    for (size_t i=0;i<sizeof(counts);i++) {
+        bool room = true;
+        while (g_entries < counts[i]) {
+            snprintf(g_path, sizeof(g_path), BENCH_DIR "\\F%lu", (unsigned long)g_entries);
+            int h = ramfs_open(g_path, VFS_O_WRONLY | VFS_O_CREAT, &e);
+            if (h < 0) { room = false; break; }
+            ramfs_close(h);
+            g_entries++;
+        }
+        if (!room) { skip("list_dir", counts[i]); break; }
+        run("list_dir", counts[i], op_list_dir, 0, 1u << 20);
+    }
+    while (g_entries > 0) {
+        snprintf(g_path, sizeof(g_path), BENCH_DIR "\\F%lu", (unsigned long)--g_entries);
+        ramfs_delete(g_path, &e);
+    }
+}
+
+// The RAM disk as the user left it (FSBENCH already gone)
+static void bench_image(void) {
+    g_img_len = ramfs_image_size();
+    const bool dirty = ramfs_is_dirty();
+    run("serialize", 0, op_serialize, (uint32_t)g_img_len, 1u << 16);
+    if (ramfs_serialize(g_o->scratch, g_img_len) != g_img_len) { fail("deserialize"); return; }
+    run("deserialize", 0, op_deserialize, (uint32_t)g_img_len, 1u << 16);
+    if (dirty) ramfs_set_dirty();
+
+    if (!g_o->flash) return;
+    run("flash_save", 0, op_flash_save, (uint32_t)g_img_len, FLASH_ITERS);
+    run("flash_load", 0, op_flash_load, (uint32_t)g_img_len, 1u << 16);
+    // Flash now holds exactly the RAM disk
+    ramfs_clear_dirty();
+}
+
+size_t fs_bench_scratch_bytes(void) {
+    return ramfs_image_size();
+}
+
+bool fs_bench_run(const fs_bench_opts_t* o) {
+    vfs_err_t e;
+    g_o = o;
+    g_rows = 0;
+    g_err = false;
+
+    const bool dirty = ramfs_is_dirty();
+    if (!ramfs_mkdir(BENCH_DIR, &e)) {
+        dos_puts("Cannot create " BENCH_DIR "\r\n");
+        return false;
+    }
+
+    switch (o->fmt) {
+    case FS_BENCH_CSV:  dos_puts("case,param,iters,ns_per_op,kb_per_s\r\n"); break;
+    case FS_BENCH_JSON: out("{\"bench\":\"fs\",\"min_us\":%lu,\"results\":[", (unsigned long)o->min_us); break;
+    default:            out("%-14s %6s %8s %10s %10s\r\n", "case", "param", "iters", "ns/op", "KB/s"); break;
+    }
+
+    bench_file_io();
+    bench_walk();
+    bench_list();
+    ramfs_rmdir(BENCH_DIR, &e);
+    if (!dirty) ramfs_clear_dirty();
+    bench_image();
+
+    if (o->fmt == FS_BENCH_JSON) out("\r\n]}\r\n");
+    return !g_err;
+}
@@ -0,0 +1,20 @@
+// fs_bench.h: ramfs / vfs / flash_fs microbenchmarks (FSBENCH, host/fs_bench)
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum { FS_BENCH_TABLE, FS_BENCH_CSV, FS_BENCH_JSON } fs_bench_fmt_t;
+
+typedef struct {
+    fs_bench_fmt_t fmt;
+    uint32_t min_us;     // each case repeats until it has run this long
+    bool     flash;      // flash_fs_save / load too (rewrites the FS slots)
+    uint8_t* scratch;    // fs_bench_scratch_bytes() for the ramfs image
+} fs_bench_opts_t;
+
+size_t fs_bench_scratch_bytes(void);
+size_t fs_bench_ram_bytes(void);       // its own static buffers (MEM)
+// Runs every case in a scratch directory (A:\FSBENCH) and removes it again;
+// results go to the console. false if a case failed.
+bool fs_bench_run(const fs_bench_opts_t* o);
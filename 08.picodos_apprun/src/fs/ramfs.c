@@ -1,6 +1,7 @@
 // ramfs.c (full replacement recommended)
 #include "ramfs.h"
 #include "util/strutil.h"
+#include <stddef.h>
 #include <string.h>
 #include <stdio.h>
 
@@ -36,6 +37,12 @@ static fh_t   g_fh[RAMFS_MAX_FH];
 static int g_root = 0;
 static int g_cwd  = 0;
 
+// Per-node change generation, for caches keyed on file contents (PXE loader).
+// Not persisted: a reload from flash hands every node a fresh value.
+static uint32_t g_gen[RAMFS_MAX_NODES];
+static uint32_t g_gen_clock;
+static void touch(int n) { g_gen[n] = ++g_gen_clock; }
+
 static bool g_dirty = false;
 bool ramfs_is_dirty(void){ return g_dirty; }
 void ramfs_set_dirty(void){ g_dirty = true; }
@@ -213,6 +220,7 @@ void ramfs_init(void) {
     g_nodes[f].size = strlen(msg);
     memcpy(g_nodes[f].data, msg, g_nodes[f].size);
     link_child(g_root, f);
+    for (int i=0;i<RAMFS_MAX_NODES;i++) touch(i);
 }
 
 int ramfs_get_cwd_node(void) { return g_cwd; }
@@ -314,6 +322,7 @@ bool ramfs_delete(const char* path, vfs_err_t* err) {
     }
     g_nodes[f].used = false;
     g_nodes[f].size = 0;
+    touch(f);
 
     ramfs_set_dirty();
 
@@ -345,9 +354,10 @@ int ramfs_open(const char* path, int mode, vfs_err_t* err) {
         g_nodes[n].name[RAMFS_NAME_CAP-1] = '\0';
         g_nodes[n].size = 0;
         link_child(parent, n);
+        touch(n);
     } else {
         if (g_nodes[n].type != N_FILE) { if (err) *err = VFS_E_INVAL; return -1; }
-        if (want_trunc) g_nodes[n].size = 0;
+        if (want_trunc) { g_nodes[n].size = 0; touch(n); }
     }
 
     int fh = alloc_fh();
@@ -387,12 +397,37 @@ int ramfs_write(int handle, const void* buf, size_t len, vfs_err_t* err) {
     memcpy(f->data + pos, buf, len);
     g_fh[handle].pos += len;
     if (g_fh[handle].pos > f->size) f->size = g_fh[handle].pos;
+    touch(g_fh[handle].node);
 
     ramfs_set_dirty();
 
     return (int)len;
 }
 
+int ramfs_lseek(int handle, int32_t off, int whence, vfs_err_t* err) {
+    if (err) *err = VFS_OK;
+    if (handle < 0 || handle >= RAMFS_MAX_FH || !g_fh[handle].used) { if (err) *err = VFS_E_INVAL; return -1; }
+    int32_t base = whence == VFS_SEEK_SET ? 0
+                 : whence == VFS_SEEK_CUR ? (int32_t)g_fh[handle].pos
+                 : (int32_t)g_nodes[g_fh[handle].node].size;
+    int32_t pos = base + off;
+    // Writes past the end are limited by RAMFS_FILE_CAP anyway
+    if (whence > VFS_SEEK_END || pos < 0 || pos > RAMFS_FILE_CAP) { if (err) *err = VFS_E_INVAL; return -1; }
+    g_fh[handle].pos = (size_t)pos;
+    return pos;
+}
+
+bool ramfs_file_gen(const char* path, int* node, uint32_t* gen, vfs_err_t* err) {
+    int parent;
+    char leaf[RAMFS_NAME_CAP];
+    if (!split_parent_leaf(path, &parent, leaf, sizeof(leaf), err)) return false;
+    int f = find_child(parent, leaf);
+    if (f < 0 || g_nodes[f].type != N_FILE) { if (err) *err = VFS_E_NOENT; return false; }
+    *node = f;
+    *gen = g_gen[f];
+    return true;
+}
+
 // ---- directory listing ----
 
 bool ramfs_list_dir(const char* path_or_null, int idx, ramfs_dirent_t* out, vfs_err_t* err) {
@@ -426,6 +461,23 @@ bool ramfs_list_dir(const char* path_or_null, int idx, ramfs_dirent_t* out, vfs_
     return true;
 }
 
+bool ramfs_stat(const char* path, ramfs_dirent_t* out, vfs_err_t* err) {
+    if (err) *err = VFS_OK;
+    int parent;
+    char leaf[RAMFS_NAME_CAP];
+    int n = -1;
+    if (split_parent_leaf(path, &parent, leaf, sizeof(leaf), NULL)) n = find_child(parent, leaf);
+    if (n < 0) n = walk_dir(path, NULL);   // ".", "..", "A:\" and friends
+    if (n < 0) { if (err) *err = VFS_E_NOENT; return false; }
+
+    out->used = true;
+    out->is_dir = g_nodes[n].type == N_DIR;
+    strncpy(out->name, g_nodes[n].name, sizeof(out->name)-1);
+    out->name[sizeof(out->name)-1] = '\0';
+    out->size = out->is_dir ? 0 : g_nodes[n].size;
+    return true;
+}
+
 // ---- serialization / deserialization ----
 // Fixed-size image (simple and robust for Flash)
 // NOTE: If RAMFS_MAX_NODES/RAMFS_FILE_CAP change, bump the version (breaks compatibility).
@@ -439,39 +491,90 @@ typedef struct {
     node_t  nodes[RAMFS_MAX_NODES];
 } ramfs_image_t;
 
+size_t ramfs_image_size(void) { return sizeof(ramfs_image_t); }
+
+size_t ramfs_ram_bytes(void) { return sizeof(g_nodes) + sizeof(g_fh) + sizeof(g_gen); }
+
+// The header fields and node table are copied straight between the image
+// and g_nodes: no ramfs_image_t on the stack (17 KB) and one copy, not two
+#define IMG_OFF(f) offsetof(ramfs_image_t, f)
+static void put32(uint8_t* out, size_t off, uint32_t v) { memcpy(out + off, &v, 4); }
+static uint32_t get32(const uint8_t* in, size_t off) { uint32_t v; memcpy(&v, in + off, 4); return v; }
+
 size_t ramfs_serialize(uint8_t *out, size_t cap) {
-    ramfs_image_t img;
-    img.magic = RAMFS_IMG_MAGIC;
-    img.version = 2;
-    img.root = g_root;
-    img.cwd  = g_cwd;
-    img.node_count = RAMFS_MAX_NODES;
-    memcpy(img.nodes, g_nodes, sizeof(g_nodes));
-
-    if (cap < sizeof(img)) return 0;
-    memcpy(out, &img, sizeof(img));
-    return sizeof(img);
+    if (cap < sizeof(ramfs_image_t)) return 0;
+    memset(out, 0, IMG_OFF(nodes));
+    put32(out, IMG_OFF(magic), RAMFS_IMG_MAGIC);
+    put32(out, IMG_OFF(version), 2);
+    put32(out, IMG_OFF(root), (uint32_t)g_root);
+    put32(out, IMG_OFF(cwd), (uint32_t)g_cwd);
+    put32(out, IMG_OFF(node_count), RAMFS_MAX_NODES);
+    memcpy(out + IMG_OFF(nodes), g_nodes, sizeof(g_nodes));
+    return sizeof(ramfs_image_t);
+}
+
+// Node fields straight from the image (it may sit at any alignment in flash)
+#define NODE_AT(in, i) ((in) + IMG_OFF(nodes) + (size_t)(i) * sizeof(node_t))
+#define NODE_GET(in, i, f, dst) memcpy(&(dst), NODE_AT(in, i) + offsetof(node_t, f), sizeof(dst))
+
+static bool link_ok(int n) { return n >= -1 && n < RAMFS_MAX_NODES; }
+
+// Structural checks before anything is copied, so a corrupt image whose CRC
+// has not been checked yet (flash_fs_load_lazy) cannot send reads or walks
+// out of bounds: indices in range and pointing at used nodes, file sizes
+// within RAMFS_FILE_CAP, names terminated, each directory's child list
+// finite and pointing back at it.
+static bool image_ok(const uint8_t* in, int root) {
+    if (root < 0 || root >= RAMFS_MAX_NODES) return false;
+    bool used[RAMFS_MAX_NODES];
+    ntype_t type[RAMFS_MAX_NODES];
+    int parent[RAMFS_MAX_NODES], child[RAMFS_MAX_NODES], sib[RAMFS_MAX_NODES];
+    for (int i=0;i<RAMFS_MAX_NODES;i++) {
+        NODE_GET(in, i, used, used[i]);
+        if (!used[i]) continue;
+        size_t size;
+        char name[RAMFS_NAME_CAP];
+        NODE_GET(in, i, type, type[i]);
+        NODE_GET(in, i, parent, parent[i]);
+        NODE_GET(in, i, first_child, child[i]);
+        NODE_GET(in, i, next_sibling, sib[i]);
+        NODE_GET(in, i, size, size);
+        NODE_GET(in, i, name, name);
+        if (type[i] != N_DIR && type[i] != N_FILE) return false;
+        if (!link_ok(parent[i]) || !link_ok(child[i]) || !link_ok(sib[i])) return false;
+        if (type[i] == N_FILE && (size > RAMFS_FILE_CAP || child[i] != -1)) return false;
+        if (!memchr(name, 0, sizeof(name))) return false;
+    }
+    if (!used[root] || type[root] != N_DIR || parent[root] != -1) return false;
+    for (int i=0;i<RAMFS_MAX_NODES;i++) {
+        if (!used[i]) continue;
+        if (i != root && (parent[i] < 0 || !used[parent[i]] || type[parent[i]] != N_DIR)) return false;
+        if (type[i] != N_DIR) continue;
+        int steps = 0;
+        for (int c = child[i]; c != -1; c = sib[c]) {
+            if (!used[c] || parent[c] != i || ++steps > RAMFS_MAX_NODES) return false;
+        }
+    }
+    return true;
 }
 
 bool ramfs_deserialize(const uint8_t *in, size_t len) {
     if (len != sizeof(ramfs_image_t)) return false;
-    ramfs_image_t img;
-    memcpy(&img, in, sizeof(img));
-    if (img.magic != RAMFS_IMG_MAGIC) return false;
-    if (img.version != 2) return false;
-    if (img.node_count != RAMFS_MAX_NODES) return false;
+    if (get32(in, IMG_OFF(magic)) != RAMFS_IMG_MAGIC) return false;
+    if (get32(in, IMG_OFF(version)) != 2) return false;
+    if (get32(in, IMG_OFF(node_count)) != RAMFS_MAX_NODES) return false;
+    const int root = (int)get32(in, IMG_OFF(root));
+    if (!image_ok(in, root)) return false;
 
-    memcpy(g_nodes, img.nodes, sizeof(g_nodes));
-    g_root = img.root;
-    g_cwd  = img.cwd;
+    memcpy(g_nodes, in + IMG_OFF(nodes), sizeof(g_nodes));
+    g_root = root;
+    g_cwd  = (int)get32(in, IMG_OFF(cwd));
 
     // File handle table isn't persisted; always reinitialize
     memset(g_fh, 0, sizeof(g_fh));
+    for (int i=0;i<RAMFS_MAX_NODES;i++) touch(i);
 
-    // Minimal consistency checks
-    if (g_root < 0 || g_root >= RAMFS_MAX_NODES) return false;
-    if (!g_nodes[g_root].used || g_nodes[g_root].type != N_DIR) return false;
-    if (g_cwd < 0 || g_cwd >= RAMFS_MAX_NODES || !g_nodes[g_cwd].used) g_cwd = g_root;
+    if (g_cwd < 0 || g_cwd >= RAMFS_MAX_NODES || !g_nodes[g_cwd].used || g_nodes[g_cwd].type != N_DIR) g_cwd = g_root;
 
     // Not dirty immediately after restore
     g_dirty = false;
@@ -20,7 +20,10 @@ int  ramfs_open(const char* path, int mode, vfs_err_t* err);
 int  ramfs_close(int handle);
 int  ramfs_read(int handle, void* buf, size_t len, vfs_err_t* err);
 int  ramfs_write(int handle, const void* buf, size_t len, vfs_err_t* err);
+int  ramfs_lseek(int handle, int32_t off, int whence, vfs_err_t* err);
 bool ramfs_delete(const char* path, vfs_err_t* err);
+// File identity + change generation (bumped on create/write/truncate/delete)
+bool ramfs_file_gen(const char* path, int* node, uint32_t* gen, vfs_err_t* err);
 
 // For DIR display: enumerate specified directory (cwd if NULL)
 typedef struct {
@@ -31,7 +34,11 @@ typedef struct {
 } ramfs_dirent_t;
 
 bool ramfs_list_dir(const char* path_or_null, int idx, ramfs_dirent_t* out, vfs_err_t* err);
+// File or directory by path (name is the last component)
+bool ramfs_stat(const char* path, ramfs_dirent_t* out, vfs_err_t* err);
 
+size_t ramfs_image_size(void);   // bytes ramfs_serialize() needs
+size_t ramfs_ram_bytes(void);    // node + handle tables, file data included (MEM)
 size_t ramfs_serialize(uint8_t *out, size_t cap);
 bool   ramfs_deserialize(const uint8_t *in, size_t len);
 
@@ -0,0 +1,26 @@
+// hal_flash.h: the QSPI flash holding the FS slots and the PXE XIP window
+//
+// Board: hal_flash_pico.c (pico_sdk flash_range_* under flash_safe_execute).
+// Host (PICODOS_HOST): host/hal_flash_host.c, an mmap'd file with NOR
+// semantics - erase sets 0xFF, programming can only clear bits.
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef PICODOS_HOST
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2u * 1024u * 1024u)
+#endif
+#else
+#include "pico/stdlib.h"   // PICO_FLASH_SIZE_BYTES from the board header
+#endif
+
+#define HAL_FLASH_SECTOR 4096u   // erase unit
+#define HAL_FLASH_PAGE   256u    // program unit
+
+// Read view of flash at off (the XIP window on the board)
+const uint8_t* hal_flash_map(uint32_t off);
+// Erase the sectors covering [off, off+len) and program src over them;
+// off and len must be whole sectors
+bool hal_flash_write(uint32_t off, const uint8_t* src, size_t len);
@@ -0,0 +1,49 @@
+// hal_flash_pico.c: hal_flash.h on the RP2040
+#include "hal/hal_flash.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include "pico/stdlib.h"
+#include "os/trace.h"
+#include "os/stats.h"
+
+typedef struct {
+    uint32_t offset;
+    const uint8_t *src;
+    size_t len;     // whole sectors
+} prog_args_t;
+
+// Run from RAM since XIP halts during flash writes. Erase and program are
+// separate safe sections so the trace (in flash) can stamp each of them.
+static void __not_in_flash_func(do_erase)(void *p) {
+    prog_args_t *a = (prog_args_t*)p;
+    // Erase the whole range (4KB sectors)
+    flash_range_erase(a->offset, a->len);
+}
+
+static void __not_in_flash_func(do_prog)(void *p) {
+    prog_args_t *a = (prog_args_t*)p;
+    // Program in 256B pages
+    for (size_t i = 0; i < a->len; i += FLASH_PAGE_SIZE) {
+        flash_range_program(a->offset + (uint32_t)i, a->src + i, FLASH_PAGE_SIZE);
+    }
+}
+
+const uint8_t* hal_flash_map(uint32_t off) {
+    return (const uint8_t*)(XIP_BASE + off);
+}
+
+bool hal_flash_write(uint32_t off, const uint8_t* src, size_t len) {
+    if ((off % FLASH_SECTOR_SIZE) || (len % FLASH_SECTOR_SIZE)) return false;
+    if (off + len > PICO_FLASH_SIZE_BYTES) return false;
+    prog_args_t args = { .offset = off, .src = src, .len = len };
+    // Execute safely with IRQ/multicore coordination
+    stats_flash((uint32_t)(len / FLASH_SECTOR_SIZE), (uint32_t)(len / FLASH_PAGE_SIZE));
+    TRACE(TR_FLASH_ERASE_BEGIN, off, len);
+    bool ok = flash_safe_execute(do_erase, &args, 2000) == PICO_OK;
+    TRACE(TR_FLASH_ERASE_END, off, ok);
+    if (!ok) return false;
+    TRACE(TR_FLASH_PROG_BEGIN, off, len);
+    ok = flash_safe_execute(do_prog, &args, 2000) == PICO_OK;
+    TRACE(TR_FLASH_PROG_END, off, ok);
+    return ok;
+}
@@ -3,18 +3,36 @@
 #include "vfs/vfs.h"
 #include "fs/ramfs.h"
 #include "fs/flash_fs.h"
+#include "os/syscall.h"
+#include "os/job.h"
+#include "os/boot.h"
+#include "os/mem.h"
 
 int main(void) {
+    mem_paint_stacks();
+    boot_mark(BOOT_MAIN);
+    boot_set_fast(PICODOS_FAST_BOOT);
+#ifdef PICODOS_BOOT_BUDGET_US
+    boot_set_budget_us(PICODOS_BOOT_BUDGET_US);
+#endif
     stdio_init_all();
+    boot_mark(BOOT_STDIO);
 
     vfs_init();
+    boot_mark(BOOT_VFS);
 
     ramfs_init();      // Provide A: drive in RAM
-    if (!flash_fs_load()) {
+    boot_mark(BOOT_RAMFS);
+    if (!boot_load_fs()) {
         // On first run or corruption, keep initial RAMFS
     }
+    boot_mark(BOOT_FLASH);
 
+    syscall_init();    // App memory ranges for syscall pointer checks
+    job_init();        // Core 1 jobs are served from the console idle loop
+    boot_mark(BOOT_OS);
     dos_init();        // Register shell/apps, etc.
+    boot_mark(BOOT_DOS);
 
     dos_println("PicoDOS (educational) 0.1");
     dos_println("Type HELP.");
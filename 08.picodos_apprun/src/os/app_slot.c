@@ -0,0 +1,74 @@
+// app_slot.c: first-fit allocator for resident app images
+#include "os/app_slot.h"
+#include "os/stats.h"
+#include <string.h>
+
+static app_slot_t g_slot[APP_SLOT_MAX];
+
+#ifdef PICODOS_HOST
+uint8_t g_app_arena[APP_SLOT_BYTES] __attribute__((aligned(8)));
+#endif
+
+static bool in_use(const uint8_t* p, uint32_t n) {
+    for (int i=0;i<APP_SLOT_MAX;i++) {
+        const app_slot_t* s = &g_slot[i];
+        if (s->base && p < s->base + s->size && s->base < p + n) return true;
+    }
+    return false;
+}
+
+static bool fits(const uint8_t* p, uint32_t n) {
+    return p >= APP_SLOT0_BASE && p + n <= APP_SLOT0_BASE + APP_SLOT_BYTES && !in_use(p, n);
+}
+
+static app_slot_t* free_entry(void) {
+    for (int i=0;i<APP_SLOT_MAX;i++) if (!g_slot[i].base) return &g_slot[i];
+    return NULL;
+}
+
+static void note_usage(void) {
+    uint32_t used = 0;
+    for (int i=0;i<APP_SLOT_MAX;i++) if (g_slot[i].base) used += g_slot[i].size;
+    stats_slots(used);
+}
+
+static uint8_t* take(app_slot_t* s, uint8_t* base, uint32_t size, const char* name) {
+    s->base = base;
+    s->size = size;
+    strncpy(s->name, name ? name : "", sizeof(s->name)-1);
+    s->name[sizeof(s->name)-1] = '\0';
+    note_usage();
+    return base;
+}
+
+uint8_t* app_slot_alloc(uint32_t size, const char* name) {
+    app_slot_t* s = free_entry();
+    if (!s || size == 0) return NULL;
+    size = (size + APP_SLOT_ALIGN - 1) & ~(APP_SLOT_ALIGN - 1);
+
+    // A gap starts either at the arena base or right after a used block
+    uint8_t* best = fits(APP_SLOT0_BASE, size) ? APP_SLOT0_BASE : NULL;
+    for (int i=0;i<APP_SLOT_MAX;i++) {
+        if (!g_slot[i].base) continue;
+        uint8_t* p = g_slot[i].base + g_slot[i].size;
+        if (fits(p, size) && (!best || p < best)) best = p;
+    }
+    return best ? take(s, best, size, name) : NULL;
+}
+
+uint8_t* app_slot_alloc_at(uint8_t* base, uint32_t size, const char* name) {
+    app_slot_t* s = free_entry();
+    if (!s || size == 0) return NULL;
+    size = (size + APP_SLOT_ALIGN - 1) & ~(APP_SLOT_ALIGN - 1);
+    return fits(base, size) ? take(s, base, size, name) : NULL;
+}
+
+void app_slot_free(uint8_t* base) {
+    for (int i=0;i<APP_SLOT_MAX;i++) {
+        if (g_slot[i].base == base) { g_slot[i].base = NULL; note_usage(); return; }
+    }
+}
+
+const app_slot_t* app_slot_get(int i) {
+    return (i >= 0 && i < APP_SLOT_MAX) ? &g_slot[i] : NULL;
+}
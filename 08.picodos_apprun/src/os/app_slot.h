@@ -1,4 +1,34 @@
 // app_slot.h
 #pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef PICODOS_HOST
+extern uint8_t g_app_arena[];   // host builds: plain memory (os/app_slot.c)
+#define APP_SLOT0_BASE   g_app_arena
+#else
 #define APP_SLOT0_BASE   ((uint8_t*)0x20020000u)
+#endif
 #define APP_SLOT_BYTES   (64u * 1024u)
+
+// Flash window for PXE_F_XIP images: the 64 KB just below the FS slots
+// (flash_fs.c). src/apps/app_xip.ld links .text at XIP_BASE + APP_XIP_OFFSET.
+#define APP_XIP_BYTES    (64u * 1024u)
+#define APP_XIP_OFFSET   (PICO_FLASH_SIZE_BYTES - 64u * 1024u - APP_XIP_BYTES)
+
+// ---- Slot allocator over the app arena (APP_SLOT0_BASE, APP_SLOT_BYTES) ----
+// Relocatable (PXE v2) images go wherever the first gap fits; fixed images
+// ask for their link address with app_slot_alloc_at().
+#define APP_SLOT_MAX     4
+#define APP_SLOT_ALIGN   8u
+
+typedef struct {
+    uint8_t* base;    // NULL = unused entry
+    uint32_t size;
+    char     name[13];
+} app_slot_t;
+
+uint8_t* app_slot_alloc(uint32_t size, const char* name);
+uint8_t* app_slot_alloc_at(uint8_t* base, uint32_t size, const char* name);
+void     app_slot_free(uint8_t* base);
+const app_slot_t* app_slot_get(int i);   // NULL past the last entry
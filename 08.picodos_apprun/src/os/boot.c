@@ -0,0 +1,82 @@
+// boot.c: where the time between reset and the first prompt goes
+//
+// main() stamps each phase with dos_time_us() (time since reset on the
+// board). With fast boot, flash_fs_load_lazy() picks the newest slot by its
+// header alone and the CRC over it runs once the prompt is up; if it fails
+// the RAM disk is reloaded with the full check, which falls back to the
+// other slot. AUTOEXEC "DEFER <cmd>" lines run at the same point.
+#include "os/boot.h"
+#include "fs/flash_fs.h"
+#include "fs/ramfs.h"
+#include "dos/autoexec.h"
+#include "dos/dos.h"
+#include "dos/dos_sys.h"
+
+static const char* const g_name[BOOT_PHASES] = {
+    "main", "stdio", "vfs", "ramfs", "flash load", "os", "dos", "autoexec", "prompt", "deferred",
+};
+
+static uint64_t g_t[BOOT_PHASES];
+static bool g_fast;
+static uint32_t g_budget_us;
+static bool g_booted;
+static enum { FS_NONE, FS_CHECKED, FS_LAZY_OK, FS_LAZY_BAD } g_fs;
+
+void boot_mark(boot_phase_t p) { g_t[p] = dos_time_us(); }
+void boot_set_fast(bool on) { g_fast = on; }
+bool boot_fast(void) { return g_fast; }
+void boot_set_budget_us(uint32_t us) { g_budget_us = us; }
+
+bool boot_load_fs(void) {
+    bool ok = g_fast ? flash_fs_load_lazy() : flash_fs_load();
+    g_fs = !ok ? FS_NONE : g_fast ? FS_LAZY_OK : FS_CHECKED;
+    return ok;
+}
+
+bool boot_prompt(void) {
+    if (g_booted) return false;
+    g_booted = true;
+    boot_mark(BOOT_PROMPT);
+
+    bool printed = false;
+    uint32_t us = (uint32_t)(g_t[BOOT_PROMPT] - g_t[BOOT_MAIN]);
+    if (g_budget_us && us > g_budget_us) {
+        dos_printf("\r\nBoot over budget: first prompt after %lu us (budget %lu us)\r\n",
+            (unsigned long)us, (unsigned long)g_budget_us);
+        printed = true;
+    }
+
+    if (g_fs == FS_LAZY_OK && !flash_fs_verify()) {
+        g_fs = FS_LAZY_BAD;
+        dos_puts("\r\nFlash image CRC mismatch, reloading.\r\n");
+        if (!flash_fs_load()) ramfs_init();
+        printed = true;
+    }
+    if (dos_run_autoexec_deferred()) printed = true;
+    boot_mark(BOOT_DEFERRED);
+    return printed;
+}
+
+void boot_print(void) {
+    dos_printf("Boot (%s):\r\n", g_fast ? "fast" : "normal");
+    dos_printf("  %-12s %10s %10s\r\n", "phase", "at us", "took us");
+    uint64_t prev = g_t[BOOT_MAIN];
+    for (int i=0;i<BOOT_PHASES;i++) {
+        if (!g_t[i]) continue;
+#ifdef PICODOS_HOST
+        // Host clock does not start at reset: count from main()
+        uint64_t at = g_t[i] - g_t[BOOT_MAIN];
+#else
+        uint64_t at = g_t[i];
+#endif
+        dos_printf("  %-12s %10lu %10lu\r\n", g_name[i], (unsigned long)at, (unsigned long)(g_t[i] - prev));
+        prev = g_t[i];
+    }
+    if (g_t[BOOT_PROMPT]) {
+        dos_printf("First prompt %lu us after main()", (unsigned long)(g_t[BOOT_PROMPT] - g_t[BOOT_MAIN]));
+        if (g_budget_us) dos_printf(" (budget %lu us)", (unsigned long)g_budget_us);
+        dos_puts("\r\n");
+    }
+    static const char* const fs[] = { "not loaded", "CRC checked before load", "lazy CRC ok", "lazy CRC failed, reloaded" };
+    dos_printf("Flash image: %s\r\n", fs[g_fs]);
+}
@@ -0,0 +1,38 @@
+// boot.h: boot phase timestamps (BOOTSTAT) and the fast-boot path
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Off by default; the board build sets it from the PICODOS_FAST_BOOT option
+#ifndef PICODOS_FAST_BOOT
+#define PICODOS_FAST_BOOT 0
+#endif
+
+// In boot order; boot_mark(p) stamps the end of phase p
+typedef enum {
+    BOOT_MAIN = 0,     // main() entered
+    BOOT_STDIO,
+    BOOT_VFS,
+    BOOT_RAMFS,
+    BOOT_FLASH,        // RAM disk loaded from flash
+    BOOT_OS,           // syscalls, core 1 jobs
+    BOOT_DOS,
+    BOOT_AUTOEXEC,
+    BOOT_PROMPT,       // first prompt printed
+    BOOT_DEFERRED,     // lazy flash check + DEFER lines done
+    BOOT_PHASES
+} boot_phase_t;
+
+void boot_mark(boot_phase_t p);
+// Fast boot: the flash slot is CRC-checked after the first prompt instead
+// of before the load, and AUTOEXEC lines starting with DEFER run then too
+void boot_set_fast(bool on);
+bool boot_fast(void);
+// First prompt later than this after main() prints a warning (0 = none)
+void boot_set_budget_us(uint32_t us);
+
+bool boot_load_fs(void);        // flash_fs_load, or the lazy variant
+// Called by the shell at every prompt; the first one finishes the boot.
+// true if that printed something (the prompt needs repeating)
+bool boot_prompt(void);
+void boot_print(void);          // BOOTSTAT
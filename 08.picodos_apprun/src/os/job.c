@@ -0,0 +1,174 @@
+// job.c: START / JOBS / WAIT / KILL - a PXE app on core 1
+//
+// The image is loaded on core 0 with pxe_load into a slot of its own (not
+// the resident cache, so RUN can never evict it) and entered on core 1,
+// launched through the multicore FIFO. The job's syscalls do not run on
+// core 1: the SVC handler parks them in a one-entry mailbox and core 0 runs
+// them from its idle hook (the shell waiting for a key, WAIT, dos_yield), so
+// the VFS, ramfs and console only ever see one core. The mailbox is plain
+// shared memory with SEV/WFE rather than the SIO FIFO, which
+// flash_safe_execute's lockout already uses.
+//
+// time / sleep / yield are answered on core 1 without a round trip. A
+// background job has no console input: getchar returns -1 at once.
+#include "os/job.h"
+#include "os/syscall.h"
+#include "os/app_slot.h"
+#include "pxe/pxe_loader.h"
+#include "dos/dos.h"
+#include "dos/dos_sys.h"
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include "hardware/regs/addressmap.h"
+#include "hardware/regs/m0plus.h"
+#include <string.h>
+
+#define JOB_ARGV_MAX   8
+#define JOB_ARGS_BYTES 128
+
+static job_info_t  g_info;
+static pxe_image_t g_img;
+static int   g_argc;
+static char* g_argv[JOB_ARGV_MAX + 1];
+static char  g_args[JOB_ARGS_BYTES];
+static volatile bool g_returned;   // set by core 1 after app_entry returns
+static volatile int  g_rc;
+
+// Core 1 -> core 0 syscall mailbox
+static struct {
+    uint32_t no, a[4];
+    int32_t  ret;
+    volatile bool full;   // request posted (core 1), cleared when served (core 0)
+} g_mb;
+
+static bool copy_args(int argc, char** argv) {
+    size_t used = 0;
+    if (argc > JOB_ARGV_MAX) return false;
+    for (int i=0;i<argc;i++) {
+        size_t n = strlen(argv[i]) + 1;
+        if (used + n > sizeof(g_args)) return false;
+        memcpy(g_args + used, argv[i], n);
+        g_argv[i] = g_args + used;
+        used += n;
+    }
+    g_argv[argc] = NULL;
+    g_argc = argc;
+    return true;
+}
+
+static void job_core1(void) {
+    // Let flash_safe_execute park this core, and keep SVC below the
+    // lockout IRQ so a job waiting in the mailbox can still be parked
+    multicore_lockout_victim_init();
+    *(io_rw_32*)(PPB_BASE + M0PLUS_SHPR2_OFFSET) = 3u << 30;
+
+    g_rc = pxe_start(&g_img, g_argc, g_argv);
+    __dmb();
+    g_returned = true;
+    __sev();
+    while (1) __wfe();
+}
+
+// Core 0, job gone: give back its slot and rings
+static void reap(job_state_t how) {
+    pxe_unload(&g_img);
+    g_sys_owner = SYS_OWNER_JOB;
+    sys_ring_release();
+    g_sys_owner = SYS_OWNER_FG;
+    g_mb.full = false;
+    g_info.rc = how == JOB_EXITED ? g_rc : -1;
+    g_info.end_us = dos_time_us();
+    g_info.state = how;
+}
+
+void job_poll(void) {
+    static bool busy;
+    if (busy) return;          // a served call may itself wait (and idle)
+    busy = true;
+
+    if (g_mb.full) {
+        __dmb();
+        g_sys_owner = SYS_OWNER_JOB;
+        g_mb.ret = g_mb.no == SYS_exit ? 0 : syscall_dispatch(g_mb.no, g_mb.a[0], g_mb.a[1], g_mb.a[2], g_mb.a[3]);
+        g_sys_owner = SYS_OWNER_FG;
+        g_info.calls++;
+        __dmb();
+        g_mb.full = false;
+        __sev();
+    }
+    sys_ring_poll();
+    if (g_info.state == JOB_RUNNING && g_returned) reap(JOB_EXITED);
+
+    busy = false;
+}
+
+int32_t job_syscall(uint32_t no, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3) {
+    switch (no) {
+    case SYS_time:
+        return syscall_run(no, a0, a1, a2, a3);   // reads the timer only
+    case SYS_sleep: {
+        uint64_t end = dos_time_us() + a0;
+        while (dos_time_us() < end) tight_loop_contents();
+        return 0;
+    }
+    case SYS_yield:
+        return 0;
+    case SYS_getchar:
+        return -1;
+    }
+    g_mb.no = no;
+    g_mb.a[0] = a0; g_mb.a[1] = a1; g_mb.a[2] = a2; g_mb.a[3] = a3;
+    __dmb();
+    g_mb.full = true;
+    __sev();
+    while (g_mb.full) __wfe();
+    __dmb();
+    return g_mb.ret;
+}
+
+void job_init(void) {
+    dos_set_idle_hook(job_poll);
+}
+
+bool job_active(void) {
+    return g_info.state == JOB_RUNNING;
+}
+
+const job_info_t* job_info(void) {
+    return &g_info;
+}
+
+bool job_start(const char* path, int argc, char** argv) {
+    if (job_active()) { dos_puts("A job is already running\r\n"); return false; }
+    if (!copy_args(argc, argv)) { dos_puts("Too many arguments\r\n"); return false; }
+    if (!pxe_load(path, &g_img)) return false;
+
+    const char* b = path;
+    for (const char* p = path; *p; p++) if (*p == '\\' || *p == '/' || *p == ':') b = p + 1;
+    memset(&g_info, 0, sizeof(g_info));
+    strncpy(g_info.name, b, sizeof(g_info.name) - 1);
+    g_info.start_us = dos_time_us();
+    g_info.state = JOB_RUNNING;
+    g_returned = false;
+    g_mb.full = false;
+
+    multicore_reset_core1();
+    multicore_launch_core1(job_core1);
+    return true;
+}
+
+bool job_wait(void) {
+    while (job_active()) {
+        job_poll();
+        if (dos_getc_nowait() == 3) return false;   // Ctrl-C stops waiting, not the job
+    }
+    return true;
+}
+
+bool job_kill(void) {
+    if (!job_active()) return false;
+    multicore_reset_core1();   // whatever it was doing, including a parked call
+    reap(JOB_KILLED);
+    return true;
+}
@@ -0,0 +1,32 @@
+// job.h: one PXE app running on core 1 while the shell keeps core 0
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    JOB_NONE = 0,
+    JOB_RUNNING,
+    JOB_EXITED,     // returned from app_entry; rc is valid
+    JOB_KILLED,
+} job_state_t;
+
+typedef struct {
+    job_state_t state;
+    char     name[13];
+    int      rc;
+    uint64_t start_us;
+    uint64_t end_us;      // 0 while running
+    uint32_t calls;       // syscalls core 0 ran on the job's behalf
+} job_info_t;
+
+void job_init(void);                               // hooks job_poll into the idle loop
+bool job_start(const char* path, int argc, char** argv);
+bool job_active(void);                             // core 1 is taken by a job
+bool job_wait(void);                               // false if interrupted with Ctrl-C
+bool job_kill(void);
+const job_info_t* job_info(void);
+
+// Core 0: run the job's pending syscall (if any) and drain app rings
+void job_poll(void);
+// Core 1: a syscall from the job, answered by core 0
+int32_t job_syscall(uint32_t no, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
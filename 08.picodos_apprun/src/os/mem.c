@@ -0,0 +1,116 @@
+// mem.c: MEM - linker sections, static buffers, stack depth, app arena
+//
+// Section bounds come from the pico SDK linker script symbols. Stacks are
+// painted at boot and scanned from the bottom for the first changed word,
+// which is the deepest the core has been (PXE apps included: RUN uses the
+// shell's stack). The app arena sits at a fixed address in main SRAM, not
+// in the linker's view, so MEM also checks .bss and the heap stay below it.
+#include "os/mem.h"
+#include "os/app_slot.h"
+#include "os/stats.h"
+#include "os/trace.h"
+#include "dos/dos.h"
+#include "dos/dos_sys.h"
+#include "fs/ramfs.h"
+#include "fs/flash_fs.h"
+#include "fs/fs_bench.h"
+#include "pxe/pxe_loader.h"
+#include "xfer/xfer_pipe.h"
+#include "xfer/xfer_recv.h"
+#include "xfer/xfer_send.h"
+#include "xfer/xfer_session.h"
+
+#define MEM_PAINT 0xC0DEC0DEu
+
+#ifndef PICODOS_HOST
+#include <malloc.h>
+
+extern char __flash_binary_start, __flash_binary_end;
+extern char __data_start__, __data_end__, __bss_start__, __bss_end__;
+extern char __end__, __HeapLimit;
+extern char __StackBottom, __StackTop, __StackOneBottom, __StackOneTop;
+
+void mem_paint_stacks(void) {
+    // Core 0 is running on this stack: stop well short of the live frames
+    // (no calls in here, so nothing lands below them while painting)
+    uint32_t here;
+    for (uint32_t* p = (uint32_t*)&__StackBottom; p < &here - 64; p++) *p = MEM_PAINT;
+    // Core 1 has not been launched yet
+    for (uint32_t* p = (uint32_t*)&__StackOneBottom; p < (uint32_t*)&__StackOneTop; p++) *p = MEM_PAINT;
+}
+
+static void print_stack(const char* name, char* lo, char* hi) {
+    const uint32_t* p = (const uint32_t*)lo;
+    while ((char*)p < hi && *p == MEM_PAINT) p++;
+    uint32_t size = (uint32_t)(hi - lo), used = (uint32_t)(hi - (char*)p);
+    dos_printf("  %-14s %6lu of %6lu B%s\r\n", name, (unsigned long)used, (unsigned long)size,
+        used == size ? "  (overflowed?)" : "");
+}
+
+static void print_sections(void) {
+    struct mallinfo mi = mallinfo();
+    char* heap_top = &__end__ + mi.arena;
+    dos_puts("Sections:\r\n");
+    dos_printf("  %-14s %6lu B\r\n", "flash image", (unsigned long)(&__flash_binary_end - &__flash_binary_start));
+    dos_printf("  %-14s %6lu B\r\n", ".data", (unsigned long)(&__data_end__ - &__data_start__));
+    dos_printf("  %-14s %6lu B\r\n", ".bss", (unsigned long)(&__bss_end__ - &__bss_start__));
+    dos_printf("  %-14s %6lu B in use, %lu B taken from %lu B\r\n", "heap",
+        (unsigned long)mi.uordblks, (unsigned long)mi.arena, (unsigned long)(&__HeapLimit - &__end__));
+    if (&__bss_end__ > (char*)APP_SLOT0_BASE || heap_top > (char*)APP_SLOT0_BASE)
+        dos_printf("  WARNING: %s reaches the app arena at %08lx\r\n",
+            &__bss_end__ > (char*)APP_SLOT0_BASE ? ".bss" : "heap", (unsigned long)(uintptr_t)APP_SLOT0_BASE);
+    else
+        dos_printf("  %-14s %6lu B between heap top and the app arena\r\n", "headroom",
+            (unsigned long)((char*)APP_SLOT0_BASE - heap_top));
+
+    dos_puts("Stacks (deepest since boot):\r\n");
+    print_stack("core 0", &__StackBottom, &__StackTop);
+    print_stack("core 1", &__StackOneBottom, &__StackOneTop);
+}
+
+static uint32_t static_total(void) {
+    return (uint32_t)((&__data_end__ - &__data_start__) + (&__bss_end__ - &__bss_start__));
+}
+#else
+void mem_paint_stacks(void) {}
+static void print_sections(void) { dos_puts("Sections / stacks: board only\r\n"); }
+#endif
+
+static uint32_t row(const char* name, size_t bytes) {
+    dos_printf("  %-14s %6lu B\r\n", name, (unsigned long)bytes);
+    return (uint32_t)bytes;
+}
+
+void mem_print(void) {
+    print_sections();
+
+    dos_puts("Static buffers:\r\n");
+    const trace_hdr_t* th = trace_header();
+    uint32_t sum = 0;
+    sum += row("ramfs", ramfs_ram_bytes());
+    sum += row("flash_fs SAVE", flash_fs_ram_bytes());
+    sum += row("xfer pipe", xfer_pipe_ram_bytes());
+    sum += row("xfer frames", xfer_recv_ram_bytes() + xfer_send_ram_bytes() + xfer_session_ram_bytes());
+    sum += row("trace ring", sizeof(*th) + (size_t)th->cores * th->entries * th->ev_bytes);
+    sum += row("fs_bench", fs_bench_ram_bytes());
+    sum += row("stats", sizeof(stats_t));
+#ifndef PICODOS_HOST
+    uint32_t all = static_total();
+    row("other", all > sum ? all - sum : 0);
+#else
+    dos_printf("  %-14s %6lu B\r\n", "listed", (unsigned long)sum);
+#endif
+
+    const stats_t* st = stats_get();
+    dos_printf("App arena %08lx, %lu B:\r\n", (unsigned long)(uintptr_t)APP_SLOT0_BASE, (unsigned long)APP_SLOT_BYTES);
+    dos_printf("  %-14s %6lu B, peak %lu B\r\n", "slots in use", (unsigned long)st->slot_used, (unsigned long)st->slot_peak);
+    const pxe_hdr_t* h = pxe_last_header();
+    if (!h) { dos_puts("  last PXE       none run yet\r\n"); return; }
+    bool xip = (h->flags & PXE_F_XIP) != 0;
+    uint32_t resident = xip ? h->data_size + h->bss_size : h->image_size + h->bss_size;
+    dos_printf("  last PXE       v%u%s image %lu B (.data %lu) + .bss %lu B, %lu relocs\r\n",
+        (unsigned)h->ver, xip ? " XIP" : "", (unsigned long)h->image_size, (unsigned long)h->data_size,
+        (unsigned long)h->bss_size, (unsigned long)(h->ver == PXE_VER2 ? h->reloc_count : 0));
+    dos_printf("  %-14s %6lu B of the slot (%lu%%)\r\n", "resident", (unsigned long)resident,
+        (unsigned long)(resident * 100u / APP_SLOT_BYTES));
+}
@@ -0,0 +1,7 @@
+// mem.h: where the SRAM goes (MEM command)
+#pragma once
+
+// Fill the free part of both core stacks with a pattern; MEM reports how
+// deep each has been used since. Call first thing in main().
+void mem_paint_stacks(void);
+void mem_print(void);
@@ -0,0 +1,61 @@
+// rt_api.c: the runtime table itself (const, so it stays in flash)
+#include "os/rt_api.h"
+#include "os/syscall.h"
+#include "xfer/xfer_proto.h"
+#include <stdio.h>
+#include <string.h>
+
+#define U(p) ((uint32_t)(uintptr_t)(p))
+
+static uint32_t api_crc(uint32_t x, const void* p, size_t n) {
+    return xfer_crc(x, (const uint8_t*)p, n);
+}
+
+// Same path as an SVC: pointers are checked, and a core 1 job is served by core 0
+static int api_open(const char* path, int flags) {
+    return syscall_from_app(SYS_open, U(path), (uint32_t)flags, 0, 0);
+}
+static int api_close(int fd) {
+    return syscall_from_app(SYS_close, (uint32_t)fd, 0, 0, 0);
+}
+static int api_read(int fd, void* buf, int len) {
+    return syscall_from_app(SYS_read, (uint32_t)fd, U(buf), (uint32_t)len, 0);
+}
+static int api_write(int fd, const void* buf, int len) {
+    return syscall_from_app(SYS_write, (uint32_t)fd, U(buf), (uint32_t)len, 0);
+}
+static int api_lseek(int fd, int off, int whence) {
+    return syscall_from_app(SYS_lseek, (uint32_t)fd, (uint32_t)off, (uint32_t)whence, 0);
+}
+static int api_stat(const char* path, sys_stat_t* st) {
+    return syscall_from_app(SYS_stat, U(path), U(st), 0, 0);
+}
+static int api_readdir(const char* path, int idx, sys_dirent_t* de) {
+    return syscall_from_app(SYS_readdir, U(path), (uint32_t)idx, U(de), 0);
+}
+
+const rt_api_t g_rt_api = {
+    .magic = RT_API_MAGIC,
+    .major = RT_API_MAJOR,
+    .minor = RT_API_MINOR,
+    .count = (sizeof(rt_api_t) - offsetof(rt_api_t, vsnprintf)) / sizeof(void*),
+
+    .vsnprintf = vsnprintf,
+    .memcpy  = memcpy,
+    .memmove = memmove,
+    .memset  = memset,
+    .memcmp  = memcmp,
+    .strlen  = strlen,
+    .strcmp  = strcmp,
+    .strncmp = strncmp,
+    .strcpy  = strcpy,
+    .strchr  = strchr,
+    .crc     = api_crc,
+    .open    = api_open,
+    .close   = api_close,
+    .read    = api_read,
+    .write   = api_write,
+    .lseek   = api_lseek,
+    .stat    = api_stat,
+    .readdir = api_readdir,
+};
@@ -0,0 +1,53 @@
+// rt_api.h: OS-resident runtime table handed to PXE apps
+//
+// pxe_start passes &g_rt_api as the third argument of app_entry (r2). Apps
+// linked against pxe_rt_shared call through it instead of carrying their own
+// formatter and mem/str routines; their PXE header records the major version
+// they were built for (PXE_API_MAJOR) and the loader refuses a mismatch.
+//
+// Append new entries at the end and bump RT_API_MINOR; anything that moves
+// or changes an existing entry bumps RT_API_MAJOR.
+// Keep in sync with src/apps/rt/rt_api.h
+#pragma once
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "os/syscall.h"
+
+#define RT_API_MAGIC 0x42415452u   // 'RTAB'
+#define RT_API_MAJOR 1
+#define RT_API_MINOR 0
+
+typedef struct {
+    uint32_t magic;
+    uint16_t major;
+    uint16_t minor;
+    uint32_t count;      // function entries that follow
+
+    // formatting
+    int    (*vsnprintf)(char* buf, size_t n, const char* fmt, va_list ap);
+    // memory / strings
+    void*  (*memcpy)(void* dst, const void* src, size_t n);
+    void*  (*memmove)(void* dst, const void* src, size_t n);
+    void*  (*memset)(void* dst, int c, size_t n);
+    int    (*memcmp)(const void* a, const void* b, size_t n);
+    size_t (*strlen)(const char* s);
+    int    (*strcmp)(const char* a, const char* b);
+    int    (*strncmp)(const char* a, const char* b, size_t n);
+    char*  (*strcpy)(char* dst, const char* src);
+    char*  (*strchr)(const char* s, int c);
+    // checksum: xfer_crc, the value RECV /S manifests list (start with RT_CRC_INIT)
+    uint32_t (*crc)(uint32_t x, const void* p, size_t n);
+    // VFS: same checks, results and fd table as the syscalls, without the trap
+    int    (*open)(const char* path, int flags);
+    int    (*close)(int fd);
+    int    (*read)(int fd, void* buf, int len);
+    int    (*write)(int fd, const void* buf, int len);
+    int    (*lseek)(int fd, int off, int whence);
+    int    (*stat)(const char* path, sys_stat_t* st);
+    int    (*readdir)(const char* path, int idx, sys_dirent_t* de);
+} rt_api_t;
+
+#define RT_CRC_INIT 0x12345678u
+
+extern const rt_api_t g_rt_api;
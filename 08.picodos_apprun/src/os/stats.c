@@ -0,0 +1,58 @@
+// stats.c: counters behind STATS / TIME
+//
+// Plain increments: nearly everything counted runs on core 0, since core 1
+// jobs hand their syscalls over (job.c). The time / sleep / yield calls a
+// job answers on core 1 can lose a count against core 0; that is all.
+#include "os/stats.h"
+
+static stats_t g_st;
+
+static const char* const g_sys_name[SYS_COUNT] = {
+    [SYS_exit] = "exit", [SYS_write] = "write", [SYS_open] = "open", [SYS_close] = "close",
+    [SYS_read] = "read", [SYS_lseek] = "lseek", [SYS_stat] = "stat", [SYS_readdir] = "readdir",
+    [SYS_getchar] = "getchar", [SYS_time] = "time", [SYS_sleep] = "sleep", [SYS_yield] = "yield",
+    [SYS_writev] = "writev", [SYS_readv] = "readv", [SYS_batch] = "batch",
+    [SYS_ring_setup] = "ring_setup", [SYS_ring_enter] = "ring_enter",
+};
+
+const stats_t* stats_get(void) { return &g_st; }
+
+const char* stats_sys_name(uint32_t no) {
+    return no < SYS_COUNT && g_sys_name[no] ? g_sys_name[no] : "?";
+}
+
+void stats_cmd(void) { g_st.cmds++; }
+
+void stats_syscall(uint32_t no) {
+    if (no < SYS_COUNT) g_st.sys[no]++;
+    g_st.sys_total++;
+}
+
+void stats_vfs_open(void) { g_st.vfs_opens++; }
+
+void stats_vfs_bytes(uint32_t rd, uint32_t wr) {
+    g_st.vfs_rd_bytes += rd;
+    g_st.vfs_wr_bytes += wr;
+}
+
+void stats_flash(uint32_t sectors, uint32_t pages) {
+    g_st.flash_writes++;
+    g_st.flash_sectors += sectors;
+    g_st.flash_pages += pages;
+}
+
+void stats_slots(uint32_t used) {
+    g_st.slot_used = used;
+    if (used > g_st.slot_peak) g_st.slot_peak = used;
+    if (used > g_st.slot_mark_peak) g_st.slot_mark_peak = used;
+}
+
+uint32_t stats_mark_slots(void) {
+    uint32_t outer = g_st.slot_mark_peak;
+    g_st.slot_mark_peak = g_st.slot_used;
+    return outer;
+}
+
+void stats_unmark_slots(uint32_t outer_peak) {
+    if (outer_peak > g_st.slot_mark_peak) g_st.slot_mark_peak = outer_peak;
+}
@@ -0,0 +1,34 @@
+// stats.h: resource counters since boot (STATS) and per command (TIME)
+#pragma once
+#include <stdint.h>
+#include "os/syscall.h"
+
+typedef struct {
+    uint32_t cmds;                 // shell / batch command lines run
+    uint32_t sys[SYS_COUNT];       // syscalls by number (batch / ring ops too)
+    uint32_t sys_total;
+    uint32_t vfs_opens;
+    uint32_t vfs_rd_bytes;
+    uint32_t vfs_wr_bytes;         // console output included
+    uint32_t flash_writes;         // hal_flash_write calls
+    uint32_t flash_sectors;        // erased
+    uint32_t flash_pages;          // programmed
+    uint32_t slot_used;            // app arena bytes allocated now
+    uint32_t slot_peak;            // ... highest since boot
+    uint32_t slot_mark_peak;       // ... highest since stats_mark_slots()
+} stats_t;
+
+const stats_t* stats_get(void);
+const char* stats_sys_name(uint32_t no);
+
+// Hooks (all on core 0)
+void stats_cmd(void);
+void stats_syscall(uint32_t no);
+void stats_vfs_open(void);
+void stats_vfs_bytes(uint32_t rd, uint32_t wr);
+void stats_flash(uint32_t sectors, uint32_t pages);
+void stats_slots(uint32_t used);
+// Start a new slot_mark_peak window (TIME); returns the enclosing window's
+// peak, which stats_unmark_slots() folds the inner one back into
+uint32_t stats_mark_slots(void);
+void stats_unmark_slots(uint32_t outer_peak);
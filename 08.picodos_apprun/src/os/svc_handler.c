@@ -1,35 +1,19 @@
 #include <stdint.h>
-#include "vfs/vfs.h"
 #include "os/syscall.h"
+#include "os/job.h"
+#include "hardware/regs/addressmap.h"
+#include "pico/stdlib.h"
 
 // Cortex-M0+ exception frame
 typedef struct {
     uint32_t r0,r1,r2,r3,r12,lr,pc,xpsr;
 } exc_frame_t;
 
-static int k_write(int fd, const void* buf, int len) {
-    vfs_err_t e;
-    if (len < 0) return -1;
-    return vfs_write(fd, buf, (size_t)len, &e);
-}
-
-static int k_open(const char* path, int flags) {
-    vfs_err_t e;
-    return vfs_open(path, flags, &e);
-}
-static int k_close(int fd) {
-    return vfs_close(fd);
-}
-
-static int syscall_dispatch(int no, int a0, int a1, int a2, int a3) {
-    (void)a3;
-    switch (no) {
-    case SYS_write: return k_write(a0, (const void*)a1, a2);
-    case SYS_open:  return k_open((const char*)a0, a1);
-    case SYS_close: return k_close(a0);
-    case SYS_exit:  return 0;
-    default: return -1;
-    }
+// Apps share the address space: their pointers may be into SRAM (slot, or
+// the shell stack they run on) or into flash (XIP images, const data)
+void syscall_init(void) {
+    syscall_map(SRAM_BASE, SRAM_END - SRAM_BASE, (void*)SRAM_BASE);
+    syscall_map(XIP_BASE, PICO_FLASH_SIZE_BYTES, (void*)XIP_BASE);
 }
 
 // Pico SDK calls into isr_svcall
@@ -40,8 +24,12 @@ __attribute__((naked)) void isr_svcall(void) {
     );
 }
 
+int32_t syscall_from_app(uint32_t no, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3) {
+    if (get_core_num() == 1) return job_syscall(no, a0, a1, a2, a3);
+    return syscall_dispatch(no, a0, a1, a2, a3);
+}
+
 void isr_svcall_c(exc_frame_t* f) {
-    int no  = (int)f->r12; // By design, syscall number is in r12
-    int ret = syscall_dispatch(no, (int)f->r0, (int)f->r1, (int)f->r2, (int)f->r3);
-    f->r0 = (uint32_t)ret;
+    // By design, syscall number is in r12
+    f->r0 = (uint32_t)syscall_from_app(f->r12, f->r0, f->r1, f->r2, f->r3);
 }
@@ -0,0 +1,89 @@
+// sys_ring.c: SQ/CQ rings in app memory, drained by the OS
+//
+// Nothing here traps: the app writes SQEs and moves sq_tail, then carries
+// on. Whatever syscall comes next (or sys_ring_poll() from a wait loop)
+// runs the queued entries and posts the results, so a burst of writes costs
+// one exception instead of one each. SYS_ring_enter is the explicit flush.
+#include "os/syscall.h"
+#include <string.h>
+
+typedef struct {
+    sys_ring_t* r;      // host view of the app's ring (NULL = free)
+    sys_sqe_t*  sq;
+    sys_cqe_t*  cq;
+    uint8_t     owner;  // SYS_OWNER_*
+} ring_ref_t;
+
+static ring_ref_t g_ring[SYS_RING_MAX];
+static bool g_polling;
+
+static void barrier(void) { __sync_synchronize(); }   // dmb on the RP2040
+
+static void drain(ring_ref_t* rr) {
+    sys_ring_t* r = rr->r;
+    const uint32_t mask = r->entries - 1;
+    while (r->sq_head != r->sq_tail) {
+        if (r->cq_tail - r->cq_head >= r->entries) { r->flags |= SYS_RING_F_CQ_FULL; return; }
+        barrier();   // read the SQE only after seeing the tail that covers it
+        sys_sqe_t e = rr->sq[r->sq_head & mask];
+
+        // exit releases this very ring, so it has to come as a real trap
+        int32_t res = (e.no == SYS_exit || e.no == SYS_batch || e.no == SYS_ring_setup ||
+                       e.no == SYS_ring_enter) ? -1
+                    : syscall_run(e.no, e.a[0], e.a[1], e.a[2], e.a[3]);
+
+        sys_cqe_t* c = &rr->cq[r->cq_tail & mask];
+        c->user = e.user;
+        c->res = res;
+        barrier();   // CQE contents before the tail that publishes it
+        r->cq_tail++;
+        r->sq_head++;
+    }
+    r->flags &= ~SYS_RING_F_CQ_FULL;
+}
+
+void sys_ring_poll(void) {
+    if (g_polling) return;   // ring entries run through syscall_run, but be safe
+    g_polling = true;
+    for (int i=0;i<SYS_RING_MAX;i++) {
+        if (g_ring[i].r && g_ring[i].r->sq_head != g_ring[i].r->sq_tail) drain(&g_ring[i]);
+    }
+    g_polling = false;
+}
+
+void sys_ring_release(void) {
+    for (int i=0;i<SYS_RING_MAX;i++) {
+        if (g_ring[i].owner == g_sys_owner) memset(&g_ring[i], 0, sizeof(g_ring[i]));
+    }
+}
+
+static ring_ref_t* find(const sys_ring_t* r) {
+    for (int i=0;i<SYS_RING_MAX;i++) if (g_ring[i].r == r) return &g_ring[i];
+    return NULL;
+}
+
+int32_t k_ring_setup(uint32_t ring, uint32_t entries, uint32_t a2, uint32_t a3) {
+    if (entries == 0 || entries > SYS_RING_ENTRIES || (entries & (entries - 1))) return -1;
+    uint32_t bytes = sizeof(sys_ring_t) + entries * (sizeof(sys_sqe_t) + sizeof(sys_cqe_t));
+    sys_ring_t* r = sys_uptr(ring, bytes);
+    if (!r) return -1;
+
+    ring_ref_t* rr = find(r);
+    if (!rr) rr = find(NULL);
+    if (!rr) return -1;
+
+    memset(r, 0, sizeof(*r));
+    r->entries = entries;
+    rr->r = r;
+    rr->sq = (sys_sqe_t*)(r + 1);
+    rr->cq = (sys_cqe_t*)(rr->sq + entries);
+    rr->owner = g_sys_owner;
+    return 0;
+}
+
+int32_t k_ring_enter(uint32_t ring, uint32_t a1, uint32_t a2, uint32_t a3) {
+    ring_ref_t* rr = find(sys_uptr(ring, sizeof(sys_ring_t)));
+    if (!rr || !rr->r) return -1;
+    sys_ring_poll();   // already ran on the way in; picks up anything racing the trap
+    return (int32_t)(rr->r->cq_tail - rr->r->cq_head);
+}
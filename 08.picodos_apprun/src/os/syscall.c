@@ -0,0 +1,218 @@
+// syscall.c: app syscall table (SVC handler and host shim both land here)
+#include "os/syscall.h"
+#include "vfs/vfs.h"
+#include "fs/ramfs.h"
+#include "dos/dos_sys.h"
+#include "os/trace.h"
+#include "os/stats.h"
+#include <string.h>
+
+#define UMAP_MAX 4
+
+typedef struct {
+    uint32_t guest;
+    uint32_t size;
+    uint8_t* host;
+} umap_t;
+
+static umap_t g_umap[UMAP_MAX];
+uint8_t g_sys_owner = SYS_OWNER_FG;
+
+bool syscall_map(uint32_t guest, uint32_t size, void* host) {
+    for (int i=0;i<UMAP_MAX;i++) {
+        if (g_umap[i].size) continue;
+        g_umap[i] = (umap_t){ guest, size, (uint8_t*)host };
+        return true;
+    }
+    return false;
+}
+
+static const umap_t* umap_find(uint32_t addr) {
+    for (int i=0;i<UMAP_MAX;i++) {
+        const umap_t* m = &g_umap[i];
+        if (m->size && addr >= m->guest && addr - m->guest < m->size) return m;
+    }
+    return NULL;
+}
+
+void* sys_uptr(uint32_t addr, uint32_t len) {
+    const umap_t* m = umap_find(addr);
+    if (!m || len > m->size - (addr - m->guest)) return NULL;
+    return m->host + (addr - m->guest);
+}
+
+const char* sys_ustr(uint32_t addr) {
+    const umap_t* m = umap_find(addr);
+    if (!m) return NULL;
+    const char* s = (const char*)m->host + (addr - m->guest);
+    return memchr(s, 0, m->size - (addr - m->guest)) ? s : NULL;
+}
+
+// ---- handlers: (a0, a1, a2, a3) -> r0 ----
+
+static int32_t k_exit(uint32_t code, uint32_t a1, uint32_t a2, uint32_t a3) {
+    sys_ring_release();
+    return 0;
+}
+
+static int32_t k_write(uint32_t fd, uint32_t buf, uint32_t len, uint32_t a3) {
+    vfs_err_t e;
+    const void* p = sys_uptr(buf, len);
+    if ((int32_t)len < 0 || (!p && len)) return -1;
+    return vfs_write((int)fd, p, len, &e);
+}
+
+static int32_t k_read(uint32_t fd, uint32_t buf, uint32_t len, uint32_t a3) {
+    vfs_err_t e;
+    void* p = sys_uptr(buf, len);
+    if ((int32_t)len < 0 || (!p && len)) return -1;
+    return vfs_read((int)fd, p, len, &e);
+}
+
+static int32_t k_open(uint32_t path, uint32_t flags, uint32_t a2, uint32_t a3) {
+    vfs_err_t e;
+    const char* s = sys_ustr(path);
+    if (!s) return -1;
+    return vfs_open(s, (int)flags, &e);
+}
+
+static int32_t k_close(uint32_t fd, uint32_t a1, uint32_t a2, uint32_t a3) {
+    return vfs_close((int)fd);
+}
+
+static int32_t k_lseek(uint32_t fd, uint32_t off, uint32_t whence, uint32_t a3) {
+    vfs_err_t e;
+    return vfs_lseek((int)fd, (int32_t)off, (int)whence, &e);
+}
+
+static int32_t k_stat(uint32_t path, uint32_t out, uint32_t a2, uint32_t a3) {
+    vfs_err_t e;
+    ramfs_dirent_t de;
+    const char* s = sys_ustr(path);
+    sys_stat_t* st = sys_uptr(out, sizeof(*st));
+    if (!s || !st || !ramfs_stat(s, &de, &e)) return -1;
+    st->size = (uint32_t)de.size;
+    st->is_dir = de.is_dir;
+    return 0;
+}
+
+static int32_t k_readdir(uint32_t path, uint32_t idx, uint32_t out, uint32_t a3) {
+    vfs_err_t e;
+    ramfs_dirent_t de;
+    const char* s = path ? sys_ustr(path) : NULL;
+    sys_dirent_t* d = sys_uptr(out, sizeof(*d));
+    if ((path && !s) || !d) return -1;
+    if (!ramfs_list_dir(s, (int)idx, &de, &e)) return -1;
+    if (!de.used) return 0;
+    memcpy(d->name, de.name, sizeof(d->name));
+    d->size = (uint32_t)de.size;
+    d->is_dir = de.is_dir;
+    return 1;
+}
+
+// Runs inside the SVC exception, so waits poll the timer instead of
+// sleeping on an alarm IRQ that could not preempt us.
+static int32_t k_getchar(uint32_t timeout_us, uint32_t a1, uint32_t a2, uint32_t a3) {
+    if ((int32_t)timeout_us < 0) return dos_getc_blocking();
+    uint64_t end = dos_time_us() + timeout_us;
+    do {
+        int c = dos_getc_nowait();
+        if (c >= 0) return c;
+        sys_ring_poll();
+        dos_yield();
+    } while (dos_time_us() < end);
+    return -1;
+}
+
+static int32_t k_time(uint32_t out, uint32_t a1, uint32_t a2, uint32_t a3) {
+    uint64_t t = dos_time_us();
+    if (out) {
+        void* p = sys_uptr(out, sizeof(t));
+        if (!p) return -1;
+        memcpy(p, &t, sizeof(t));   // app pointer need not be 8-byte aligned
+    }
+    return (int32_t)(uint32_t)t;
+}
+
+static int32_t k_sleep(uint32_t us, uint32_t a1, uint32_t a2, uint32_t a3) {
+    uint64_t end = dos_time_us() + us;
+    while (dos_time_us() < end) { sys_ring_poll(); dos_yield(); }
+    return 0;
+}
+
+static int32_t k_yield(uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3) {
+    dos_yield();
+    return 0;
+}
+
+// writev / readv: stops at the first short transfer, like POSIX
+static int32_t k_iov(bool wr, uint32_t fd, uint32_t iov, uint32_t count) {
+    vfs_err_t e;
+    const sys_iovec_t* v = sys_uptr(iov, count * sizeof(sys_iovec_t));
+    if (!v || count > SYS_IOV_MAX) return -1;
+    int32_t total = 0;
+    for (uint32_t i=0;i<count;i++) {
+        void* p = sys_uptr(v[i].base, v[i].len);
+        if (!p && v[i].len) return total ? total : -1;
+        int n = wr ? vfs_write((int)fd, p, v[i].len, &e) : vfs_read((int)fd, p, v[i].len, &e);
+        if (n < 0) return total ? total : -1;
+        total += n;
+        if ((uint32_t)n < v[i].len) break;
+    }
+    return total;
+}
+
+static int32_t k_writev(uint32_t fd, uint32_t iov, uint32_t count, uint32_t a3) {
+    return k_iov(true, fd, iov, count);
+}
+
+static int32_t k_readv(uint32_t fd, uint32_t iov, uint32_t count, uint32_t a3) {
+    return k_iov(false, fd, iov, count);
+}
+
+// Many syscalls for one trap; a failing op does not stop the rest
+static int32_t k_batch(uint32_t ops, uint32_t count, uint32_t a2, uint32_t a3) {
+    sys_op_t* op = sys_uptr(ops, count * sizeof(sys_op_t));
+    if (!op || count > SYS_BATCH_MAX) return -1;
+    for (uint32_t i=0;i<count;i++) {
+        op[i].ret = op[i].no == SYS_batch ? -1
+                  : syscall_run(op[i].no, op[i].a[0], op[i].a[1], op[i].a[2], op[i].a[3]);
+    }
+    return (int32_t)count;
+}
+
+typedef int32_t (*sys_fn_t)(uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+
+static const sys_fn_t g_sys[SYS_COUNT] = {
+    [SYS_exit]    = k_exit,
+    [SYS_write]   = k_write,
+    [SYS_open]    = k_open,
+    [SYS_close]   = k_close,
+    [SYS_read]    = k_read,
+    [SYS_lseek]   = k_lseek,
+    [SYS_stat]    = k_stat,
+    [SYS_readdir] = k_readdir,
+    [SYS_getchar] = k_getchar,
+    [SYS_time]    = k_time,
+    [SYS_sleep]   = k_sleep,
+    [SYS_yield]   = k_yield,
+    [SYS_writev]  = k_writev,
+    [SYS_readv]   = k_readv,
+    [SYS_batch]   = k_batch,
+    [SYS_ring_setup] = k_ring_setup,
+    [SYS_ring_enter] = k_ring_enter,
+};
+
+int32_t syscall_run(uint32_t no, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3) {
+    if (no >= SYS_COUNT || !g_sys[no]) return -1;
+    stats_syscall(no);
+    TRACE(TR_SYS_BEGIN, no, a0);
+    int32_t r = g_sys[no](a0, a1, a2, a3);
+    TRACE(TR_SYS_END, no, r);
+    return r;
+}
+
+int32_t syscall_dispatch(uint32_t no, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3) {
+    sys_ring_poll();
+    return syscall_run(no, a0, a1, a2, a3);
+}
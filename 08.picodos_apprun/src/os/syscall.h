@@ -1,7 +1,106 @@
 #pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Keep in sync with src/apps/app_sys.h
 enum {
-  SYS_exit  = 1,
-  SYS_write = 2,
-  SYS_open  = 3,
-  SYS_close = 4,
-};
\ No newline at end of file
+  SYS_exit    = 1,
+  SYS_write   = 2,   // (fd, buf, len)
+  SYS_open    = 3,   // (path, VFS_O_* flags)
+  SYS_close   = 4,   // (fd)
+  SYS_read    = 5,   // (fd, buf, len)
+  SYS_lseek   = 6,   // (fd, off, whence) -> new position
+  SYS_stat    = 7,   // (path, sys_stat_t*)
+  SYS_readdir = 8,   // (dir path or 0 = cwd, index, sys_dirent_t*) -> 1 entry, 0 end
+  SYS_getchar = 9,   // (timeout_us, -1 = wait forever) -> char, -1 on timeout
+  SYS_time    = 10,  // (uint64_t* us or 0) -> low 32 bits of us since boot
+  SYS_sleep   = 11,  // (us)
+  SYS_yield   = 12,
+  SYS_writev  = 13,  // (fd, sys_iovec_t*, count) -> bytes
+  SYS_readv   = 14,  // (fd, sys_iovec_t*, count) -> bytes
+  SYS_batch   = 15,  // (sys_op_t*, count) -> ops run; each op gets its own result
+  SYS_ring_setup = 16, // (sys_ring_t*, entries) -> 0; entries is a power of two
+  SYS_ring_enter = 17, // (sys_ring_t*) -> completions waiting in the CQ
+  SYS_COUNT
+};
+
+#define SYS_IOV_MAX    64
+#define SYS_BATCH_MAX  64
+
+typedef struct {
+    uint32_t base;   // app address
+    uint32_t len;
+} sys_iovec_t;
+
+// One entry of SYS_batch: what r12 / r0-r3 would have been, and r0 after
+typedef struct {
+    uint32_t no;
+    uint32_t a[4];
+    int32_t  ret;
+} sys_op_t;
+
+typedef struct {
+    uint32_t size;
+    uint32_t is_dir;
+} sys_stat_t;
+
+typedef struct {
+    char     name[16];
+    uint32_t size;
+    uint32_t is_dir;
+} sys_dirent_t;
+
+// ---- Submission / completion ring (sys_ring.c) ----
+// Lives in app memory: the header, then sqe[entries], then cqe[entries].
+// The app fills SQEs and bumps sq_tail; the OS runs them at the next trap
+// (any syscall) or from sys_ring_poll(), and posts CQEs at cq_tail.
+// exit, batch and the ring calls themselves are not run from a ring (-1).
+#define SYS_RING_MAX      2
+#define SYS_RING_ENTRIES  64   // upper bound for entries
+#define SYS_RING_F_CQ_FULL 1u  // OS stopped because the app did not reap CQEs
+
+typedef struct {
+    uint32_t no;
+    uint32_t a[4];
+    uint32_t user;     // copied to the CQE
+} sys_sqe_t;
+
+typedef struct {
+    uint32_t user;
+    int32_t  res;
+} sys_cqe_t;
+
+typedef struct {
+    uint32_t entries;
+    volatile uint32_t sq_head;   // OS
+    volatile uint32_t sq_tail;   // app
+    volatile uint32_t cq_head;   // app
+    volatile uint32_t cq_tail;   // OS
+    volatile uint32_t flags;     // SYS_RING_F_*
+} sys_ring_t;
+
+int32_t k_ring_setup(uint32_t ring, uint32_t entries, uint32_t a2, uint32_t a3);
+int32_t k_ring_enter(uint32_t ring, uint32_t a1, uint32_t a2, uint32_t a3);
+void sys_ring_poll(void);      // run pending SQEs of every registered ring
+void sys_ring_release(void);   // app is gone: forget its rings (those of g_sys_owner)
+
+// Registers r0-r3 as the app passed them; r0 gets the result (-1 on error).
+// Pending ring submissions are run first.
+int32_t syscall_dispatch(uint32_t no, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+// One call, nothing else (batch and ring entries)
+int32_t syscall_run(uint32_t no, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+// A call made by app code on whichever core it runs (SVC handler, rt_api);
+// core 1 job calls are handed to core 0 (os/job.c)
+int32_t syscall_from_app(uint32_t no, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+
+// Which app the call being run belongs to; rings are tracked per owner
+enum { SYS_OWNER_FG = 0, SYS_OWNER_JOB = 1 };
+extern uint8_t g_sys_owner;
+
+// App memory as the OS sees it. On the board app addresses are real
+// addresses (identity maps set up by syscall_init); host builds map a guest
+// range onto a host buffer instead.
+void syscall_init(void);
+bool syscall_map(uint32_t guest, uint32_t size, void* host);
+void* sys_uptr(uint32_t addr, uint32_t len);   // NULL unless [addr, addr+len) is mapped
+const char* sys_ustr(uint32_t addr);           // NULL unless NUL-terminated in a mapping
@@ -0,0 +1,74 @@
+// trace.c: per-core event rings for trace.h
+//
+// Each core only ever writes its own ring, so the cores never contend; on a
+// core the slot is claimed with interrupts masked for the increment, which
+// is all the M0+ (no LDREX/STREX) needs to stay consistent against an ISR.
+// Old events are overwritten; head[] tells the decoder how many were lost.
+#include "os/trace.h"
+#include <string.h>
+
+#ifdef PICODOS_HOST
+#include "dos/dos_sys.h"
+static inline uint32_t now_us(void) { return (uint32_t)dos_time_us(); }
+static inline uint32_t core_num(void) { return 0; }
+static inline uint32_t irq_off(void) { return 0; }
+static inline void irq_on(uint32_t s) { (void)s; }
+#else
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+static inline uint32_t now_us(void) { return time_us_32(); }
+static inline uint32_t core_num(void) { return get_core_num(); }
+static inline uint32_t irq_off(void) { return save_and_disable_interrupts(); }
+static inline void irq_on(uint32_t s) { restore_interrupts(s); }
+#endif
+
+static struct {
+    trace_hdr_t hdr;
+    trace_ev_t  ev[2][TRACE_ENTRIES];
+} g_tr = {
+    .hdr = { .magic = TRACE_MAGIC, .ev_bytes = sizeof(trace_ev_t), .cores = 2,
+             .entries = TRACE_ENTRIES, .groups = TRACE_GROUPS },
+};
+static volatile bool g_on;
+
+void trace_emit(uint32_t id, uint32_t a, uint32_t b) {
+    if (!g_on) return;
+    const uint32_t c = core_num();
+    uint32_t s = irq_off();
+    uint32_t n = g_tr.hdr.head[c]++;
+    irq_on(s);
+
+    trace_ev_t* e = &g_tr.ev[c][n & (TRACE_ENTRIES - 1)];
+    e->t_us = now_us();
+    e->id = (uint8_t)id;
+    e->core = (uint8_t)c;
+    e->seq = (uint16_t)n;
+    e->a = a;
+    e->b = b;
+}
+
+void trace_enable(bool on) { g_on = on; }
+bool trace_enabled(void) { return g_on; }
+
+void trace_clear(void) {
+    bool on = g_on;
+    g_on = false;
+    memset(g_tr.ev, 0, sizeof(g_tr.ev));
+    g_tr.hdr.head[0] = g_tr.hdr.head[1] = 0;
+    g_on = on;
+}
+
+const trace_hdr_t* trace_header(void) { return &g_tr.hdr; }
+
+const uint8_t* trace_snapshot(uint32_t* size) {
+    g_on = false;
+    g_tr.hdr.t_dump = now_us();
+    *size = sizeof(g_tr);
+    return (const uint8_t*)&g_tr;
+}
+
+uint32_t trace_tag(const char* s) {
+    uint32_t v = 0;
+    for (int i=0;i<4 && s[i];i++) v |= (uint32_t)(uint8_t)s[i] << (8 * i);
+    return v;
+}
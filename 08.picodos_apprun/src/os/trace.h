@@ -0,0 +1,78 @@
+// trace.h: binary event trace into a RAM ring (TRACE command)
+//
+// TRACE(id, a, b) stores {time_us, id, core, a, b} in 16 bytes. A group
+// left out of TRACE_GROUPS at build time compiles to nothing; the ones kept
+// cost a few dozen cycles while TRACE ON, one load and branch while off.
+// tools/trace2perfetto.py turns a TRACE DUMP into a Chrome/Perfetto timeline
+// and must agree with the IDs below.
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Groups: the high nibble of an event ID
+#define TRACE_G_SYS    (1u << 1)
+#define TRACE_G_VFS    (1u << 2)
+#define TRACE_G_FLASH  (1u << 3)
+#define TRACE_G_XFER   (1u << 4)
+#define TRACE_G_SHELL  (1u << 5)
+
+#ifndef TRACE_GROUPS
+#define TRACE_GROUPS   (TRACE_G_SYS | TRACE_G_VFS | TRACE_G_FLASH | TRACE_G_XFER | TRACE_G_SHELL)
+#endif
+#ifndef TRACE_ENTRIES
+#define TRACE_ENTRIES  256u    // per core, power of two
+#endif
+
+// *_BEGIN / *_END pairs are slices, the rest are instants
+enum {
+    TR_SYS_BEGIN    = 0x10,  // a = syscall no, b = r0
+    TR_SYS_END      = 0x11,  // a = syscall no, b = result
+    TR_VFS_BEGIN    = 0x20,  // a = TR_VFS_*, b = fd (open: mode)
+    TR_VFS_END      = 0x21,  // a = TR_VFS_*, b = result
+    TR_FLASH_ERASE_BEGIN = 0x30,  // a = flash offset, b = bytes
+    TR_FLASH_ERASE_END   = 0x31,
+    TR_FLASH_PROG_BEGIN  = 0x32,  // a = flash offset, b = bytes
+    TR_FLASH_PROG_END    = 0x33,
+    TR_XFER_FRAME   = 0x40,  // a = frame type (0xFF = bad), b = decoded bytes
+    TR_CMD_BEGIN    = 0x50,  // a = first 4 chars of argv[0], b = argc
+    TR_CMD_END      = 0x51,  // a = first 4 chars of argv[0]
+};
+
+// TR_VFS_* op codes (a of TR_VFS_BEGIN / END)
+enum { TR_VFS_OPEN = 1, TR_VFS_CLOSE, TR_VFS_READ, TR_VFS_WRITE, TR_VFS_LSEEK };
+
+#define TRACE_GROUP(id) (1u << ((id) >> 4))
+#define TRACE(id, a, b) do { \
+        if (TRACE_GROUPS & TRACE_GROUP(id)) trace_emit((id), (uint32_t)(a), (uint32_t)(b)); \
+    } while (0)
+
+typedef struct {
+    uint32_t t_us;     // timer, wraps every 71 minutes
+    uint8_t  id;
+    uint8_t  core;
+    uint16_t seq;      // per-core event counter (low bits), shows drops
+    uint32_t a, b;
+} trace_ev_t;
+
+// TRACE DUMP payload: this header, then TRACE_ENTRIES events per core in
+// ring order; head[c] is the total ever written on core c
+#define TRACE_MAGIC 0x31435254u   // 'TRC1'
+typedef struct {
+    uint32_t magic;
+    uint16_t ev_bytes;
+    uint16_t cores;
+    uint32_t entries;      // per core
+    uint32_t groups;       // TRACE_GROUPS of this build
+    uint32_t head[2];
+    uint32_t t_dump;       // timer when dumped
+} trace_hdr_t;
+
+void trace_emit(uint32_t id, uint32_t a, uint32_t b);
+void trace_enable(bool on);
+bool trace_enabled(void);
+void trace_clear(void);
+const trace_hdr_t* trace_header(void);   // counts so far
+// Contiguous header + rings; tracing pauses until trace_enable() again
+const uint8_t* trace_snapshot(uint32_t* size);
+// Pack up to 4 chars of a name into a for TR_CMD_*
+uint32_t trace_tag(const char* s);
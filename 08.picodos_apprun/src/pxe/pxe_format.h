@@ -4,13 +4,32 @@
 
 #define PXE_MAGIC 0x30584550u   // 'PXE0'
 #define PXE_VER   1
+#define PXE_VER2  2   // relocatable: reloc table between header and image
+
+// v2 images are linked here (app.ld) and moved by adding (load base - link base)
+// to every 32-bit word listed in the relocation table
+#define PXE_LINK_BASE 0x20020000u
+
+// flags
+#define PXE_F_XIP   0x0001u  // text runs from the flash XIP window; only .data goes to SRAM
+#define PXE_F_DATA  0x0002u  // data_off / data_size are valid
+#define PXE_F_LZ    0x0004u  // image is one LZ4 block (pxe_lz.c); image_size is unpacked
+// bits 8-15: major version of the OS runtime table the app calls (os/rt_api.h), 0 = none
+#define PXE_F_API_SHIFT 8
+#define PXE_F_API_MASK  0xFF00u
+#define PXE_API_MAJOR(h) (((h)->flags & PXE_F_API_MASK) >> PXE_F_API_SHIFT)
 
 typedef struct {
     uint32_t magic;
     uint16_t ver;
-    uint16_t flags;      // 0
+    uint16_t flags;      // PXE_F_*
     uint32_t image_size; // raw binary size
     uint32_t bss_size;   // bytes (optional; 0 is OK)
     uint32_t entry_off;  // entry offset from load base
-    uint32_t reserved[3];
+    uint32_t data_off;   // .data initial values, offset in image
+    uint32_t data_size;  // .data bytes
+    uint32_t reloc_count;// v2: u16 image offsets after the header (padded to 4 bytes)
 } pxe_hdr_t;
+
+// Bytes of relocation table that follow the header
+#define PXE_RELOC_BYTES(h) ((((h)->ver == PXE_VER2 ? (h)->reloc_count : 0u) * 2u + 3u) & ~3u)
@@ -1,13 +1,31 @@
 // pxe_loader.c (OS side)
 #include "pxe_format.h"
+#include "pxe/pxe_loader.h"
+#include "pxe/pxe_lz.h"
+#include "os/app_slot.h"
+#include "os/syscall.h"
+#include "os/rt_api.h"
 #include "vfs/vfs.h"
+#include "xfer/xfer_recv.h"
+#include "dos/dos.h"
+#include "dos/dos_sys.h"
+#include "fs/flash_fs.h"
+#include "fs/ramfs.h"
+#include "hal/hal_flash.h"
+#ifdef PICODOS_HOST
+static inline unsigned get_core_num(void) { return 0; }   // host/pxe_load_test.c
+#else
+#include "pico/stdlib.h"
+#endif
 #include <string.h>
 #include <stdint.h>
 
-#define APP_BASE ((uint8_t*)0x20020000u)
-#define APP_SIZE (64u*1024u)
+#define APP_BASE APP_SLOT0_BASE
+#define APP_SIZE APP_SLOT_BYTES
+#define LOAD_CHUNK 256u
+#define RELOC_BATCH 16u
 
-typedef int (*pxe_entry_t)(int argc, char** argv);
+typedef int (*pxe_entry_t)(int argc, char** argv, const rt_api_t* api);
 
 static bool read_exact(int fd, void* buf, uint32_t n) {
     vfs_err_t e;
@@ -21,25 +39,492 @@ static bool read_exact(int fd, void* buf, uint32_t n) {
     return true;
 }
 
-bool pxe_run_fixed(const char* path, int argc, char** argv) {
+static bool skip(int fd, uint32_t n) {
+    uint8_t tmp[32];
+    while (n) {
+        uint32_t k = n < sizeof(tmp) ? n : (uint32_t)sizeof(tmp);
+        if (!read_exact(fd, tmp, k)) return false;
+        n -= k;
+    }
+    return true;
+}
+
+static const uint8_t* xip_window(void) {
+    return hal_flash_map(APP_XIP_OFFSET);
+}
+
+static uint32_t reloc_count(const pxe_hdr_t* h) {
+    return h->ver == PXE_VER2 ? h->reloc_count : 0;
+}
+
+static bool hdr_ok(const pxe_hdr_t* h) {
+    if (h->magic != PXE_MAGIC || (h->ver != PXE_VER && h->ver != PXE_VER2)) return false;
+    if (h->entry_off >= h->image_size) return false;
+    if (reloc_count(h) > h->image_size / 4) return false;
+    if ((h->flags & PXE_F_DATA) && h->data_off + h->data_size > h->image_size) return false;
+    if (PXE_API_MAJOR(h) && PXE_API_MAJOR(h) != RT_API_MAJOR) {
+        dos_printf("App needs runtime v%u, OS has v%u\r\n", (unsigned)PXE_API_MAJOR(h), (unsigned)RT_API_MAJOR);
+        return false;
+    }
+    if (h->flags & PXE_F_XIP) {
+        // text stays in flash at its link address, so XIP images never move
+        // (and are compared against the window as stored, so no LZ either)
+        if (!(h->flags & PXE_F_DATA) || h->ver == PXE_VER2 || (h->flags & PXE_F_LZ)) return false;
+        return h->image_size <= APP_XIP_BYTES && h->data_size + h->bss_size <= APP_SIZE;
+    }
+    return h->image_size + h->bss_size <= APP_SIZE;
+}
+
+// SRAM the image occupies while resident (XIP: .data + .bss only)
+static uint32_t slot_bytes(const pxe_hdr_t* h) {
+    return (h->flags & PXE_F_XIP) ? h->data_size + h->bss_size : h->image_size + h->bss_size;
+}
+
+static bool cache_evict_lru(void);
+
+// at == NULL: first gap that fits. Cached images make room if needed.
+static uint8_t* slot_alloc(uint8_t* at, uint32_t size, const char* name) {
+    do {
+        uint8_t* p = at ? app_slot_alloc_at(at, size, name) : app_slot_alloc(size, name);
+        if (p) return p;
+    } while (cache_evict_lru());
+    return NULL;
+}
+
+// v2 goes into the first gap that fits; v1 only runs at its link address
+static uint8_t* slot_for(const pxe_hdr_t* h, uint32_t size, const char* name) {
+    return slot_alloc(h->ver == PXE_VER2 ? NULL : APP_BASE, size, name);
+}
+
+static const char* base_name(const char* path) {
+    const char* b = path;
+    for (const char* p = path; *p; p++) if (*p == '\\' || *p == '/' || *p == ':') b = p + 1;
+    return b;
+}
+
+static void reloc_patch(uint8_t* img, uint32_t off, int32_t delta) {
+    uint32_t v;
+    memcpy(&v, img + off, 4);   // literal pools / .data words may be unaligned in theory
+    v += (uint32_t)delta;
+    memcpy(img + off, &v, 4);
+}
+
+static pxe_hdr_t g_last_hdr;
+static bool g_last_valid;
+
+const pxe_hdr_t* pxe_last_header(void) { return g_last_valid ? &g_last_hdr : NULL; }
+
+// Image is in place: set up .data (XIP), clear .bss and jump
+static int pxe_enter(const pxe_image_t* img, int argc, char** argv) {
+    const pxe_hdr_t* h = &img->h;
+    g_last_hdr = *h;
+    g_last_valid = true;
+    const uint8_t* code = img->base;
+    uint8_t* bss = img->base + h->image_size;
+    if (h->flags & PXE_F_XIP) {
+        code = xip_window();
+        memcpy(img->base, code + h->data_off, h->data_size);
+        bss = img->base + h->data_size;
+    }
+    if (h->bss_size) memset(bss, 0, h->bss_size);
+
+    pxe_entry_t entry = (pxe_entry_t)((uintptr_t)(code + h->entry_off) | 1u); // Thumb bit
+    int rc = entry(argc, argv, &g_rt_api);
+    if (get_core_num() == 0) sys_ring_release();   // rings live in the app's memory (core 1: os/job.c)
+    return rc;
+}
+
+// XIP images must sit at their link address in the flash window. If the
+// window already holds this exact image, nothing is copied or programmed;
+// otherwise it is staged in the (then empty) app arena and flashed once.
+static bool xip_prepare(int fd, const pxe_hdr_t* h) {
+    const uint8_t* win = xip_window();
+    uint8_t buf[256];
+    uint32_t off = 0, n = 0;
+    while (off < h->image_size) {
+        n = h->image_size - off < sizeof(buf) ? h->image_size - off : (uint32_t)sizeof(buf);
+        if (!read_exact(fd, buf, n)) return false;
+        if (memcmp(buf, win + off, n) != 0) break;
+        off += n;
+    }
+    if (off == h->image_size) return true;
+
+    uint32_t len = (h->image_size + HAL_FLASH_SECTOR - 1) & ~(HAL_FLASH_SECTOR - 1);
+    uint8_t* stage = slot_alloc(APP_BASE, len, "XIP");
+    if (!stage) { dos_puts("App slots busy\r\n"); return false; }
+
+    memcpy(stage, win, off);
+    memcpy(stage + off, buf, n);
+    off += n;
+    bool ok = read_exact(fd, stage + off, h->image_size - off);
+    if (ok) {
+        memset(stage + h->image_size, 0xFF, len - h->image_size);
+        dos_puts("Installing XIP image...\r\n");
+        ok = flash_fs_program_region(APP_XIP_OFFSET, stage, len);
+    }
+    app_slot_free(stage);
+    return ok;
+}
+
+// Reloc table read through a second fd a batch at a time
+typedef struct {
+    int      fd;
+    uint32_t left;       // entries not read yet
+    uint32_t rn, ri;     // batch size / next entry in it
+    uint32_t next_min;
+    uint16_t rel[RELOC_BATCH];
+} reloc_reader_t;
+
+// Patch every word that lies wholly below `have`
+static bool reloc_upto(reloc_reader_t* r, uint8_t* dst, int32_t delta, uint32_t have) {
+    while (1) {
+        if (r->ri == r->rn) {
+            if (!r->left) return true;
+            r->rn = r->left < RELOC_BATCH ? r->left : RELOC_BATCH;
+            r->ri = 0;
+            r->left -= r->rn;
+            if (!read_exact(r->fd, r->rel, r->rn * 2)) return false;
+        }
+        uint32_t off = r->rel[r->ri];
+        if (off + 4 > have) return true;       // rest of the word is still to come
+        if (off < r->next_min) return false;   // table must be ascending, no overlaps
+        reloc_patch(dst, off, delta);
+        r->next_min = off + 4;
+        r->ri++;
+    }
+}
+
+// Stream the image into dst. The reloc table sits between header and image,
+// so it is read through a second fd. Plain images are patched word by word
+// as they arrive; PXE_F_LZ images only once fully decoded, because a later
+// match may copy words that were already patched.
+static bool load_relocated(int fd, const char* path, const pxe_hdr_t* h, uint8_t* dst) {
+    const int32_t delta = (int32_t)((uintptr_t)dst - PXE_LINK_BASE);
+    reloc_reader_t r = { .fd = -1, .left = reloc_count(h) };
+    vfs_err_t e;
+    if (r.left) {
+        r.fd = vfs_open(path, VFS_O_RDONLY, &e);
+        if (r.fd < 0) return false;
+        if (!skip(r.fd, sizeof(*h))) { vfs_close(r.fd); return false; }
+    }
+    bool ok = skip(fd, PXE_RELOC_BYTES(h));
+
+    const bool lz = (h->flags & PXE_F_LZ) != 0;
+    pxe_lz_t z;
+    if (lz) pxe_lz_init(&z, dst, h->image_size);
+
+    uint32_t got = 0;
+    while (ok && got < h->image_size) {
+        if (lz) {
+            uint8_t in[LOAD_CHUNK / 2];
+            int n = vfs_read(fd, in, sizeof(in), &e);
+            if (n <= 0 || !pxe_lz_push(&z, in, (size_t)n)) { ok = false; break; }
+            got = z.pos;
+        } else {
+            uint32_t n = h->image_size - got < LOAD_CHUNK ? h->image_size - got : LOAD_CHUNK;
+            if (!read_exact(fd, dst + got, n)) { ok = false; break; }
+            got += n;
+            ok = reloc_upto(&r, dst, delta, got);
+        }
+    }
+    if (lz && ok) ok = pxe_lz_done(&z) && reloc_upto(&r, dst, delta, h->image_size);
+    if (r.ri < r.rn || r.left) ok = false;     // offsets past the image
+    if (r.fd >= 0) vfs_close(r.fd);
+    return ok;
+}
+
+// Room kept after the image for a pristine .data copy (resident cache)
+static uint32_t shadow_bytes(const pxe_hdr_t* h) {
+    return (!(h->flags & PXE_F_XIP) && (h->flags & PXE_F_DATA)) ? h->data_size : 0;
+}
+
+static uint32_t shadow_off(const pxe_hdr_t* h) {
+    return (slot_bytes(h) + 3u) & ~3u;
+}
+
+static bool load(const char* path, pxe_image_t* img, bool shadow) {
     vfs_err_t e;
     int fd = vfs_open(path, VFS_O_RDONLY, &e);
     if (fd < 0) return false;
 
+    pxe_hdr_t* h = &img->h;
+    img->base = NULL;
+    if (!read_exact(fd, h, sizeof(*h)) || !hdr_ok(h)) { vfs_close(fd); return false; }
+
+    uint32_t size = slot_bytes(h);
+    bool ok = true;
+    if (h->flags & PXE_F_XIP) {
+        ok = xip_prepare(fd, h);
+        if (!ok) dos_puts("XIP install failed\r\n");
+    } else if (shadow && shadow_bytes(h)) {
+        size = shadow_off(h) + shadow_bytes(h);
+    }
+    if (ok) {
+        img->base = slot_for(h, size, base_name(path));
+        if (!img->base) { dos_puts("No room in app slots\r\n"); ok = false; }
+    }
+    if (ok && !(h->flags & PXE_F_XIP)) ok = load_relocated(fd, path, h, img->base);
+    vfs_close(fd);
+
+    if (!ok) pxe_unload(img);
+    return ok;
+}
+
+bool pxe_load(const char* path, pxe_image_t* img) {
+    return load(path, img, false);
+}
+
+int pxe_start(const pxe_image_t* img, int argc, char** argv) {
+    return pxe_enter(img, argc, argv);
+}
+
+void pxe_unload(pxe_image_t* img) {
+    if (img->base) app_slot_free(img->base);
+    img->base = NULL;
+}
+
+// ---- Resident image cache (RUN) ----
+//
+// A finished app stays in its slot. The next RUN of the same ramfs file at
+// the same generation restores .data from a shadow copy kept after .bss
+// (XIP: from the flash window) and jumps straight in. Changed or deleted
+// files miss; cached images are evicted LRU when a slot is needed.
+
+typedef struct {
+    bool        used;
+    int         node;       // ramfs node + generation = file contents
+    uint32_t    gen;
+    uint32_t    last_use;
+    pxe_image_t img;
+} cache_ent_t;
+
+static cache_ent_t g_cache[APP_SLOT_MAX];
+static uint32_t g_cache_tick;
+static pxe_cache_stats_t g_cache_stats;
+
+static void cache_drop(cache_ent_t* c) {
+    pxe_unload(&c->img);
+    c->used = false;
+}
+
+static bool cache_evict_lru(void) {
+    cache_ent_t* lru = NULL;
+    for (int i=0;i<APP_SLOT_MAX;i++) {
+        if (g_cache[i].used && (!lru || g_cache[i].last_use < lru->last_use)) lru = &g_cache[i];
+    }
+    if (!lru) return false;
+    cache_drop(lru);
+    g_cache_stats.evictions++;
+    return true;
+}
+
+static cache_ent_t* cache_find(int node, uint32_t gen) {
+    cache_ent_t* hit = NULL;
+    for (int i=0;i<APP_SLOT_MAX;i++) {
+        cache_ent_t* c = &g_cache[i];
+        if (!c->used || c->node != node) continue;
+        if (c->gen == gen) hit = c;
+        else cache_drop(c);          // file changed since it was loaded
+    }
+    return hit;
+}
+
+const pxe_cache_stats_t* pxe_cache_stats(void) { return &g_cache_stats; }
+
+void pxe_cache_flush(void) {
+    for (int i=0;i<APP_SLOT_MAX;i++) if (g_cache[i].used) cache_drop(&g_cache[i]);
+}
+
+bool pxe_run_fixed(const char* path, int argc, char** argv) {
+    int node;
+    uint32_t gen;
+    vfs_err_t e;
+    bool keyed = ramfs_file_gen(path, &node, &gen, &e);
+
+    cache_ent_t* c = keyed ? cache_find(node, gen) : NULL;
+    if (c) {
+        g_cache_stats.hits++;
+        const pxe_hdr_t* h = &c->img.h;
+        if (shadow_bytes(h)) memcpy(c->img.base + h->data_off, c->img.base + shadow_off(h), h->data_size);
+        c->last_use = ++g_cache_tick;
+        int rc = pxe_enter(&c->img, argc, argv);
+        (void)rc;
+        return true;
+    }
+    g_cache_stats.misses++;
+
+    pxe_image_t img;
+    if (!load(path, &img, keyed)) return false;
+
+    // Without .data bounds there is nothing to restore from, so no caching
+    const pxe_hdr_t* h = &img.h;
+    if (keyed && (h->flags & PXE_F_DATA)) {
+        if (shadow_bytes(h)) memcpy(img.base + shadow_off(h), img.base + h->data_off, h->data_size);
+        for (int i=0;i<APP_SLOT_MAX;i++) {
+            if (g_cache[i].used) continue;
+            c = &g_cache[i];
+            *c = (cache_ent_t){ .used = true, .node = node, .gen = gen, .last_use = ++g_cache_tick, .img = img };
+            break;
+        }
+    }
+
+    int rc = pxe_enter(&img, argc, argv);
+    (void)rc;
+    if (!c) pxe_unload(&img);
+    return true;
+}
+
+// ---- NETRUN: xfer stream straight into an app slot ----
+//
+// The reloc table arrives before the image, so it is kept just past the
+// image in the same slot (where .bss will later go) and applied as the
+// image words come in (LZ images: once decoded, see load_relocated).
+
+typedef struct {
     pxe_hdr_t h;
-    if (!read_exact(fd, &h, sizeof(h))) { vfs_close(fd); return false; }
-    if (h.magic != PXE_MAGIC || h.ver != PXE_VER) { vfs_close(fd); return false; }
+    uint32_t  got;       // bytes received, header included
+    uint8_t*  base;
+    uint16_t* rel;       // reloc table, inside the slot
+    uint32_t  rel_i;     // next entry to apply
+    uint32_t  next_min;
+    pxe_lz_t  z;         // PXE_F_LZ: image bytes go through the decoder
+} wire_sink_t;
+
+static bool wire_begin(void* ctx, const char* name, uint32_t size) {
+    (void)name;
+    wire_sink_t* w = (wire_sink_t*)ctx;
+    w->got = 0;
+    w->base = NULL;
+    w->rel_i = w->next_min = 0;
+    // Reject before any DATA if it cannot possibly fit
+    if (size < sizeof(pxe_hdr_t) || size - sizeof(pxe_hdr_t) > APP_SIZE) {
+        dos_puts("Not a PXE image\r\n");
+        return false;
+    }
+    return true;
+}
+
+static bool wire_header(wire_sink_t* w) {
+    if (!hdr_ok(&w->h)) { dos_puts("Bad PXE header\r\n"); return false; }
+    if (w->h.flags & PXE_F_XIP) { dos_puts("XIP image: use RECV + RUN\r\n"); return false; }
+
+    uint32_t tail = (w->h.image_size + 3u) & ~3u;
+    uint32_t need = slot_bytes(&w->h);
+    if (tail + PXE_RELOC_BYTES(&w->h) > need) need = tail + PXE_RELOC_BYTES(&w->h);
+    w->base = slot_for(&w->h, need, "NETRUN");
+    if (!w->base) { dos_puts("No room in app slots\r\n"); return false; }
+    w->rel = (uint16_t*)(w->base + tail);
+    pxe_lz_init(&w->z, w->base, w->h.image_size);
+    return true;
+}
+
+// Apply the table entries whose word lies wholly below `have`
+static bool wire_reloc_upto(wire_sink_t* w, uint32_t have) {
+    const int32_t delta = (int32_t)((uintptr_t)w->base - PXE_LINK_BASE);
+    while (w->rel_i < reloc_count(&w->h)) {
+        uint32_t r = w->rel[w->rel_i];
+        if (r + 4 > have) break;
+        if (r < w->next_min) return false;
+        reloc_patch(w->base, r, delta);
+        w->next_min = r + 4;
+        w->rel_i++;
+    }
+    return true;
+}
+
+static bool wire_write(void* ctx, const uint8_t* p, size_t n) {
+    wire_sink_t* w = (wire_sink_t*)ctx;
+    const uint32_t hs = (uint32_t)sizeof(pxe_hdr_t);
 
-    uint32_t need = h.image_size + h.bss_size;
-    if (need > APP_SIZE) { vfs_close(fd); return false; }
+    // Header bytes first; validate as soon as it is complete
+    if (w->got < hs) {
+        size_t take = hs - w->got;
+        if (take > n) take = n;
+        memcpy((uint8_t*)&w->h + w->got, p, take);
+        w->got += (uint32_t)take;
+        p += take; n -= take;
+        if (w->got == hs && !wire_header(w)) return false;
+        if (n == 0) return true;
+    }
+
+    // Then the reloc table (v2)
+    const uint32_t tb = PXE_RELOC_BYTES(&w->h);
+    if (w->got < hs + tb) {
+        size_t take = hs + tb - w->got;
+        if (take > n) take = n;
+        memcpy((uint8_t*)w->rel + (w->got - hs), p, take);
+        w->got += (uint32_t)take;
+        p += take; n -= take;
+        if (n == 0) return true;
+    }
 
-    if (!read_exact(fd, APP_BASE, h.image_size)) { vfs_close(fd); return false; }
+    uint32_t have;
+    if (w->h.flags & PXE_F_LZ) {
+        if (!pxe_lz_push(&w->z, p, n)) return false;
+        have = w->z.pos;
+    } else {
+        uint32_t off = w->got - hs - tb;
+        if (off + n > w->h.image_size) return false;
+        memcpy(w->base + off, p, n);
+        have = off + (uint32_t)n;
+    }
+    w->got += (uint32_t)n;
+
+    // LZ: matches copy earlier output, so patch only the finished image
+    return (w->h.flags & PXE_F_LZ) || wire_reloc_upto(w, have);
+}
+
+static bool wire_end(void* ctx, bool ok) {
+    wire_sink_t* w = (wire_sink_t*)ctx;
+    if (!ok) return false;
+    if (w->h.flags & PXE_F_LZ) {
+        if (!pxe_lz_done(&w->z) || !wire_reloc_upto(w, w->h.image_size)) return false;
+    } else if (w->got != sizeof(pxe_hdr_t) + PXE_RELOC_BYTES(&w->h) + w->h.image_size) {
+        return false;
+    }
+    return w->rel_i == reloc_count(&w->h);
+}
+
+static void relocate_all(const wire_sink_t* w, int32_t delta) {
+    for (uint32_t i=0;i<reloc_count(&w->h);i++) reloc_patch(w->base, w->rel[i], delta);
+}
+
+// Optional copy of the received image (taken before .data can be modified).
+// The file gets the image as linked, so relocations are undone around the
+// write; an LZ image is stored decompressed.
+static bool persist_image(const char* path, const wire_sink_t* w) {
+    vfs_err_t e;
+    int fd = vfs_open(path, VFS_O_WRONLY | VFS_O_CREAT | VFS_O_TRUNC, &e);
+    if (fd < 0) return false;
+    const int32_t delta = (int32_t)((uintptr_t)w->base - PXE_LINK_BASE);
+    const uint32_t tb = PXE_RELOC_BYTES(&w->h);
+
+    pxe_hdr_t h = w->h;
+    h.flags &= (uint16_t)~PXE_F_LZ;
+
+    relocate_all(w, -delta);
+    bool ok = vfs_write(fd, &h, sizeof(h), &e) == (int)sizeof(h) &&
+              vfs_write(fd, w->rel, tb, &e) == (int)tb &&
+              vfs_write(fd, w->base, w->h.image_size, &e) == (int)w->h.image_size;
+    relocate_all(w, delta);
     vfs_close(fd);
+    return ok;
+}
+
+bool pxe_run_wire(const char* save_path, int argc, char** argv) {
+    static const xfer_sink_t sink = { wire_begin, wire_write, wire_end };
+    wire_sink_t w;
+    w.base = NULL;
+    if (!xfer_recv_stream(&sink, &w)) {
+        if (w.base) app_slot_free(w.base);
+        return false;
+    }
 
-    if (h.bss_size) memset(APP_BASE + h.image_size, 0, h.bss_size);
+    if (save_path && !persist_image(save_path, &w)) dos_puts("Save copy failed\r\n");
 
-    pxe_entry_t entry = (pxe_entry_t)((uintptr_t)(APP_BASE + h.entry_off) | 1u); // Thumb bit
-    int rc = entry(argc, argv);
+    pxe_image_t img = { w.h, w.base };
+    int rc = pxe_enter(&img, argc, argv);
     (void)rc;
+    pxe_unload(&img);
     return true;
 }
@@ -1,2 +1,31 @@
 #pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "pxe/pxe_format.h"
+
+// An image resident in an app slot (os/app_slot.h)
+typedef struct {
+    pxe_hdr_t h;
+    uint8_t*  base;  // slot holding the image (XIP: .data + .bss only)
+} pxe_image_t;
+
+// Load into a free app slot; v2 images are relocated while they stream in
+bool pxe_load(const char* path, pxe_image_t* img);
+int  pxe_start(const pxe_image_t* img, int argc, char** argv);
+void pxe_unload(pxe_image_t* img);
+
+// RUN: load (or reuse the resident copy of) a ramfs PXE and run it
 bool pxe_run_fixed(const char* path, int argc, char** argv);
+
+typedef struct {
+    uint32_t hits;       // RUN reused a resident image
+    uint32_t misses;     // RUN had to load the file
+    uint32_t evictions;  // cached image dropped to make room
+} pxe_cache_stats_t;
+
+const pxe_cache_stats_t* pxe_cache_stats(void);
+// Header of the image last started (RUN / START / NETRUN), NULL before any
+const pxe_hdr_t* pxe_last_header(void);
+void pxe_cache_flush(void);
+// Receive a PXE over the xfer link into the app slot and run it (NETRUN)
+bool pxe_run_wire(const char* save_path, int argc, char** argv);
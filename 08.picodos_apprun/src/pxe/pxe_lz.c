@@ -0,0 +1,95 @@
+// pxe_lz.c: LZ4 block format, decoded incrementally
+//
+//   sequence = token(lit:4|match:4) [lit len+] literals offset(u16 LE) [match len+]
+//   a length nibble of 15 continues with bytes until one is < 255;
+//   match length is nibble + 4; the last sequence has literals only.
+#include "pxe/pxe_lz.h"
+#include <string.h>
+
+enum { S_TOKEN, S_LIT_LEN, S_LIT, S_OFF_LO, S_OFF_HI, S_MATCH_LEN };
+
+void pxe_lz_init(pxe_lz_t* z, uint8_t* out, uint32_t cap) {
+    memset(z, 0, sizeof(*z));
+    z->out = out;
+    z->cap = cap;
+}
+
+static bool copy_match(pxe_lz_t* z) {
+    uint32_t len = z->len + 4;
+    if (z->off == 0 || z->off > z->pos || len > z->cap - z->pos) return false;
+    uint8_t* d = z->out + z->pos;
+    const uint8_t* s = d - z->off;
+    if (z->off >= len) memcpy(d, s, len);
+    else for (uint32_t i=0;i<len;i++) d[i] = s[i];   // overlapping run
+    z->pos += len;
+    z->state = S_TOKEN;
+    return true;
+}
+
+bool pxe_lz_push(pxe_lz_t* z, const uint8_t* in, size_t n) {
+    while (n) {
+        switch (z->state) {
+        case S_TOKEN:
+            // Fast path: short literals + offset all in this push
+            if (n >= 1 + 14 + 2 && (*in >> 4) != 15 && (*in & 15) != 15) {
+                uint32_t lit = *in >> 4;
+                if (lit > z->cap - z->pos) return false;
+                z->token = *in;
+                memcpy(z->out + z->pos, in + 1, lit);
+                z->pos += lit;
+                z->off = (uint16_t)(in[1 + lit] | (in[2 + lit] << 8));
+                in += 3 + lit; n -= 3 + lit;
+                z->len = z->token & 15;
+                if (!copy_match(z)) return false;
+                break;
+            }
+            z->token = *in++; n--;
+            z->len = z->token >> 4;
+            z->state = z->len == 15 ? S_LIT_LEN : S_LIT;
+            if (z->state == S_LIT && z->len == 0) z->state = S_OFF_LO;
+            break;
+
+        case S_LIT_LEN: {
+            uint8_t b = *in++; n--;
+            z->len += b;
+            if (b != 255) z->state = z->len ? S_LIT : S_OFF_LO;
+            break;
+        }
+
+        case S_LIT: {
+            uint32_t k = z->len < n ? z->len : (uint32_t)n;
+            if (k > z->cap - z->pos) return false;
+            memcpy(z->out + z->pos, in, k);
+            z->pos += k; in += k; n -= k;
+            z->len -= k;
+            if (z->len == 0) z->state = S_OFF_LO;   // or the end of the block
+            break;
+        }
+
+        case S_OFF_LO:
+            z->off = *in++; n--;
+            z->state = S_OFF_HI;
+            break;
+
+        case S_OFF_HI:
+            z->off |= (uint16_t)(*in++ << 8); n--;
+            z->len = z->token & 15;
+            if (z->len == 15) z->state = S_MATCH_LEN;
+            else if (!copy_match(z)) return false;
+            break;
+
+        case S_MATCH_LEN: {
+            uint8_t b = *in++; n--;
+            z->len += b;
+            if (b != 255 && !copy_match(z)) return false;
+            break;
+        }
+        }
+    }
+    return true;
+}
+
+bool pxe_lz_done(const pxe_lz_t* z) {
+    // The block ends right after the last literals, where an offset would be
+    return z->pos == z->cap && z->state == S_OFF_LO;
+}
@@ -0,0 +1,22 @@
+// pxe_lz.h: LZ4 block decoder for PXE_F_LZ images
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Push-style: feed compressed bytes as they arrive (file reads or xfer
+// frames), output goes straight to its final place. Matches copy from the
+// output itself, so no window buffer is needed.
+typedef struct {
+    uint8_t* out;
+    uint32_t cap;      // decompressed size (pxe_hdr_t.image_size)
+    uint32_t pos;      // bytes produced so far
+    uint32_t len;      // literal or match length being collected / copied
+    uint16_t off;      // match offset
+    uint8_t  token;
+    uint8_t  state;
+} pxe_lz_t;
+
+void pxe_lz_init(pxe_lz_t* z, uint8_t* out, uint32_t cap);
+bool pxe_lz_push(pxe_lz_t* z, const uint8_t* in, size_t n);  // false = corrupt / overrun
+bool pxe_lz_done(const pxe_lz_t* z);                          // whole image produced
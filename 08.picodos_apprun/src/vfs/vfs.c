@@ -2,7 +2,9 @@
 #include "vfs.h"
 #include "fs/ramfs.h"
 #include "util/strutil.h"
-#include "pico/stdio.h"
+#include "dos/dos_sys.h"
+#include "os/trace.h"
+#include "os/stats.h"
 #include <string.h>
 
 typedef enum { FD_FREE=0, FD_CON, FD_NUL, FD_RAMFILE } fd_kind_t;
@@ -44,7 +46,7 @@ void vfs_init(void) {
 static bool is_con(const char* p){ return str_eq_nocase(p, "CON:"); }
 static bool is_nul(const char* p){ return str_eq_nocase(p, "NUL:"); }
 
-int vfs_open(const char* path, int mode, vfs_err_t* err) {
+static int do_open(const char* path, int mode, vfs_err_t* err) {
     if (err) *err = VFS_OK;
     if (!path) { if (err) *err = VFS_E_INVAL; return -1; }
 
@@ -67,14 +69,14 @@ int vfs_open(const char* path, int mode, vfs_err_t* err) {
     return fd;
 }
 
-int vfs_close(int fd) {
+static int do_close(int fd) {
     if (fd < 0 || fd >= VFS_MAX_FD) return -1;
     if (g_fd[fd].kind == FD_RAMFILE) ramfs_close(g_fd[fd].handle);
     if (fd >= 3) g_fd[fd].kind = FD_FREE;
     return 0;
 }
 
-int vfs_read(int fd, void* buf, size_t len, vfs_err_t* err) {
+static int do_read(int fd, void* buf, size_t len, vfs_err_t* err) {
     if (err) *err = VFS_OK;
     if (fd < 0 || fd >= VFS_MAX_FD) { if (err) *err = VFS_E_INVAL; return -1; }
 
@@ -86,7 +88,7 @@ int vfs_read(int fd, void* buf, size_t len, vfs_err_t* err) {
     }
 }
 
-int vfs_write(int fd, const void* buf, size_t len, vfs_err_t* err) {
+static int do_write(int fd, const void* buf, size_t len, vfs_err_t* err) {
     if (err) *err = VFS_OK;
     if (fd < 0 || fd >= VFS_MAX_FD) { if (err) *err = VFS_E_INVAL; return -1; }
 
@@ -95,8 +97,8 @@ int vfs_write(int fd, const void* buf, size_t len, vfs_err_t* err) {
         // CRLF formatting (DOS-like)
         for (size_t i=0;i<len;i++){
             char c = ((const char*)buf)[i];
-            if (c == '\n') { putchar_raw('\r'); putchar_raw('\n'); }
-            else putchar_raw(c);
+            if (c == '\n') { dos_putc('\r'); dos_putc('\n'); }
+            else dos_putc(c);
         }
         return (int)len;
     case FD_NUL:
@@ -108,3 +110,54 @@ int vfs_write(int fd, const void* buf, size_t len, vfs_err_t* err) {
         return -1;
     }
 }
+
+static int do_lseek(int fd, int32_t off, int whence, vfs_err_t* err) {
+    if (err) *err = VFS_OK;
+    if (fd < 0 || fd >= VFS_MAX_FD) { if (err) *err = VFS_E_INVAL; return -1; }
+
+    switch (g_fd[fd].kind) {
+    case FD_NUL: return 0;
+    case FD_RAMFILE: return ramfs_lseek(g_fd[fd].handle, off, whence, err);
+    default: if (err) *err = VFS_E_INVAL; return -1;   // CON is not seekable
+    }
+}
+
+// ---- public entry points: the do_* above, traced and counted (STATS) ----
+
+int vfs_open(const char* path, int mode, vfs_err_t* err) {
+    TRACE(TR_VFS_BEGIN, TR_VFS_OPEN, mode);
+    int r = do_open(path, mode, err);
+    stats_vfs_open();
+    TRACE(TR_VFS_END, TR_VFS_OPEN, r);
+    return r;
+}
+
+int vfs_close(int fd) {
+    TRACE(TR_VFS_BEGIN, TR_VFS_CLOSE, fd);
+    int r = do_close(fd);
+    TRACE(TR_VFS_END, TR_VFS_CLOSE, r);
+    return r;
+}
+
+int vfs_read(int fd, void* buf, size_t len, vfs_err_t* err) {
+    TRACE(TR_VFS_BEGIN, TR_VFS_READ, fd);
+    int r = do_read(fd, buf, len, err);
+    if (r > 0) stats_vfs_bytes((uint32_t)r, 0);
+    TRACE(TR_VFS_END, TR_VFS_READ, r);
+    return r;
+}
+
+int vfs_write(int fd, const void* buf, size_t len, vfs_err_t* err) {
+    TRACE(TR_VFS_BEGIN, TR_VFS_WRITE, fd);
+    int r = do_write(fd, buf, len, err);
+    if (r > 0) stats_vfs_bytes(0, (uint32_t)r);
+    TRACE(TR_VFS_END, TR_VFS_WRITE, r);
+    return r;
+}
+
+int vfs_lseek(int fd, int32_t off, int whence, vfs_err_t* err) {
+    TRACE(TR_VFS_BEGIN, TR_VFS_LSEEK, fd);
+    int r = do_lseek(fd, off, whence, err);
+    TRACE(TR_VFS_END, TR_VFS_LSEEK, r);
+    return r;
+}
@@ -22,6 +22,12 @@ typedef enum {
     VFS_O_APPEND = 1 << 10,
 } vfs_open_mode_t;
 
+typedef enum {
+    VFS_SEEK_SET = 0,
+    VFS_SEEK_CUR = 1,
+    VFS_SEEK_END = 2,
+} vfs_whence_t;
+
 void vfs_init(void);
 
 int vfs_open(const char* path, int mode, vfs_err_t* err);
@@ -29,5 +35,6 @@ int vfs_close(int fd);
 
 int vfs_read(int fd, void* buf, size_t len, vfs_err_t* err);
 int vfs_write(int fd, const void* buf, size_t len, vfs_err_t* err);
+int vfs_lseek(int fd, int32_t off, int whence, vfs_err_t* err);  // new position, -1 on error
 
 bool vfs_is_device_path(const char* path);
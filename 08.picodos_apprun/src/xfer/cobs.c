@@ -21,3 +21,24 @@ size_t cobs_decode(const uint8_t* in, size_t in_len, uint8_t* out, size_t out_ca
     }
     return wi;
 }
+
+size_t cobs_encode(const uint8_t* in, size_t in_len, uint8_t* out, size_t out_cap) {
+    if (!in || !out || out_cap == 0) return 0;
+
+    // Room is checked before every byte written (out[0] is the first code)
+    size_t wi = 1, code_pos = 0;
+    uint8_t code = 1;
+    for (size_t ri = 0; ri < in_len; ri++) {
+        if (in[ri] != 0) {
+            if (wi >= out_cap) return 0;
+            out[wi++] = in[ri];
+            if (++code != 0xFF) continue;
+        }
+        out[code_pos] = code;
+        if (wi >= out_cap) return 0;
+        code_pos = wi++;
+        code = 1;
+    }
+    out[code_pos] = code;
+    return wi;
+}
@@ -4,3 +4,5 @@
 
 // returns decoded length, 0 on error
 size_t cobs_decode(const uint8_t* in, size_t in_len, uint8_t* out, size_t out_cap);
+// returns encoded length (no 0x00 delimiter), 0 on error; needs in_len + in_len/254 + 1 bytes
+size_t cobs_encode(const uint8_t* in, size_t in_len, uint8_t* out, size_t out_cap);
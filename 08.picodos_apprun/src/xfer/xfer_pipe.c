@@ -0,0 +1,163 @@
+// xfer_pipe.c
+#include "xfer/xfer_pipe.h"
+#include "xfer/cobs.h"
+#include "dos/dos_sys.h"
+#include "os/trace.h"
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef XFER_PIPE_CORE1
+#define XFER_PIPE_CORE1 0
+#endif
+
+#if XFER_PIPE_CORE1
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include "os/job.h"
+#define PIPE_DMB() __dmb()
+#else
+#define PIPE_DMB() ((void)0)
+#endif
+
+#define PIPE_ENC_MAX 600
+
+enum { B_FREE = 0, B_READY };
+
+typedef struct {
+    uint8_t enc[PIPE_ENC_MAX];
+    volatile uint16_t len;
+    volatile uint8_t  bad;    // overflowed; decodes as an error
+    volatile uint8_t  state;
+} pbuf_t;
+
+static pbuf_t g_buf[2];
+static uint8_t  g_fill, g_take;   // RX stage writes g_fill, commit stage reads g_take
+static uint16_t g_fill_len;
+static bool     g_fill_bad, g_stalled;
+static uint8_t  g_last_type;        // frame type that ends the transfer
+static volatile bool g_rx_done;    // that frame is in: leave the rest to the console
+static volatile bool g_in_commit;
+static xfer_pipe_stats_t g_st;
+
+static void rx_byte(uint8_t c) {
+    pbuf_t* b = &g_buf[g_fill];
+    if (c == 0) {
+        // COBS: a leading type byte (never 0) sits right after the first code
+        if (g_fill_len >= 2 && b->enc[0] >= 2 && b->enc[1] == g_last_type) g_rx_done = true;
+        b->len = g_fill_len;
+        b->bad = g_fill_bad;
+        PIPE_DMB();
+        b->state = B_READY;
+        uint32_t ready = (g_buf[0].state == B_READY) + (g_buf[1].state == B_READY);
+        if (ready > g_st.max_ready) g_st.max_ready = ready;
+        g_fill ^= 1;
+        g_fill_len = 0;
+        g_fill_bad = false;
+        return;
+    }
+    if (g_fill_len >= PIPE_ENC_MAX) { g_fill_bad = true; return; }
+    b->enc[g_fill_len++] = c;
+    if (g_in_commit) g_st.overlap_bytes++;
+}
+
+// false while both buffers hold frames the commit stage has not taken yet,
+// and for good once the last frame is in
+static bool rx_can_fill(void) {
+    if (g_rx_done) return false;
+    if (g_buf[g_fill].state == B_FREE) { g_stalled = false; return true; }
+    if (!g_stalled) { g_stalled = true; g_st.rx_stalls++; }
+    return false;
+}
+
+// Core 1 may be running a START job, in which case RX is pumped as usual
+static bool g_core1;
+
+#if XFER_PIPE_CORE1
+static volatile bool g_core1_run;
+
+static void core1_rx(void) {
+    while (g_core1_run) {
+        if (!rx_can_fill()) continue;
+        int c = dos_getc_nowait();
+        if (c >= 0) rx_byte((uint8_t)c);
+    }
+}
+#endif
+
+void xfer_pipe_start(uint8_t last_type) {
+    memset(&g_st, 0, sizeof(g_st));
+    g_buf[0].state = g_buf[1].state = B_FREE;
+    g_fill = g_take = 0;
+    g_fill_len = 0;
+    g_fill_bad = g_stalled = false;
+    g_in_commit = false;
+    g_last_type = last_type;
+    g_rx_done = false;
+#if XFER_PIPE_CORE1
+    g_core1 = !job_active();
+    if (g_core1) {
+        g_core1_run = true;
+        multicore_reset_core1();
+        multicore_launch_core1(core1_rx);
+    }
+#endif
+}
+
+void xfer_pipe_stop(void) {
+#if XFER_PIPE_CORE1
+    if (g_core1) {
+        g_core1_run = false;
+        multicore_reset_core1();
+    }
+#endif
+    g_core1 = false;
+    g_in_commit = false;
+}
+
+void xfer_pipe_pump(void) {
+    if (g_core1) return;
+    int c;
+    while (rx_can_fill() && (c = dos_getc_nowait()) >= 0) rx_byte((uint8_t)c);
+}
+
+size_t xfer_pipe_take(uint8_t* dec, size_t dec_cap) {
+    g_in_commit = false;
+    pbuf_t* b = &g_buf[g_take];
+
+    if (b->state != B_READY) {
+        if (g_rx_done) return 0;   // nothing follows the last frame
+        g_st.commit_waits++;
+#if XFER_PIPE_CORE1
+        if (g_core1) {
+            while (b->state != B_READY) tight_loop_contents();
+        } else
+#endif
+        {
+            // Nothing queued, so the buffer being filled is free: block on the wire
+            xfer_pipe_pump();
+            while (b->state != B_READY) {
+                int c = dos_getc_blocking();
+                if (c < 0) return 0;
+                rx_byte((uint8_t)c);
+                xfer_pipe_pump();
+            }
+        }
+    }
+    PIPE_DMB();
+
+    size_t n = (b->len && !b->bad) ? cobs_decode(b->enc, b->len, dec, dec_cap) : 0;
+    g_st.frames++;
+    TRACE(TR_XFER_FRAME, n ? dec[0] : 0xFF, n);
+    b->state = B_FREE;
+    g_take ^= 1;
+
+    // The caller now commits this frame; keep the wire draining meanwhile
+    g_in_commit = true;
+    xfer_pipe_pump();
+    return n;
+}
+
+const xfer_pipe_stats_t* xfer_pipe_stats(void) { return &g_st; }
+
+size_t xfer_pipe_ram_bytes(void) { return sizeof(g_buf); }
@@ -0,0 +1,27 @@
+// xfer_pipe.h: double-buffered frame receive
+//
+// The RX stage fills one encoded-frame buffer from the console while the
+// commit stage (the RECV loop) decodes and writes the frame in the other.
+// Single core: the commit stage calls xfer_pipe_pump() between write slices.
+// XFER_PIPE_CORE1=1: the RX stage runs on core 1 and pumping is a no-op,
+// unless a START job (os/job.h) holds core 1.
+// RX stops at the frame of type last_type (END, COMMIT), so whatever the user
+// types after the transfer stays with the console for the shell or the app.
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t frames;         // frames handed to the commit stage
+    uint32_t commit_waits;   // commit stage had to wait for the wire
+    uint32_t rx_stalls;      // RX stage found both buffers full (storage-bound)
+    uint32_t overlap_bytes;  // bytes received while a frame was being committed
+    uint32_t max_ready;      // most frames queued at once (0..2)
+} xfer_pipe_stats_t;
+
+void   xfer_pipe_start(uint8_t last_type);   // drop stale state, zero stats
+void   xfer_pipe_stop(void);
+void   xfer_pipe_pump(void);    // move pending RX bytes into the free buffer
+size_t xfer_pipe_take(uint8_t* dec, size_t dec_cap);  // next frame, decoded; 0 on error
+const xfer_pipe_stats_t* xfer_pipe_stats(void);
+size_t xfer_pipe_ram_bytes(void);   // both frame buffers (MEM)
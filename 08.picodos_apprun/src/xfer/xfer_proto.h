@@ -0,0 +1,34 @@
+// xfer_proto.h: wire format shared by RECV, NETRUN and RECV /S
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Decoded frame = u8 type, u32 seq (little-endian), then per-type fields
+enum {
+    XFER_T_BEGIN   = 1,  // u16 name_len, u32 size, u32 crc, name
+    XFER_T_DATA    = 2,  // u16 len, payload
+    XFER_T_END     = 3,
+    XFER_T_SESSION = 4,  // u16 entry_count
+    XFER_T_ENTRY   = 5,  // u8 kind, u16 name_len, u32 size, u32 crc, name
+    XFER_T_COMMIT  = 6,  // u16 entry_count
+};
+
+#define XFER_DEC_MAX  520   // largest decoded frame
+#define XFER_CRC_INIT 0x12345678u
+
+static inline uint32_t xfer_crc(uint32_t x, const uint8_t* p, size_t n) {
+    for (size_t i=0;i<n;i++) x = (x * 33u) ^ p[i];
+    return x;
+}
+
+// little-endian helpers
+static inline uint16_t xfer_rd16(const uint8_t* p){ return (uint16_t)p[0] | ((uint16_t)p[1]<<8); }
+static inline uint32_t xfer_rd32(const uint8_t* p){ return (uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24); }
+
+#define XFER_SLICE    64    // commit granularity; RX is pumped between slices
+
+// Receive one 0x00-delimited frame and COBS-decode it; returns decoded length, 0 on error
+// (only between xfer_pipe_start/stop)
+size_t xfer_read_packet(uint8_t* dec, size_t dec_cap);
+bool   xfer_write_sliced(bool (*write)(void* ctx, const uint8_t* p, size_t n), void* ctx, const uint8_t* p, size_t n);
@@ -1,4 +1,15 @@
 #pragma once
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Destination of a received stream (ramfs file, app slot, ...)
+typedef struct {
+    bool (*begin)(void* ctx, const char* name, uint32_t size); // BEGIN frame accepted
+    bool (*write)(void* ctx, const uint8_t* p, size_t n);      // DATA payload, in order
+    bool (*end)(void* ctx, bool ok);                           // ok = size and CRC matched
+} xfer_sink_t;
 
 bool xfer_recv_file(const char* path);  // Called from RECV command
+bool xfer_recv_stream(const xfer_sink_t* sink, void* ctx);
+size_t xfer_recv_ram_bytes(void);       // static frame buffer (MEM)
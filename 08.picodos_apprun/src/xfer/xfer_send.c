@@ -0,0 +1,96 @@
+// xfer_send.c: SEND - RECV's framing in the other direction
+#include "xfer/xfer_send.h"
+#include "xfer/xfer_proto.h"
+#include "xfer/cobs.h"
+#include "vfs/vfs.h"
+#include "dos/dos_sys.h"
+#include <string.h>
+
+#define XFER_CHUNK 240   // same DATA payload as tools/send_pxe.py
+#define SEND_ENC_MAX (XFER_DEC_MAX + XFER_DEC_MAX/254 + 2)
+#define SEND_PKT_MAX (1+4+2+XFER_CHUNK)
+
+static void wr16(uint8_t* p, uint16_t v){ p[0]=(uint8_t)v; p[1]=(uint8_t)(v>>8); }
+static void wr32(uint8_t* p, uint32_t v){ p[0]=(uint8_t)v; p[1]=(uint8_t)(v>>8); p[2]=(uint8_t)(v>>16); p[3]=(uint8_t)(v>>24); }
+
+static bool write_frame(const uint8_t* pkt, size_t n) {
+    static uint8_t enc[SEND_ENC_MAX];
+    size_t m = cobs_encode(pkt, n, enc, sizeof(enc));
+    if (m == 0) return false;
+    // Raw bytes: dos_putc does no CRLF translation
+    for (size_t i=0;i<m;i++) dos_putc((char)enc[i]);
+    dos_putc(0);  // delimiter
+    return true;
+}
+
+static bool send_begin(const char* name, uint32_t size, uint32_t crc) {
+    uint8_t pkt[1+4+2+4+4+64];
+    size_t nl = strlen(name);
+    if (nl > 64) nl = 64;
+    pkt[0] = XFER_T_BEGIN;
+    wr32(&pkt[1], 0);
+    wr16(&pkt[5], (uint16_t)nl);
+    wr32(&pkt[7], size);
+    wr32(&pkt[11], crc);
+    memcpy(&pkt[15], name, nl);
+
+    // A lone delimiter first, so the host can drop the echoed command line
+    dos_putc(0);
+    return write_frame(pkt, 15 + nl);
+}
+
+static bool send_data(uint32_t seq, const uint8_t* p, size_t n) {
+    static uint8_t pkt[SEND_PKT_MAX];
+    pkt[0] = XFER_T_DATA;
+    wr32(&pkt[1], seq);
+    wr16(&pkt[5], (uint16_t)n);
+    memcpy(&pkt[7], p, n);
+    return write_frame(pkt, 7 + n);
+}
+
+static bool send_end(uint32_t seq) {
+    uint8_t pkt[1+4];
+    pkt[0] = XFER_T_END;
+    wr32(&pkt[1], seq);
+    return write_frame(pkt, sizeof(pkt));
+}
+
+bool xfer_send_buffer(const char* name, const uint8_t* data, uint32_t size) {
+    if (!send_begin(name, size, xfer_crc(XFER_CRC_INIT, data, size))) return false;
+
+    uint32_t seq = 1;
+    for (uint32_t off = 0; off < size; off += XFER_CHUNK) {
+        size_t n = size - off < XFER_CHUNK ? size - off : XFER_CHUNK;
+        if (!send_data(seq++, data + off, n)) return false;
+    }
+    return send_end(seq);
+}
+
+bool xfer_send_file(const char* path) {
+    vfs_err_t e;
+    uint8_t buf[XFER_CHUNK];
+
+    // Pass 1: size and CRC for BEGIN
+    int fd = vfs_open(path, VFS_O_RDONLY, &e);
+    if (fd < 0) { dos_puts("File not found.\r\n"); return false; }
+    uint32_t size = 0, crc = XFER_CRC_INIT;
+    int n;
+    while ((n = vfs_read(fd, buf, sizeof(buf), &e)) > 0) {
+        crc = xfer_crc(crc, buf, (size_t)n);
+        size += (uint32_t)n;
+    }
+    vfs_close(fd);
+
+    // Pass 2: stream
+    fd = vfs_open(path, VFS_O_RDONLY, &e);
+    if (fd < 0) return false;
+    bool ok = send_begin(path, size, crc);
+    uint32_t seq = 1;
+    while (ok && (n = vfs_read(fd, buf, sizeof(buf), &e)) > 0) {
+        ok = send_data(seq++, buf, (size_t)n);
+    }
+    vfs_close(fd);
+    return ok && send_end(seq);
+}
+
+size_t xfer_send_ram_bytes(void) { return SEND_ENC_MAX + SEND_PKT_MAX; }
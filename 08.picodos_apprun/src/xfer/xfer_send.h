@@ -0,0 +1,9 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Device -> host, same BEGIN/DATA/END framing as RECV (host side: tools/recv_file.py)
+bool xfer_send_file(const char* path);  // Called from SEND command
+bool xfer_send_buffer(const char* name, const uint8_t* data, uint32_t size);
+size_t xfer_send_ram_bytes(void);       // static frame buffers (MEM)
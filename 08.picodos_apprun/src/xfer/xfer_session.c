@@ -0,0 +1,322 @@
+// xfer_session.c: RECV /S - many files and directories in one framed stream
+//
+//   device:  manifest lines "#D <rel>" / "#F <rel> <size> <crc>", then "#READY"
+//   host:    SESSION(n), { ENTRY, DATA... } x n, COMMIT(n)
+//
+// New files and directories land in place as they arrive; a file that
+// already exists is received into a staging file (A:\~SESSnn.TMP) and
+// copied over the original only at COMMIT. If the session fails before
+// COMMIT, everything it created (staging files included) is removed again
+// and existing files are untouched. COMMIT is the single point where the
+// batch is accepted (and, with /SAVE, written to flash once): it checks that
+// every replacement can be opened before the first original is truncated.
+#include "xfer/xfer_session.h"
+#include "xfer/xfer_proto.h"
+#include "xfer/xfer_pipe.h"
+#include "vfs/vfs.h"
+#include "fs/ramfs.h"
+#include "fs/flash_fs.h"
+#include "dos/dos.h"
+#include "dos/dos_sys.h"
+#include <string.h>
+#include <stdio.h>
+
+#define SESS_PATH_MAX   64
+#define SESS_MAX_NEW    16   // ramfs cannot hold more nodes than this anyway
+#define SESS_MAX_DEPTH  4
+#define SESS_STAGE_DIR  "A:\\"
+
+enum { ENT_DIR = 0, ENT_FILE = 1 };
+
+// Paths created by this session (rolled back on failure)
+static char g_new_path[SESS_MAX_NEW][SESS_PATH_MAX];
+static bool g_new_is_dir[SESS_MAX_NEW];
+static int  g_new_count;
+
+// Existing files being replaced: g_new_path[stage] holds the new contents
+static struct { char target[SESS_PATH_MAX]; int stage; } g_replace[SESS_MAX_NEW];
+static int  g_replace_count;
+
+static bool join_path(char* out, size_t cap, const char* base, const char* rel) {
+    size_t bl = strlen(base);
+    bool sep = bl > 0 && base[bl-1] != '\\' && base[bl-1] != '/' && base[bl-1] != ':';
+    int n = snprintf(out, cap, "%s%s%s", base, sep ? "\\" : "", rel);
+    return n > 0 && (size_t)n < cap;
+}
+
+static bool file_crc(const char* path, uint32_t* crc_out) {
+    vfs_err_t e;
+    int fd = vfs_open(path, VFS_O_RDONLY, &e);
+    if (fd < 0) return false;
+    uint8_t buf[64];
+    uint32_t crc = XFER_CRC_INIT;
+    int n;
+    while ((n = vfs_read(fd, buf, sizeof(buf), &e)) > 0) crc = xfer_crc(crc, buf, (size_t)n);
+    vfs_close(fd);
+    *crc_out = crc;
+    return true;
+}
+
+// "#D SUB" / "#F SUB\FILE.TXT 123 1a2b3c4d" for everything under base
+static void list_tree(const char* base, const char* rel, int depth) {
+    char dir[SESS_PATH_MAX];
+    if (!join_path(dir, sizeof(dir), base, rel)) return;
+
+    for (int i=0;i<64;i++){
+        vfs_err_t e;
+        ramfs_dirent_t de;
+        if (!ramfs_list_dir(dir, i, &de, &e) || !de.used) break;
+
+        char sub[SESS_PATH_MAX];
+        if (rel[0]) { if (!join_path(sub, sizeof(sub), rel, de.name)) continue; }
+        else strcpy(sub, de.name);
+
+        if (de.is_dir) {
+            dos_printf("#D %s\r\n", sub);
+            if (depth < SESS_MAX_DEPTH) list_tree(base, sub, depth + 1);
+        } else {
+            char full[SESS_PATH_MAX];
+            uint32_t crc;
+            if (!join_path(full, sizeof(full), base, sub) || !file_crc(full, &crc)) continue;
+            dos_printf("#F %s %u %08lx\r\n", sub, (unsigned)de.size, (unsigned long)crc);
+        }
+    }
+}
+
+static bool path_exists(const char* path, bool* is_dir) {
+    vfs_err_t e;
+    int fd = vfs_open(path, VFS_O_RDONLY, &e);
+    if (fd >= 0) { vfs_close(fd); *is_dir = false; return true; }
+    // Not a file: a directory can be listed
+    ramfs_dirent_t de;
+    if (ramfs_list_dir(path, 0, &de, &e)) { *is_dir = true; return true; }
+    return false;
+}
+
+// false: too many to roll back, the caller fails the session
+static bool note_created(const char* path, bool is_dir) {
+    if (g_new_count >= SESS_MAX_NEW) return false;
+    snprintf(g_new_path[g_new_count], SESS_PATH_MAX, "%s", path);
+    g_new_is_dir[g_new_count] = is_dir;
+    g_new_count++;
+    return true;
+}
+
+// Open a fresh staging file for an existing target; -1 on failure
+static int stage_open(const char* target) {
+    if (g_replace_count >= SESS_MAX_NEW) return -1;
+    char path[SESS_PATH_MAX];
+    bool is_dir;
+    for (int i=0;i<100;i++) {
+        snprintf(path, sizeof(path), SESS_STAGE_DIR "~SESS%02d.TMP", i);
+        if (path_exists(path, &is_dir)) continue;
+        vfs_err_t e;
+        int fd = vfs_open(path, VFS_O_WRONLY | VFS_O_CREAT | VFS_O_TRUNC, &e);
+        if (fd < 0) return -1;
+        if (!note_created(path, false)) { vfs_close(fd); ramfs_delete(path, &e); return -1; }
+        snprintf(g_replace[g_replace_count].target, SESS_PATH_MAX, "%s", target);
+        g_replace[g_replace_count].stage = g_new_count - 1;
+        g_replace_count++;
+        return fd;
+    }
+    return -1;
+}
+
+static bool copy_file(const char* from, const char* to) {
+    vfs_err_t e;
+    int in = vfs_open(from, VFS_O_RDONLY, &e);
+    if (in < 0) return false;
+    int out = vfs_open(to, VFS_O_WRONLY | VFS_O_CREAT | VFS_O_TRUNC, &e);
+    bool ok = out >= 0;
+    uint8_t buf[64];
+    int n;
+    while (ok && (n = vfs_read(in, buf, sizeof(buf), &e)) > 0) ok = vfs_write(out, buf, (size_t)n, &e) == n;
+    if (out >= 0) vfs_close(out);
+    vfs_close(in);
+    return ok;
+}
+
+static bool can_open(const char* path, int mode) {
+    vfs_err_t e;
+    int fd = vfs_open(path, mode, &e);
+    if (fd < 0) return false;
+    vfs_close(fd);
+    return true;
+}
+
+// Before COMMIT truncates anything: every staging file and target opens
+static bool replacements_ready(void) {
+    for (int i=0;i<g_replace_count;i++) {
+        if (!can_open(g_new_path[g_replace[i].stage], VFS_O_RDONLY)) return false;
+        if (!can_open(g_replace[i].target, VFS_O_WRONLY)) return false;
+    }
+    return true;
+}
+
+// COMMIT: staged contents over the originals, then the staging files go.
+// Stops at the first copy that fails; its staging file and those of the
+// entries after it stay, so the new contents are not lost.
+static bool apply_replacements(void) {
+    vfs_err_t e;
+    for (int i=0;i<g_replace_count;i++) {
+        const char* stage = g_new_path[g_replace[i].stage];
+        if (!copy_file(stage, g_replace[i].target)) {
+            for (int j=i;j<g_replace_count;j++)
+                dos_printf("%s not replaced, kept in %s\r\n", g_replace[j].target, g_new_path[g_replace[j].stage]);
+            g_replace_count = 0;
+            return false;
+        }
+        ramfs_delete(stage, &e);
+    }
+    g_replace_count = 0;
+    return true;
+}
+
+static void rollback(void) {
+    vfs_err_t e;
+    // Newest first so directories are empty by the time they are removed
+    for (int i=g_new_count-1;i>=0;i--) {
+        if (g_new_is_dir[i]) ramfs_rmdir(g_new_path[i], &e);
+        else ramfs_delete(g_new_path[i], &e);
+    }
+    g_new_count = 0;
+    g_replace_count = 0;
+}
+
+static bool fail(const char* msg) {
+    dos_puts(msg);
+    rollback();
+    return false;
+}
+
+static bool fd_write(void* ctx, const uint8_t* p, size_t n) {
+    vfs_err_t e;
+    return vfs_write(*(int*)ctx, p, n, &e) == (int)n;
+}
+
+static bool recv_session(const char* base) {
+    static uint8_t dec[XFER_DEC_MAX];
+    g_new_count = 0;
+    g_replace_count = 0;
+
+    size_t dec_len = xfer_read_packet(dec, sizeof(dec));
+    if (dec_len < 1+4+2 || dec[0] != XFER_T_SESSION || xfer_rd32(&dec[1]) != 0) {
+        dos_puts("Bad SESSION\r\n");
+        return false;
+    }
+    const uint16_t entries = xfer_rd16(&dec[5]);
+
+    uint32_t next_seq = 1;
+    uint16_t done = 0;
+    int fd = -1;            // open file entry, if any
+    uint32_t remain = 0;    // bytes still expected for it
+    uint32_t expect_crc = 0, crc = 0;
+
+    while (1) {
+        dec_len = xfer_read_packet(dec, sizeof(dec));
+        if (dec_len < 1+4) { if (fd >= 0) vfs_close(fd); return fail("RX frame error\r\n"); }
+        if (xfer_rd32(&dec[1]) != next_seq) { if (fd >= 0) vfs_close(fd); return fail("SEQ mismatch\r\n"); }
+        next_seq++;
+
+        const uint8_t t = dec[0];
+        vfs_err_t e;
+
+        if (t == XFER_T_ENTRY) {
+            if (fd >= 0) { vfs_close(fd); return fail("Short entry\r\n"); }
+            if (dec_len < 1+4+1+2+4+4) return fail("Bad ENTRY\r\n");
+            const uint8_t kind = dec[5];
+            const uint16_t name_len = xfer_rd16(&dec[6]);
+            const uint32_t size = xfer_rd32(&dec[8]);
+            if (dec_len < (size_t)(16 + name_len) || name_len >= SESS_PATH_MAX) return fail("Bad ENTRY len\r\n");
+
+            char rel[SESS_PATH_MAX], path[SESS_PATH_MAX];
+            memcpy(rel, &dec[16], name_len);
+            rel[name_len] = '\0';
+            if (!join_path(path, sizeof(path), base, rel)) return fail("Path too long\r\n");
+
+            if (kind != ENT_DIR && kind != ENT_FILE) return fail("Bad ENTRY kind\r\n");
+            bool is_dir = false;
+            bool existed = path_exists(path, &is_dir);
+
+            if (kind == ENT_DIR) {
+                if (existed && !is_dir) return fail("Not a directory\r\n");
+                if (!existed) {
+                    if (!ramfs_mkdir(path, &e)) return fail("Cannot create directory\r\n");
+                    if (!note_created(path, true)) { ramfs_rmdir(path, &e); return fail("Too many entries\r\n"); }
+                }
+                done++;
+                continue;
+            }
+
+            if (existed && is_dir) return fail("Not a file\r\n");
+            if (existed) {
+                fd = stage_open(path);
+                if (fd < 0) return fail("Cannot stage file\r\n");
+            } else {
+                fd = vfs_open(path, VFS_O_WRONLY | VFS_O_CREAT | VFS_O_TRUNC, &e);
+                if (fd < 0) return fail("Cannot open file\r\n");
+                if (!note_created(path, false)) {
+                    vfs_close(fd);
+                    ramfs_delete(path, &e);
+                    return fail("Too many entries\r\n");
+                }
+            }
+            dos_printf("  %s\r\n", rel);
+
+            remain = size;
+            expect_crc = xfer_rd32(&dec[12]);
+            crc = XFER_CRC_INIT;
+        }
+        else if (t == XFER_T_DATA) {
+            if (fd < 0 || dec_len < 1+4+2) return fail("Unexpected DATA\r\n");
+            const uint16_t chunk_len = xfer_rd16(&dec[5]);
+            if (dec_len < (size_t)(7 + chunk_len) || chunk_len > remain) { vfs_close(fd); return fail("Bad chunk\r\n"); }
+            if (!xfer_write_sliced(fd_write, &fd, &dec[7], chunk_len)) { vfs_close(fd); return fail("Write error\r\n"); }
+            crc = xfer_crc(crc, &dec[7], chunk_len);
+            remain -= chunk_len;
+        }
+        else if (t == XFER_T_COMMIT) {
+            if (fd >= 0) { vfs_close(fd); return fail("Short entry\r\n"); }
+            if (dec_len < 1+4+2 || xfer_rd16(&dec[5]) != entries || done != entries) return fail("Entry count mismatch\r\n");
+            break;
+        }
+        else {
+            if (fd >= 0) vfs_close(fd);
+            return fail("Unknown type\r\n");
+        }
+
+        // A file entry is complete once its size is reached (also covers empty files)
+        if (fd >= 0 && remain == 0) {
+            vfs_close(fd);
+            fd = -1;
+            if (crc != expect_crc) return fail("CRC mismatch\r\n");
+            done++;
+        }
+    }
+
+    if (!replacements_ready()) return fail("Commit failed\r\n");
+    if (!apply_replacements()) { g_new_count = 0; dos_puts("Commit incomplete\r\n"); return false; }
+    g_new_count = 0;
+    dos_printf("OK %u entr%s\r\n", (unsigned)done, done == 1 ? "y" : "ies");
+    return true;
+}
+
+bool xfer_recv_session(const char* base, bool save) {
+    // Tell the host what is already here so unchanged files can be skipped
+    list_tree(base, "", 0);
+    dos_puts("#READY\r\n");
+
+    xfer_pipe_start(XFER_T_COMMIT);
+    bool ok = recv_session(base);
+    xfer_pipe_stop();
+
+    // Flash programming needs the RX stage (possibly on core 1) out of the way
+    if (ok && save && ramfs_is_dirty()) {
+        if (!flash_fs_save()) { dos_puts("Save failed.\r\n"); return false; }
+        ramfs_clear_dirty();
+        dos_puts("Saved.\r\n");
+    }
+    return ok;
+}
+
+size_t xfer_session_ram_bytes(void) { return XFER_DEC_MAX + sizeof(g_new_path) + sizeof(g_new_is_dir) + sizeof(g_replace); }
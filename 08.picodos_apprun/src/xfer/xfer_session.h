@@ -0,0 +1,7 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+// RECV /S: receive a batch of files/directories under base, committed as one unit
+bool xfer_recv_session(const char* base, bool save);
+size_t xfer_session_ram_bytes(void);    // frame buffer + rollback list (MEM)
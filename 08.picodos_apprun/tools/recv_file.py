@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+# Host side of SEND: pull a file (or the flash image) off the device at wire speed
+import serial, struct, sys, time
+from send_pxe import crc32_simple
+
+def cobs_decode(data: bytes) -> bytes:
+    out = bytearray()
+    idx = 0
+    while idx < len(data):
+        code = data[idx]
+        if code == 0 or idx + code > len(data):
+            raise ValueError("bad COBS frame")
+        out += data[idx+1:idx+code]
+        idx += code
+        if code != 0xFF and idx < len(data):
+            out.append(0)
+    return bytes(out)
+
+def read_frame(ser) -> bytes:
+    buf = bytearray()
+    while True:
+        b = ser.read(1)
+        if not b:
+            raise SystemExit("timeout waiting for frame")
+        if b == b"\x00":
+            if buf:
+                return cobs_decode(bytes(buf))
+            continue  # empty frame (leading delimiter)
+        buf += b
+
+def skip_text(ser):
+    """Drop the echoed command line up to SEND's leading delimiter"""
+    while True:
+        b = ser.read(1)
+        if not b:
+            raise SystemExit("no reply from device")
+        if b == b"\x00":
+            return
+
+def recv_stream(ser):
+    """BEGIN / DATA... / END after the echoed command -> (name, data, frames)"""
+    skip_text(ser)
+
+    # BEGIN: type=1, seq=0, name_len, size, crc, name
+    pkt = read_frame(ser)
+    t, seq, name_len, total, crc = struct.unpack_from("<B I H I I", pkt)
+    if t != 1 or seq != 0:
+        raise SystemExit("BEGIN mismatch")
+    name = pkt[15:15+name_len].decode("ascii", errors="replace")
+
+    data = bytearray()
+    next_seq = 1
+    while True:
+        pkt = read_frame(ser)
+        t, seq = struct.unpack_from("<B I", pkt)
+        if seq != next_seq:
+            raise SystemExit(f"SEQ mismatch: got {seq}, want {next_seq}")
+        next_seq += 1
+        if t == 3:  # END
+            break
+        if t != 2:
+            raise SystemExit(f"unknown frame type {t}")
+        (n,) = struct.unpack_from("<H", pkt, 5)
+        data += pkt[7:7+n]
+
+    if len(data) != total:
+        raise SystemExit(f"size mismatch: got {len(data)}, want {total}")
+    if crc32_simple(bytes(data)) != crc:
+        raise SystemExit("CRC mismatch")
+
+    return name, bytes(data), next_seq
+
+def main():
+    if len(sys.argv) != 4:
+        print("Usage: recv_file.py <port> <remote_file | /IMAGE> <local_file>", file=sys.stderr)
+        print("Example: recv_file.py /dev/ttyACM0 A:\\LOG.TXT LOG.TXT", file=sys.stderr)
+        sys.exit(1)
+
+    port, remote, local = sys.argv[1], sys.argv[2], sys.argv[3]
+    ser = serial.Serial(port, 115200, timeout=2)
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+    ser.write(f"SEND {remote}\r".encode("ascii"))
+
+    t0 = time.time()
+    name, data, frames = recv_stream(ser)
+
+    open(local, "wb").write(data)
+    dt = time.time() - t0
+    print(f"{name} -> {local}: {len(data)} bytes, frames={frames}, {len(data)/dt:.0f} B/s")
+
+if __name__ == "__main__":
+    main()
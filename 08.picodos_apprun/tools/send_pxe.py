@@ -1,5 +1,6 @@
 #!/usr/bin/env python3
-import serial, struct, sys, time
+# Host side of RECV / NETRUN / RECV /S (needs pyserial: pip install -r requirements.txt)
+import pathlib, serial, struct, sys, time
 
 def cobs_encode(data: bytes) -> bytes:
     out = bytearray()
@@ -31,10 +32,84 @@ def write_frame(ser, payload: bytes):
     ser.write(enc + b"\x00")  # delimiter
     ser.flush()
 
+CHUNK_SIZE = 240  # DATA payload per frame (COBS overhead still fits comfortably)
+
+def send_session(ser, entries):
+    """entries: list of (kind, remote_rel, data) with kind 0=dir, 1=file"""
+    write_frame(ser, struct.pack("<B I H", 4, 0, len(entries)))
+    seq = 1
+    for kind, rel, data in entries:
+        name = rel.encode("ascii", errors="strict")
+        write_frame(ser, struct.pack("<B I B H I I", 5, seq, kind, len(name), len(data), crc32_simple(data)) + name)
+        seq += 1
+        for off in range(0, len(data), CHUNK_SIZE):
+            chunk = data[off:off+CHUNK_SIZE]
+            write_frame(ser, struct.pack("<B I H", 2, seq, len(chunk)) + chunk)
+            seq += 1
+    write_frame(ser, struct.pack("<B I H", 6, seq, len(entries)))
+    return seq + 1
+
+def read_manifest(ser, timeout=5.0):
+    """Parse '#D'/'#F' lines printed by RECV /S up to '#READY'"""
+    dirs, files = set(), {}
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        line = ser.readline().decode("ascii", errors="replace").strip()
+        if line == "#READY":
+            return dirs, files
+        parts = line.split()
+        if len(parts) == 2 and parts[0] == "#D":
+            dirs.add(parts[1].upper())
+        elif len(parts) == 4 and parts[0] == "#F":
+            files[parts[1].upper()] = (int(parts[2]), int(parts[3], 16))
+    raise SystemExit("no manifest from device (is it at the prompt?)")
+
+def sync_main(argv):
+    if len(argv) < 3:
+        print("Usage: send_pxe.py --sync <port> <local_dir> <remote_dir> [--save]", file=sys.stderr)
+        print("Example: send_pxe.py --sync /dev/ttyACM0 build/apps A:\\APPS", file=sys.stderr)
+        sys.exit(1)
+    port, local, remote = argv[0], pathlib.Path(argv[1]), argv[2]
+    save = "--save" in argv[3:]
+
+    ser = serial.Serial(port, 115200, timeout=1)
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+    ser.write(f"RECV /S {remote}{' /SAVE' if save else ''}\r".encode("ascii"))
+    dev_dirs, dev_files = read_manifest(ser)
+
+    entries, skipped = [], 0
+    for p in sorted(local.rglob("*")):
+        rel = "\\".join(p.relative_to(local).parts).upper()
+        if p.is_dir():
+            if rel not in dev_dirs:
+                entries.append((0, rel, b""))
+            continue
+        data = p.read_bytes()
+        if dev_files.get(rel) == (len(data), crc32_simple(data)):
+            skipped += 1
+            continue
+        entries.append((1, rel, data))
+
+    frames = send_session(ser, entries)
+    result = ""
+    while not result.startswith(("OK", "RECV failed")):
+        line = ser.readline()
+        if not line:
+            raise SystemExit("no reply from device")
+        result = line.decode("ascii", errors="replace").strip()
+    print(f"{result}: sent {len(entries)} entr{'y' if len(entries) == 1 else 'ies'}, "
+          f"skipped {skipped} unchanged, frames={frames}")
+
 def main():
+    if len(sys.argv) >= 2 and sys.argv[1] == "--sync":
+        sync_main(sys.argv[2:])
+        return
+
     if len(sys.argv) != 4:
         print("Usage: send_pxe.py <port> <file.pxe> <remote_name>", file=sys.stderr)
         print("Example: send_pxe.py /dev/ttyACM0 HELLO.PXE A:\\HELLO.PXE", file=sys.stderr)
+        print("Start RECV <file> (store) or NETRUN (load and run) on the device first.", file=sys.stderr)
         sys.exit(1)
 
     port, path, remote = sys.argv[1], sys.argv[2], sys.argv[3]
@@ -53,9 +128,9 @@ def main():
     begin = struct.pack("<B I H I I", 1, 0, len(name_bytes), total, crc) + name_bytes
     write_frame(ser, begin)
 
-    # DATA: type=2, seq=1.., chunk 240 bytes (COBS overhead still fits comfortably)
+    # DATA: type=2, seq=1..
     seq = 1
-    chunk_size = 240
+    chunk_size = CHUNK_SIZE
     off = 0
     while off < total:
         chunk = data[off:off+chunk_size]
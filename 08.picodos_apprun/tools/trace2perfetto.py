@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+# TRACE DUMP -> Chrome trace JSON (open in ui.perfetto.dev or chrome://tracing)
+#
+#   trace2perfetto.py TRACE.BIN out.json            (file from recv_file.py)
+#   trace2perfetto.py --port /dev/ttyACM0 out.json  (sends TRACE DUMP itself)
+#
+# Layout and event IDs follow src/os/trace.h; syscall numbers follow
+# src/os/syscall.h.
+import json, struct, sys
+
+TRACE_MAGIC = 0x31435254
+HDR = struct.Struct("<I H H I I 2I I")
+EV = struct.Struct("<I B B H I I")
+
+SYSCALLS = ["0", "exit", "write", "open", "close", "read", "lseek", "stat", "readdir",
+            "getchar", "time", "sleep", "yield", "writev", "readv", "batch",
+            "ring_setup", "ring_enter"]
+VFS_OPS = ["?", "open", "close", "read", "write", "lseek"]
+
+# id -> (phase, category); B/E pairs become slices, i instants
+IDS = {
+    0x10: ("B", "sys"),   0x11: ("E", "sys"),
+    0x20: ("B", "vfs"),   0x21: ("E", "vfs"),
+    0x30: ("B", "flash"), 0x31: ("E", "flash"),
+    0x32: ("B", "flash"), 0x33: ("E", "flash"),
+    0x40: ("i", "xfer"),
+    0x50: ("B", "shell"), 0x51: ("E", "shell"),
+}
+# Frame types of src/xfer/xfer_proto.h (0xFF: the frame did not decode)
+XFER_TYPES = {1: "BEGIN", 2: "DATA", 3: "END", 4: "SESSION", 5: "ENTRY", 6: "COMMIT", 0xFF: "bad"}
+
+def tag(v):
+    return bytes((v >> s) & 0xFF for s in (0, 8, 16, 24)).rstrip(b"\0").decode("ascii", "replace")
+
+def slice_name(ev_id, a):
+    if ev_id in (0x10, 0x11):
+        return "sys_" + (SYSCALLS[a] if a < len(SYSCALLS) else str(a))
+    if ev_id in (0x20, 0x21):
+        return "vfs_" + (VFS_OPS[a] if a < len(VFS_OPS) else str(a))
+    if ev_id in (0x30, 0x31):
+        return "flash_erase"
+    if ev_id in (0x32, 0x33):
+        return "flash_program"
+    if ev_id == 0x40:
+        return "frame " + XFER_TYPES.get(a, f"0x{a:02x}")
+    return tag(a) or "?"
+
+def parse(blob):
+    magic, ev_bytes, cores, entries, groups, h0, h1, t_dump = HDR.unpack_from(blob)
+    if magic != TRACE_MAGIC or ev_bytes != EV.size:
+        raise SystemExit("not a TRACE DUMP image")
+    events, dropped = [], []
+    for c, head in enumerate((h0, h1)[:cores]):
+        kept = min(head, entries)
+        dropped.append(head - kept)
+        base = HDR.size + c * entries * EV.size
+        for n in range(head - kept, head):
+            events.append(EV.unpack_from(blob, base + (n % entries) * EV.size))
+    # Timer wraps every 2^32 us: order by age relative to the dump instead
+    ages = [(t_dump - e[0]) & 0xFFFFFFFF for e in events]
+    oldest = max(ages, default=0)
+    ts = [oldest - a for a in ages]
+    order = sorted(range(len(events)), key=lambda i: (ts[i], events[i][2], events[i][3]))
+    return [(ts[i],) + events[i][1:] for i in order], dropped, oldest, groups
+
+def to_chrome(events, end_ts):
+    out = [{"ph": "M", "name": "process_name", "pid": 1, "args": {"name": "PicoDOS"}}]
+    for core in (0, 1):
+        out.append({"ph": "M", "name": "thread_name", "pid": 1, "tid": core, "args": {"name": f"core{core}"}})
+    open_slices = {0: [], 1: []}
+    for ts, ev_id, core, seq, a, b in events:
+        ph, cat = IDS.get(ev_id, ("i", "unknown"))
+        rec = {"name": slice_name(ev_id, a), "cat": cat, "ph": ph, "ts": ts, "pid": 1, "tid": core}
+        if ph == "B":
+            rec["args"] = {"a": a, "b": b}
+            open_slices[core].append(ev_id)
+        elif ph == "E":
+            # The ring may have overwritten the matching begin
+            if not open_slices[core]:
+                continue
+            open_slices[core].pop()
+            rec["args"] = {"result": b - (1 << 32) if b & 0x80000000 else b}
+        else:
+            rec["s"] = "t"
+            rec["args"] = {"a": a, "b": b}
+        out.append(rec)
+    # Slices still open at dump time (e.g. the TRACE command itself)
+    for core, stack in open_slices.items():
+        for _ in stack:
+            out.append({"ph": "E", "ts": end_ts, "pid": 1, "tid": core})
+    return {"traceEvents": out, "displayTimeUnit": "ms"}
+
+def dump_from_port(port):
+    import serial, time
+    from recv_file import recv_stream
+    ser = serial.Serial(port, 115200, timeout=2)
+    time.sleep(0.2)
+    ser.reset_input_buffer()
+    ser.write(b"TRACE DUMP\r")
+    return recv_stream(ser)[1]
+
+def main():
+    args = sys.argv[1:]
+    if len(args) == 3 and args[0] == "--port":
+        blob = dump_from_port(args[1])
+    elif len(args) == 2:
+        blob = open(args[0], "rb").read()
+    else:
+        print("Usage: trace2perfetto.py <TRACE.BIN | --port PORT> <out.json>", file=sys.stderr)
+        sys.exit(1)
+
+    events, dropped, end_ts, groups = parse(blob)
+    with open(args[-1], "w") as f:
+        json.dump(to_chrome(events, end_ts), f)
+
+    counts = {}
+    for e in events:
+        cat = IDS.get(e[1], ("", "unknown"))[1]
+        counts[cat] = counts.get(cat, 0) + 1
+    summary = " ".join(f"{k}={v}" for k, v in sorted(counts.items()))
+    print(f"{len(events)} events over {end_ts} us (groups {groups:02x}, dropped {dropped}): {summary}")
+
+if __name__ == "__main__":
+    main()